@@ -1,38 +1,22 @@
 #include <Rcpp.h>
 #include <cmath>
 #include "LittleFunctionsCollection.h"
+#include "pointColumns.h"
+#include "seedSet.h"
 using namespace Rcpp;
 using namespace std;
 
 
-//' Mean shift clustering using a discrete voxel space
-//'
-//' Adaptive mean shift clustering to delineate tree crowns from lidar point clouds. This is a version using 1-m³ voxels instead of exact point coordinates, to speed up processing.
-//'
-//' @param pc Point cloud has to be in matrix format with 3-columns representing X, Y and Z and each row representing one point
-//' @param H2CW_fac Factor for the ratio of height to crown width. Determines kernel diameter based on its height above ground.
-//' @param H2CL_fac Factor for the ratio of height to crown length. Determines kernel height based on its height above ground.
-//' @param UniformKernel Boolean to enable the application of a simple uniform kernel without distance weighting (Default False)
-//' @param MaxIter Maximum number of iterations, i.e. steps that the kernel can move for each point. If centroid is not found after all iteration, the last position is assigned as centroid and the processing jumps to the next point
-//' @param maxx Maximum X-coordinate
-//' @param maxy Maximum Y-coordinate
-//' @param maxz Maximum Z-coordinate
-//'
-//' @return data.frame with X, Y and Z coordinates of each point in the point cloud and  X, Y and Z coordinates of the centroid to which the point belongs
-//'
-//' @export
-// [[Rcpp::export]]
-DataFrame MeanShift_Voxels(NumericMatrix pc, double H2CW_fac, double H2CL_fac, bool UniformKernel=false, int MaxIter=20, int maxx=100, int maxy=100, int maxz=60){
+namespace {
 
-  int nrows = pc.nrow();
+// Shifts the centroid of every seed through the voxel space, in which all points are counted, and stores it in the centroid vectors, which need one element per seed
+void shiftVoxelCentroids(const PointColumns& pc, const std::vector<R_xlen_t>& seedRows, double H2CW_fac, double H2CL_fac, bool UniformKernel, int MaxIter, int maxx, int maxy, int maxz, NumericVector& centroidx, NumericVector& centroidy, NumericVector& centroidz){
+
+  R_xlen_t nrows = pc.numPoints;
   int minx = 0;
   int miny = 0;
   int minz = 0;
 
-  NumericVector centroidx(nrows);
-  NumericVector centroidy(nrows);
-  NumericVector centroidz(nrows);
-
   std::vector<vector<vector<double> > >array3D;
 
   double myx;
@@ -71,11 +55,11 @@ DataFrame MeanShift_Voxels(NumericMatrix pc, double H2CW_fac, double H2CL_fac, b
   }
 
   // Loop through all points
-  for(int i=0; i<nrows; i++){
+  for(R_xlen_t i=0; i<nrows; i++){
 
-     myx = (double) pc(i,0);
-     myy = (double) pc(i,1);
-     myz = (double) pc(i,2);
+     myx = pc.pointsX[i];
+     myy = pc.pointsY[i];
+     myz = pc.pointsZ[i];
 
      vx = (int) floor(myx);
      vy = (int) floor(myy);
@@ -85,13 +69,15 @@ DataFrame MeanShift_Voxels(NumericMatrix pc, double H2CW_fac, double H2CL_fac, b
 
   }
 
-  // Loop again over each point and iteratively shift the centroid of
-  // neighbor points
-  for(int i=0; i<nrows; i++){
+  // Loop over each seed and iteratively shift the centroid of neighbor
+  // points
+  R_xlen_t numSeeds = seedRows.size();
+  for(R_xlen_t seed=0; seed<numSeeds; seed++){
+    R_xlen_t i = seedRows[seed];
 
-    double meanx = (double) pc(i,0);
-    double meany = (double) pc(i,1);
-    double meanz = (double) pc(i,2);
+    double meanx = pc.pointsX[i];
+    double meany = pc.pointsY[i];
+    double meanz = pc.pointsZ[i];
 
     double oldx = -100.0;
     double oldy = -100.0;
@@ -184,10 +170,83 @@ DataFrame MeanShift_Voxels(NumericMatrix pc, double H2CW_fac, double H2CL_fac, b
 
     }while(meanx != oldx && meany != oldy && meanz != oldz && IterCounter < MaxIter);
 
-    centroidx[i] = meanx;
-    centroidy[i] = meany;
-    centroidz[i] = meanz;
+    centroidx[seed] = meanx;
+    centroidy[seed] = meany;
+    centroidz[seed] = meanz;
+  }
+}
+
+}  // namespace
+
+
+//' Mean shift clustering using a discrete voxel space
+//'
+//' Adaptive mean shift clustering to delineate tree crowns from lidar point clouds. This is a version using 1-m³ voxels instead of exact point coordinates, to speed up processing.
+//'
+//' @param pc Point cloud has to be in matrix format with 3-columns representing X, Y and Z and each row representing one point
+//' @param H2CW_fac Factor for the ratio of height to crown width. Determines kernel diameter based on its height above ground.
+//' @param H2CL_fac Factor for the ratio of height to crown length. Determines kernel height based on its height above ground.
+//' @param UniformKernel Boolean to enable the application of a simple uniform kernel without distance weighting (Default False)
+//' @param MaxIter Maximum number of iterations, i.e. steps that the kernel can move for each point. If centroid is not found after all iteration, the last position is assigned as centroid and the processing jumps to the next point
+//' @param maxx Maximum X-coordinate
+//' @param maxy Maximum Y-coordinate
+//' @param maxz Maximum Z-coordinate
+//' @param output "full" for the data.frame described below, "modes" for only the centroid coordinates in the columns modeX, modeY and modeZ, or "indexed" for only an integer column modeIndex that points into the table of unique centroids in the attribute "modes"
+//' @param modeTolerance Distance within which centroids share one row of the table if output is "indexed"
+//' @param outputFile If not empty, path of a column file that is created to hold the result, whose columns are returned as mapped vectors like those of \code{readColumnFile}. The centroid columns are then called modeX, modeY and modeZ, like those of the other mean shift functions
+//'
+//' @return data.frame with X, Y and Z coordinates of each point in the point cloud and  X, Y and Z coordinates of the centroid to which the point belongs, or one of the lean forms selected by output
+//'
+//' @export
+// [[Rcpp::export]]
+List MeanShift_Voxels(NumericMatrix pc, double H2CW_fac, double H2CL_fac, bool UniformKernel=false, int MaxIter=20, int maxx=100, int maxy=100, int maxz=60, std::string output="full", double modeTolerance=0.01, std::string outputFile=""){
+
+  ModesOptions options = selectModesOptions(output, modeTolerance, outputFile);
+
+  PointColumns points = getPointColumns(pc);
+  std::vector<R_xlen_t> seedRows = selectSeedRows(R_NilValue, points.numPoints);
+  ModeVectors centroids(points.numPoints, options);
+  shiftVoxelCentroids(points, seedRows, H2CW_fac, H2CL_fac, UniformKernel, MaxIter, maxx, maxy, maxz, centroids.modesX, centroids.modesY, centroids.modesZ);
+
+  if(options.output != ModesOutput::full || !outputFile.empty()){
+    return centroids.createDataFrame(points, seedRows);
+  }
+
+  return DataFrame::create(_["X"]= pc(_,0),_["Y"]= pc(_,1),_["Z"]= pc(_,2),_["CtrX"]= centroids.modesX,_["CtrY"]= centroids.modesY,_["CtrZ"]= centroids.modesZ);
+}
+
+
+//' Mean shift clustering using a discrete voxel space, for point coordinates in separate columns
+//'
+//' Like \code{MeanShift_Voxels}, but takes the coordinates as three vectors, e.g. the columns of a data.frame, a data.table or the data of a lidR LAS object. Numeric vectors are read in place and returned as they are, so the coordinates are never copied.
+//'
+//' @param X,Y,Z Numeric vectors with the coordinates of the points, which have to lie between 0 and \code{maxx}, \code{maxy} and \code{maxz}
+//' @param H2CW_fac Factor for the ratio of height to crown width. Determines kernel diameter based on its height above ground.
+//' @param H2CL_fac Factor for the ratio of height to crown length. Determines kernel height based on its height above ground.
+//' @param UniformKernel Boolean to enable the application of a simple uniform kernel without distance weighting (Default False)
+//' @param MaxIter Maximum number of iterations, i.e. steps that the kernel can move for each point
+//' @param maxx Maximum X-coordinate
+//' @param maxy Maximum Y-coordinate
+//' @param maxz Maximum Z-coordinate
+//' @param output,modeTolerance,outputFile The form and destination of the result, as in \code{MeanShift_Voxels}
+//' @param isSeed Logical vector with one element per point or NULL. If given, only the centroids of the points where it is TRUE are shifted, while all points still fill the voxels
+//'
+//' @return The data.frame of \code{MeanShift_Voxels}. With \code{isSeed}, it only has the rows of the seeds and, like the lean forms, the centroid columns modeX, modeY and modeZ
+//'
+//' @export
+// [[Rcpp::export]]
+List MeanShift_Voxels_Columns(NumericVector X, NumericVector Y, NumericVector Z, double H2CW_fac, double H2CL_fac, bool UniformKernel=false, int MaxIter=20, int maxx=100, int maxy=100, int maxz=60, std::string output="full", double modeTolerance=0.01, std::string outputFile="", Nullable<LogicalVector> isSeed=R_NilValue){
+
+  ModesOptions options = selectModesOptions(output, modeTolerance, outputFile);
+
+  PointColumns points = getPointColumns(X, Y, Z);
+  std::vector<R_xlen_t> seedRows = selectSeedRows(isSeed, points.numPoints);
+  ModeVectors centroids(seedRows.size(), options);
+  shiftVoxelCentroids(points, seedRows, H2CW_fac, H2CL_fac, UniformKernel, MaxIter, maxx, maxy, maxz, centroids.modesX, centroids.modesY, centroids.modesZ);
+
+  if(options.output != ModesOutput::full || !outputFile.empty() || isSeed.isNotNull()){
+    return centroids.createDataFrame(points, seedRows);
   }
 
-  return DataFrame::create(_["X"]= pc(_,0),_["Y"]= pc(_,1),_["Z"]= pc(_,2),_["CtrX"]= centroidx,_["CtrY"]= centroidy,_["CtrZ"]= centroidz);
+  return DataFrame::create(_["X"]= X,_["Y"]= Y,_["Z"]= Z,_["CtrX"]= centroids.modesX,_["CtrY"]= centroids.modesY,_["CtrZ"]= centroids.modesZ);
 }
@@ -6,8 +6,8 @@
 using namespace Rcpp;
 
 // MeanShift_Voxels
-DataFrame MeanShift_Voxels(NumericMatrix pc, double H2CW_fac, double H2CL_fac, bool UniformKernel, int MaxIter, int maxx, int maxy, int maxz);
-RcppExport SEXP _meanshiftr_MeanShift_Voxels(SEXP pcSEXP, SEXP H2CW_facSEXP, SEXP H2CL_facSEXP, SEXP UniformKernelSEXP, SEXP MaxIterSEXP, SEXP maxxSEXP, SEXP maxySEXP, SEXP maxzSEXP) {
+List MeanShift_Voxels(NumericMatrix pc, double H2CW_fac, double H2CL_fac, bool UniformKernel, int MaxIter, int maxx, int maxy, int maxz, std::string output, double modeTolerance, std::string outputFile);
+RcppExport SEXP _meanshiftr_MeanShift_Voxels(SEXP pcSEXP, SEXP H2CW_facSEXP, SEXP H2CL_facSEXP, SEXP UniformKernelSEXP, SEXP MaxIterSEXP, SEXP maxxSEXP, SEXP maxySEXP, SEXP maxzSEXP, SEXP outputSEXP, SEXP modeToleranceSEXP, SEXP outputFileSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -19,13 +19,189 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< int >::type maxx(maxxSEXP);
     Rcpp::traits::input_parameter< int >::type maxy(maxySEXP);
     Rcpp::traits::input_parameter< int >::type maxz(maxzSEXP);
-    rcpp_result_gen = Rcpp::wrap(MeanShift_Voxels(pc, H2CW_fac, H2CL_fac, UniformKernel, MaxIter, maxx, maxy, maxz));
+    Rcpp::traits::input_parameter< std::string >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< double >::type modeTolerance(modeToleranceSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputFile(outputFileSEXP);
+    rcpp_result_gen = Rcpp::wrap(MeanShift_Voxels(pc, H2CW_fac, H2CL_fac, UniformKernel, MaxIter, maxx, maxy, maxz, output, modeTolerance, outputFile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// MeanShift_Voxels_Columns
+List MeanShift_Voxels_Columns(NumericVector X, NumericVector Y, NumericVector Z, double H2CW_fac, double H2CL_fac, bool UniformKernel, int MaxIter, int maxx, int maxy, int maxz, std::string output, double modeTolerance, std::string outputFile, Nullable<LogicalVector> isSeed);
+RcppExport SEXP _meanshiftr_MeanShift_Voxels_Columns(SEXP XSEXP, SEXP YSEXP, SEXP ZSEXP, SEXP H2CW_facSEXP, SEXP H2CL_facSEXP, SEXP UniformKernelSEXP, SEXP MaxIterSEXP, SEXP maxxSEXP, SEXP maxySEXP, SEXP maxzSEXP, SEXP outputSEXP, SEXP modeToleranceSEXP, SEXP outputFileSEXP, SEXP isSeedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type X(XSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Y(YSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Z(ZSEXP);
+    Rcpp::traits::input_parameter< double >::type H2CW_fac(H2CW_facSEXP);
+    Rcpp::traits::input_parameter< double >::type H2CL_fac(H2CL_facSEXP);
+    Rcpp::traits::input_parameter< bool >::type UniformKernel(UniformKernelSEXP);
+    Rcpp::traits::input_parameter< int >::type MaxIter(MaxIterSEXP);
+    Rcpp::traits::input_parameter< int >::type maxx(maxxSEXP);
+    Rcpp::traits::input_parameter< int >::type maxy(maxySEXP);
+    Rcpp::traits::input_parameter< int >::type maxz(maxzSEXP);
+    Rcpp::traits::input_parameter< std::string >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< double >::type modeTolerance(modeToleranceSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputFile(outputFileSEXP);
+    Rcpp::traits::input_parameter< Nullable<LogicalVector> >::type isSeed(isSeedSEXP);
+    rcpp_result_gen = Rcpp::wrap(MeanShift_Voxels_Columns(X, Y, Z, H2CW_fac, H2CL_fac, UniformKernel, MaxIter, maxx, maxy, maxz, output, modeTolerance, outputFile, isSeed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// blurringMeanShift
+Rcpp::DataFrame blurringMeanShift(Rcpp::NumericMatrix pointCloud, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int maxNumRounds, double mergeTolerance, int numThreads, std::string output, std::string outputFile);
+RcppExport SEXP _meanshiftr_blurringMeanShift(SEXP pointCloudSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP maxNumRoundsSEXP, SEXP mergeToleranceSEXP, SEXP numThreadsSEXP, SEXP outputSEXP, SEXP outputFileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type pointCloud(pointCloudSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumRounds(maxNumRoundsSEXP);
+    Rcpp::traits::input_parameter< double >::type mergeTolerance(mergeToleranceSEXP);
+    Rcpp::traits::input_parameter< int >::type numThreads(numThreadsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputFile(outputFileSEXP);
+    rcpp_result_gen = Rcpp::wrap(blurringMeanShift(pointCloud, crownDiameter2TreeHeight, crownHeight2TreeHeight, maxNumRounds, mergeTolerance, numThreads, output, outputFile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// buildLasCatalog
+Rcpp::DataFrame buildLasCatalog(Rcpp::CharacterVector files, std::string catalogFile, double cellSize, int numThreads);
+RcppExport SEXP _meanshiftr_buildLasCatalog(SEXP filesSEXP, SEXP catalogFileSEXP, SEXP cellSizeSEXP, SEXP numThreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type files(filesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type catalogFile(catalogFileSEXP);
+    Rcpp::traits::input_parameter< double >::type cellSize(cellSizeSEXP);
+    Rcpp::traits::input_parameter< int >::type numThreads(numThreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(buildLasCatalog(files, catalogFile, cellSize, numThreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readLasCatalog
+Rcpp::DataFrame readLasCatalog(std::string catalogFile);
+RcppExport SEXP _meanshiftr_readLasCatalog(SEXP catalogFileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type catalogFile(catalogFileSEXP);
+    rcpp_result_gen = Rcpp::wrap(readLasCatalog(catalogFile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// planLasCatalogTiles
+Rcpp::DataFrame planLasCatalogTiles(std::string catalogFile, double coreWidth);
+RcppExport SEXP _meanshiftr_planLasCatalogTiles(SEXP catalogFileSEXP, SEXP coreWidthSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type catalogFile(catalogFileSEXP);
+    Rcpp::traits::input_parameter< double >::type coreWidth(coreWidthSEXP);
+    rcpp_result_gen = Rcpp::wrap(planLasCatalogTiles(catalogFile, coreWidth));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readLasCatalogTile
+Rcpp::DataFrame readLasCatalogTile(std::string catalogFile, double tileId, double coreWidth, double bufferWidth, Rcpp::Nullable<Rcpp::IntegerVector> classifications, Rcpp::Nullable<Rcpp::IntegerVector> returnNumbers);
+RcppExport SEXP _meanshiftr_readLasCatalogTile(SEXP catalogFileSEXP, SEXP tileIdSEXP, SEXP coreWidthSEXP, SEXP bufferWidthSEXP, SEXP classificationsSEXP, SEXP returnNumbersSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type catalogFile(catalogFileSEXP);
+    Rcpp::traits::input_parameter< double >::type tileId(tileIdSEXP);
+    Rcpp::traits::input_parameter< double >::type coreWidth(coreWidthSEXP);
+    Rcpp::traits::input_parameter< double >::type bufferWidth(bufferWidthSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type classifications(classificationsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type returnNumbers(returnNumbersSEXP);
+    rcpp_result_gen = Rcpp::wrap(readLasCatalogTile(catalogFile, tileId, coreWidth, bufferWidth, classifications, returnNumbers));
+    return rcpp_result_gen;
+END_RCPP
+}
+// segmentLasCatalog
+Rcpp::DataFrame segmentLasCatalog(std::string catalogFile, Rcpp::NumericVector tileIds, Rcpp::CharacterVector outputFiles, double coreWidth, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int minNumNeighborsPerCore, double neighborhoodRadius, int maxNumCentroidsPerMode, int maxNumNeighbors, double minHeight, double bufferWidth, double seedBufferWidth, Rcpp::Nullable<Rcpp::IntegerVector> classifications, Rcpp::Nullable<Rcpp::IntegerVector> returnNumbers, int numReaders, int numSegmenters, int numWriters, int queueCapacity);
+RcppExport SEXP _meanshiftr_segmentLasCatalog(SEXP catalogFileSEXP, SEXP tileIdsSEXP, SEXP outputFilesSEXP, SEXP coreWidthSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP minNumNeighborsPerCoreSEXP, SEXP neighborhoodRadiusSEXP, SEXP maxNumCentroidsPerModeSEXP, SEXP maxNumNeighborsSEXP, SEXP minHeightSEXP, SEXP bufferWidthSEXP, SEXP seedBufferWidthSEXP, SEXP classificationsSEXP, SEXP returnNumbersSEXP, SEXP numReadersSEXP, SEXP numSegmentersSEXP, SEXP numWritersSEXP, SEXP queueCapacitySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type catalogFile(catalogFileSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type tileIds(tileIdsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type outputFiles(outputFilesSEXP);
+    Rcpp::traits::input_parameter< double >::type coreWidth(coreWidthSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type minNumNeighborsPerCore(minNumNeighborsPerCoreSEXP);
+    Rcpp::traits::input_parameter< double >::type neighborhoodRadius(neighborhoodRadiusSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumCentroidsPerMode(maxNumCentroidsPerModeSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumNeighbors(maxNumNeighborsSEXP);
+    Rcpp::traits::input_parameter< double >::type minHeight(minHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type bufferWidth(bufferWidthSEXP);
+    Rcpp::traits::input_parameter< double >::type seedBufferWidth(seedBufferWidthSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type classifications(classificationsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type returnNumbers(returnNumbersSEXP);
+    Rcpp::traits::input_parameter< int >::type numReaders(numReadersSEXP);
+    Rcpp::traits::input_parameter< int >::type numSegmenters(numSegmentersSEXP);
+    Rcpp::traits::input_parameter< int >::type numWriters(numWritersSEXP);
+    Rcpp::traits::input_parameter< int >::type queueCapacity(queueCapacitySEXP);
+    rcpp_result_gen = Rcpp::wrap(segmentLasCatalog(catalogFile, tileIds, outputFiles, coreWidth, crownDiameter2TreeHeight, crownHeight2TreeHeight, minNumNeighborsPerCore, neighborhoodRadius, maxNumCentroidsPerMode, maxNumNeighbors, minHeight, bufferWidth, seedBufferWidth, classifications, returnNumbers, numReaders, numSegmenters, numWriters, queueCapacity));
+    return rcpp_result_gen;
+END_RCPP
+}
+// writeColumnFile
+Rcpp::List writeColumnFile(std::string file, Rcpp::List columns);
+RcppExport SEXP _meanshiftr_writeColumnFile(SEXP fileSEXP, SEXP columnsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type columns(columnsSEXP);
+    rcpp_result_gen = Rcpp::wrap(writeColumnFile(file, columns));
+    return rcpp_result_gen;
+END_RCPP
+}
+// writeLasColumnFile
+Rcpp::List writeLasColumnFile(std::vector<std::string> lasFiles, std::string file, Rcpp::Nullable<Rcpp::IntegerVector> classifications, Rcpp::Nullable<Rcpp::IntegerVector> returnNumbers);
+RcppExport SEXP _meanshiftr_writeLasColumnFile(SEXP lasFilesSEXP, SEXP fileSEXP, SEXP classificationsSEXP, SEXP returnNumbersSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type lasFiles(lasFilesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type classifications(classificationsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type returnNumbers(returnNumbersSEXP);
+    rcpp_result_gen = Rcpp::wrap(writeLasColumnFile(lasFiles, file, classifications, returnNumbers));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readColumnFile
+Rcpp::List readColumnFile(std::string file);
+RcppExport SEXP _meanshiftr_readColumnFile(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(readColumnFile(file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readColumnFileMatrix
+Rcpp::NumericMatrix readColumnFileMatrix(std::string file, Rcpp::CharacterVector columns);
+RcppExport SEXP _meanshiftr_readColumnFileMatrix(SEXP fileSEXP, SEXP columnsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type columns(columnsSEXP);
+    rcpp_result_gen = Rcpp::wrap(readColumnFileMatrix(file, columns));
     return rcpp_result_gen;
 END_RCPP
 }
 // meanShiftClassic
-DataFrame meanShiftClassic(NumericMatrix pointCloud, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int maxNumCentroidsPerMode);
-RcppExport SEXP _meanshiftr_meanShiftClassic(SEXP pointCloudSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP maxNumCentroidsPerModeSEXP) {
+List meanShiftClassic(NumericMatrix pointCloud, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int maxNumCentroidsPerMode, Nullable<LogicalVector> isSeed, std::string output, double modeTolerance, std::string outputFile);
+RcppExport SEXP _meanshiftr_meanShiftClassic(SEXP pointCloudSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP maxNumCentroidsPerModeSEXP, SEXP isSeedSEXP, SEXP outputSEXP, SEXP modeToleranceSEXP, SEXP outputFileSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -33,33 +209,514 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
     Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
     Rcpp::traits::input_parameter< int >::type maxNumCentroidsPerMode(maxNumCentroidsPerModeSEXP);
-    rcpp_result_gen = Rcpp::wrap(meanShiftClassic(pointCloud, crownDiameter2TreeHeight, crownHeight2TreeHeight, maxNumCentroidsPerMode));
+    Rcpp::traits::input_parameter< Nullable<LogicalVector> >::type isSeed(isSeedSEXP);
+    Rcpp::traits::input_parameter< std::string >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< double >::type modeTolerance(modeToleranceSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputFile(outputFileSEXP);
+    rcpp_result_gen = Rcpp::wrap(meanShiftClassic(pointCloud, crownDiameter2TreeHeight, crownHeight2TreeHeight, maxNumCentroidsPerMode, isSeed, output, modeTolerance, outputFile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// meanShiftClassicColumns
+List meanShiftClassicColumns(NumericVector pointsX, NumericVector pointsY, NumericVector pointsZ, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int maxNumCentroidsPerMode, Nullable<LogicalVector> isSeed, std::string output, double modeTolerance, std::string outputFile);
+RcppExport SEXP _meanshiftr_meanShiftClassicColumns(SEXP pointsXSEXP, SEXP pointsYSEXP, SEXP pointsZSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP maxNumCentroidsPerModeSEXP, SEXP isSeedSEXP, SEXP outputSEXP, SEXP modeToleranceSEXP, SEXP outputFileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type pointsX(pointsXSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type pointsY(pointsYSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type pointsZ(pointsZSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumCentroidsPerMode(maxNumCentroidsPerModeSEXP);
+    Rcpp::traits::input_parameter< Nullable<LogicalVector> >::type isSeed(isSeedSEXP);
+    Rcpp::traits::input_parameter< std::string >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< double >::type modeTolerance(modeToleranceSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputFile(outputFileSEXP);
+    rcpp_result_gen = Rcpp::wrap(meanShiftClassicColumns(pointsX, pointsY, pointsZ, crownDiameter2TreeHeight, crownHeight2TreeHeight, maxNumCentroidsPerMode, isSeed, output, modeTolerance, outputFile));
     return rcpp_result_gen;
 END_RCPP
 }
 // meanShiftClassicImproved
-Rcpp::DataFrame meanShiftClassicImproved(Rcpp::NumericMatrix pointCloud, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int maxNumCentroidsPerMode);
-RcppExport SEXP _meanshiftr_meanShiftClassicImproved(SEXP pointCloudSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP maxNumCentroidsPerModeSEXP) {
+Rcpp::List meanShiftClassicImproved(Rcpp::NumericMatrix pointCloud, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int maxNumCentroidsPerMode, int maxNumNeighbors, Rcpp::Nullable<Rcpp::LogicalVector> isSeed, std::string output, double modeTolerance, std::string outputFile);
+RcppExport SEXP _meanshiftr_meanShiftClassicImproved(SEXP pointCloudSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP maxNumCentroidsPerModeSEXP, SEXP maxNumNeighborsSEXP, SEXP isSeedSEXP, SEXP outputSEXP, SEXP modeToleranceSEXP, SEXP outputFileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type pointCloud(pointCloudSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumCentroidsPerMode(maxNumCentroidsPerModeSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumNeighbors(maxNumNeighborsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::LogicalVector> >::type isSeed(isSeedSEXP);
+    Rcpp::traits::input_parameter< std::string >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< double >::type modeTolerance(modeToleranceSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputFile(outputFileSEXP);
+    rcpp_result_gen = Rcpp::wrap(meanShiftClassicImproved(pointCloud, crownDiameter2TreeHeight, crownHeight2TreeHeight, maxNumCentroidsPerMode, maxNumNeighbors, isSeed, output, modeTolerance, outputFile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// meanShiftClassicImprovedColumns
+Rcpp::List meanShiftClassicImprovedColumns(Rcpp::NumericVector pointsX, Rcpp::NumericVector pointsY, Rcpp::NumericVector pointsZ, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int maxNumCentroidsPerMode, int maxNumNeighbors, Rcpp::Nullable<Rcpp::LogicalVector> isSeed, std::string output, double modeTolerance, std::string outputFile);
+RcppExport SEXP _meanshiftr_meanShiftClassicImprovedColumns(SEXP pointsXSEXP, SEXP pointsYSEXP, SEXP pointsZSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP maxNumCentroidsPerModeSEXP, SEXP maxNumNeighborsSEXP, SEXP isSeedSEXP, SEXP outputSEXP, SEXP modeToleranceSEXP, SEXP outputFileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type pointsX(pointsXSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type pointsY(pointsYSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type pointsZ(pointsZSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumCentroidsPerMode(maxNumCentroidsPerModeSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumNeighbors(maxNumNeighborsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::LogicalVector> >::type isSeed(isSeedSEXP);
+    Rcpp::traits::input_parameter< std::string >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< double >::type modeTolerance(modeToleranceSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputFile(outputFileSEXP);
+    rcpp_result_gen = Rcpp::wrap(meanShiftClassicImprovedColumns(pointsX, pointsY, pointsZ, crownDiameter2TreeHeight, crownHeight2TreeHeight, maxNumCentroidsPerMode, maxNumNeighbors, isSeed, output, modeTolerance, outputFile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// meanShiftClassicImprovedBuilder
+Rcpp::List meanShiftClassicImprovedBuilder(SEXP builder, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int maxNumCentroidsPerMode, int maxNumNeighbors, Rcpp::Nullable<Rcpp::LogicalVector> isSeed, std::string output, double modeTolerance, std::string outputFile);
+RcppExport SEXP _meanshiftr_meanShiftClassicImprovedBuilder(SEXP builderSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP maxNumCentroidsPerModeSEXP, SEXP maxNumNeighborsSEXP, SEXP isSeedSEXP, SEXP outputSEXP, SEXP modeToleranceSEXP, SEXP outputFileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type builder(builderSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumCentroidsPerMode(maxNumCentroidsPerModeSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumNeighbors(maxNumNeighborsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::LogicalVector> >::type isSeed(isSeedSEXP);
+    Rcpp::traits::input_parameter< std::string >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< double >::type modeTolerance(modeToleranceSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputFile(outputFileSEXP);
+    rcpp_result_gen = Rcpp::wrap(meanShiftClassicImprovedBuilder(builder, crownDiameter2TreeHeight, crownHeight2TreeHeight, maxNumCentroidsPerMode, maxNumNeighbors, isSeed, output, modeTolerance, outputFile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// meanShiftFastGauss
+Rcpp::DataFrame meanShiftFastGauss(Rcpp::NumericMatrix pointCloud, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int maxNumCentroidsPerMode, double absoluteTolerance, Rcpp::Nullable<Rcpp::LogicalVector> isSeed, std::string output, double modeTolerance, std::string outputFile);
+RcppExport SEXP _meanshiftr_meanShiftFastGauss(SEXP pointCloudSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP maxNumCentroidsPerModeSEXP, SEXP absoluteToleranceSEXP, SEXP isSeedSEXP, SEXP outputSEXP, SEXP modeToleranceSEXP, SEXP outputFileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type pointCloud(pointCloudSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumCentroidsPerMode(maxNumCentroidsPerModeSEXP);
+    Rcpp::traits::input_parameter< double >::type absoluteTolerance(absoluteToleranceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::LogicalVector> >::type isSeed(isSeedSEXP);
+    Rcpp::traits::input_parameter< std::string >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< double >::type modeTolerance(modeToleranceSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputFile(outputFileSEXP);
+    rcpp_result_gen = Rcpp::wrap(meanShiftFastGauss(pointCloud, crownDiameter2TreeHeight, crownHeight2TreeHeight, maxNumCentroidsPerMode, absoluteTolerance, isSeed, output, modeTolerance, outputFile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// createPointCloudBuilder
+SEXP createPointCloudBuilder(Rcpp::CharacterVector attributes, bool withWeights, double capacity);
+RcppExport SEXP _meanshiftr_createPointCloudBuilder(SEXP attributesSEXP, SEXP withWeightsSEXP, SEXP capacitySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type attributes(attributesSEXP);
+    Rcpp::traits::input_parameter< bool >::type withWeights(withWeightsSEXP);
+    Rcpp::traits::input_parameter< double >::type capacity(capacitySEXP);
+    rcpp_result_gen = Rcpp::wrap(createPointCloudBuilder(attributes, withWeights, capacity));
+    return rcpp_result_gen;
+END_RCPP
+}
+// appendPointChunk
+void appendPointChunk(SEXP builder, Rcpp::NumericVector X, Rcpp::NumericVector Y, Rcpp::NumericVector Z, Rcpp::Nullable<Rcpp::NumericVector> weights, Rcpp::Nullable<Rcpp::List> attributes);
+RcppExport SEXP _meanshiftr_appendPointChunk(SEXP builderSEXP, SEXP XSEXP, SEXP YSEXP, SEXP ZSEXP, SEXP weightsSEXP, SEXP attributesSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type builder(builderSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type X(XSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type Y(YSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type Z(ZSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type weights(weightsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::List> >::type attributes(attributesSEXP);
+    appendPointChunk(builder, X, Y, Z, weights, attributes);
+    return R_NilValue;
+END_RCPP
+}
+// finalizePointCloudBuilder
+Rcpp::List finalizePointCloudBuilder(SEXP builder, double crownDiameter2TreeHeight);
+RcppExport SEXP _meanshiftr_finalizePointCloudBuilder(SEXP builderSEXP, SEXP crownDiameter2TreeHeightSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type builder(builderSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    rcpp_result_gen = Rcpp::wrap(finalizePointCloudBuilder(builder, crownDiameter2TreeHeight));
+    return rcpp_result_gen;
+END_RCPP
+}
+// pointCloudBuilderColumns
+Rcpp::List pointCloudBuilderColumns(SEXP builder);
+RcppExport SEXP _meanshiftr_pointCloudBuilderColumns(SEXP builderSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type builder(builderSEXP);
+    rcpp_result_gen = Rcpp::wrap(pointCloudBuilderColumns(builder));
+    return rcpp_result_gen;
+END_RCPP
+}
+// pointCloudBuilderMatrix
+Rcpp::NumericMatrix pointCloudBuilderMatrix(SEXP builder);
+RcppExport SEXP _meanshiftr_pointCloudBuilderMatrix(SEXP builderSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type builder(builderSEXP);
+    rcpp_result_gen = Rcpp::wrap(pointCloudBuilderMatrix(builder));
+    return rcpp_result_gen;
+END_RCPP
+}
+// quickShift
+Rcpp::DataFrame quickShift(Rcpp::NumericMatrix pointCloud, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, Rcpp::Nullable<Rcpp::LogicalVector> isSeed, std::string output, double modeTolerance, std::string outputFile);
+RcppExport SEXP _meanshiftr_quickShift(SEXP pointCloudSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP isSeedSEXP, SEXP outputSEXP, SEXP modeToleranceSEXP, SEXP outputFileSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type pointCloud(pointCloudSEXP);
     Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
     Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::LogicalVector> >::type isSeed(isSeedSEXP);
+    Rcpp::traits::input_parameter< std::string >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< double >::type modeTolerance(modeToleranceSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputFile(outputFileSEXP);
+    rcpp_result_gen = Rcpp::wrap(quickShift(pointCloud, crownDiameter2TreeHeight, crownHeight2TreeHeight, isSeed, output, modeTolerance, outputFile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readLasPoints
+Rcpp::NumericMatrix readLasPoints(std::string file, Rcpp::Nullable<Rcpp::IntegerVector> classifications, Rcpp::Nullable<Rcpp::IntegerVector> returnNumbers, Rcpp::Nullable<Rcpp::NumericVector> bbox, double minHeight, int numThreads);
+RcppExport SEXP _meanshiftr_readLasPoints(SEXP fileSEXP, SEXP classificationsSEXP, SEXP returnNumbersSEXP, SEXP bboxSEXP, SEXP minHeightSEXP, SEXP numThreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type classifications(classificationsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type returnNumbers(returnNumbersSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type bbox(bboxSEXP);
+    Rcpp::traits::input_parameter< double >::type minHeight(minHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type numThreads(numThreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(readLasPoints(file, classifications, returnNumbers, bbox, minHeight, numThreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readLasPointsBuilder
+SEXP readLasPointsBuilder(std::string file, Rcpp::Nullable<Rcpp::IntegerVector> classifications, Rcpp::Nullable<Rcpp::IntegerVector> returnNumbers, Rcpp::Nullable<Rcpp::NumericVector> bbox, double minHeight, double crownDiameter2TreeHeight, int numThreads);
+RcppExport SEXP _meanshiftr_readLasPointsBuilder(SEXP fileSEXP, SEXP classificationsSEXP, SEXP returnNumbersSEXP, SEXP bboxSEXP, SEXP minHeightSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP numThreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type classifications(classificationsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type returnNumbers(returnNumbersSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type bbox(bboxSEXP);
+    Rcpp::traits::input_parameter< double >::type minHeight(minHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type numThreads(numThreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(readLasPointsBuilder(file, classifications, returnNumbers, bbox, minHeight, crownDiameter2TreeHeight, numThreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// segmentTileFiles
+Rcpp::DataFrame segmentTileFiles(Rcpp::CharacterVector inputFiles, Rcpp::CharacterVector outputFiles, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int minNumNeighborsPerCore, double neighborhoodRadius, int maxNumCentroidsPerMode, int maxNumNeighbors, double minHeight, double bufferWidth, double seedBufferWidth, int numReaders, int numSegmenters, int numWriters, int queueCapacity);
+RcppExport SEXP _meanshiftr_segmentTileFiles(SEXP inputFilesSEXP, SEXP outputFilesSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP minNumNeighborsPerCoreSEXP, SEXP neighborhoodRadiusSEXP, SEXP maxNumCentroidsPerModeSEXP, SEXP maxNumNeighborsSEXP, SEXP minHeightSEXP, SEXP bufferWidthSEXP, SEXP seedBufferWidthSEXP, SEXP numReadersSEXP, SEXP numSegmentersSEXP, SEXP numWritersSEXP, SEXP queueCapacitySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type inputFiles(inputFilesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type outputFiles(outputFilesSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type minNumNeighborsPerCore(minNumNeighborsPerCoreSEXP);
+    Rcpp::traits::input_parameter< double >::type neighborhoodRadius(neighborhoodRadiusSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumCentroidsPerMode(maxNumCentroidsPerModeSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumNeighbors(maxNumNeighborsSEXP);
+    Rcpp::traits::input_parameter< double >::type minHeight(minHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type bufferWidth(bufferWidthSEXP);
+    Rcpp::traits::input_parameter< double >::type seedBufferWidth(seedBufferWidthSEXP);
+    Rcpp::traits::input_parameter< int >::type numReaders(numReadersSEXP);
+    Rcpp::traits::input_parameter< int >::type numSegmenters(numSegmentersSEXP);
+    Rcpp::traits::input_parameter< int >::type numWriters(numWritersSEXP);
+    Rcpp::traits::input_parameter< int >::type queueCapacity(queueCapacitySEXP);
+    rcpp_result_gen = Rcpp::wrap(segmentTileFiles(inputFiles, outputFiles, crownDiameter2TreeHeight, crownHeight2TreeHeight, minNumNeighborsPerCore, neighborhoodRadius, maxNumCentroidsPerMode, maxNumNeighbors, minHeight, bufferWidth, seedBufferWidth, numReaders, numSegmenters, numWriters, queueCapacity));
+    return rcpp_result_gen;
+END_RCPP
+}
+// segmentTilesBatch
+Rcpp::DataFrame segmentTilesBatch(Rcpp::List tiles, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int minNumNeighborsPerCore, double neighborhoodRadius, int maxNumCentroidsPerMode, int maxNumNeighbors, double minHeight, double bufferWidth, double seedBufferWidth, int numThreads, int seedChunkSize, Rcpp::Nullable<Rcpp::IntegerVector> tileOrder);
+RcppExport SEXP _meanshiftr_segmentTilesBatch(SEXP tilesSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP minNumNeighborsPerCoreSEXP, SEXP neighborhoodRadiusSEXP, SEXP maxNumCentroidsPerModeSEXP, SEXP maxNumNeighborsSEXP, SEXP minHeightSEXP, SEXP bufferWidthSEXP, SEXP seedBufferWidthSEXP, SEXP numThreadsSEXP, SEXP seedChunkSizeSEXP, SEXP tileOrderSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type tiles(tilesSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type minNumNeighborsPerCore(minNumNeighborsPerCoreSEXP);
+    Rcpp::traits::input_parameter< double >::type neighborhoodRadius(neighborhoodRadiusSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumCentroidsPerMode(maxNumCentroidsPerModeSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumNeighbors(maxNumNeighborsSEXP);
+    Rcpp::traits::input_parameter< double >::type minHeight(minHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type bufferWidth(bufferWidthSEXP);
+    Rcpp::traits::input_parameter< double >::type seedBufferWidth(seedBufferWidthSEXP);
+    Rcpp::traits::input_parameter< int >::type numThreads(numThreadsSEXP);
+    Rcpp::traits::input_parameter< int >::type seedChunkSize(seedChunkSizeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type tileOrder(tileOrderSEXP);
+    rcpp_result_gen = Rcpp::wrap(segmentTilesBatch(tiles, crownDiameter2TreeHeight, crownHeight2TreeHeight, minNumNeighborsPerCore, neighborhoodRadius, maxNumCentroidsPerMode, maxNumNeighbors, minHeight, bufferWidth, seedBufferWidth, numThreads, seedChunkSize, tileOrder));
+    return rcpp_result_gen;
+END_RCPP
+}
+// segmentTreeCrownsGlobal
+Rcpp::List segmentTreeCrownsGlobal(Rcpp::NumericMatrix pointCloud, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int minNumNeighborsPerCore, double neighborhoodRadius, int maxNumCentroidsPerMode, int maxNumNeighbors, int numThreads);
+RcppExport SEXP _meanshiftr_segmentTreeCrownsGlobal(SEXP pointCloudSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP minNumNeighborsPerCoreSEXP, SEXP neighborhoodRadiusSEXP, SEXP maxNumCentroidsPerModeSEXP, SEXP maxNumNeighborsSEXP, SEXP numThreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type pointCloud(pointCloudSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type minNumNeighborsPerCore(minNumNeighborsPerCoreSEXP);
+    Rcpp::traits::input_parameter< double >::type neighborhoodRadius(neighborhoodRadiusSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumCentroidsPerMode(maxNumCentroidsPerModeSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumNeighbors(maxNumNeighborsSEXP);
+    Rcpp::traits::input_parameter< int >::type numThreads(numThreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(segmentTreeCrownsGlobal(pointCloud, crownDiameter2TreeHeight, crownHeight2TreeHeight, minNumNeighborsPerCore, neighborhoodRadius, maxNumCentroidsPerMode, maxNumNeighbors, numThreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// segmentTreeCrownsGlobalColumns
+Rcpp::List segmentTreeCrownsGlobalColumns(Rcpp::NumericVector pointsX, Rcpp::NumericVector pointsY, Rcpp::NumericVector pointsZ, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int minNumNeighborsPerCore, double neighborhoodRadius, int maxNumCentroidsPerMode, int maxNumNeighbors, int numThreads);
+RcppExport SEXP _meanshiftr_segmentTreeCrownsGlobalColumns(SEXP pointsXSEXP, SEXP pointsYSEXP, SEXP pointsZSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP minNumNeighborsPerCoreSEXP, SEXP neighborhoodRadiusSEXP, SEXP maxNumCentroidsPerModeSEXP, SEXP maxNumNeighborsSEXP, SEXP numThreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type pointsX(pointsXSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type pointsY(pointsYSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type pointsZ(pointsZSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type minNumNeighborsPerCore(minNumNeighborsPerCoreSEXP);
+    Rcpp::traits::input_parameter< double >::type neighborhoodRadius(neighborhoodRadiusSEXP);
     Rcpp::traits::input_parameter< int >::type maxNumCentroidsPerMode(maxNumCentroidsPerModeSEXP);
-    rcpp_result_gen = Rcpp::wrap(meanShiftClassicImproved(pointCloud, crownDiameter2TreeHeight, crownHeight2TreeHeight, maxNumCentroidsPerMode));
+    Rcpp::traits::input_parameter< int >::type maxNumNeighbors(maxNumNeighborsSEXP);
+    Rcpp::traits::input_parameter< int >::type numThreads(numThreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(segmentTreeCrownsGlobalColumns(pointsX, pointsY, pointsZ, crownDiameter2TreeHeight, crownHeight2TreeHeight, minNumNeighborsPerCore, neighborhoodRadius, maxNumCentroidsPerMode, maxNumNeighbors, numThreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// splitPointCloudBufferedIndices
+Rcpp::List splitPointCloudBufferedIndices(Rcpp::NumericVector pointsX, Rcpp::NumericVector pointsY, double coreWidth, double bufferWidth, Rcpp::Nullable<Rcpp::NumericVector> pointsZ, double crownDiameter2TreeHeight);
+RcppExport SEXP _meanshiftr_splitPointCloudBufferedIndices(SEXP pointsXSEXP, SEXP pointsYSEXP, SEXP coreWidthSEXP, SEXP bufferWidthSEXP, SEXP pointsZSEXP, SEXP crownDiameter2TreeHeightSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type pointsX(pointsXSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type pointsY(pointsYSEXP);
+    Rcpp::traits::input_parameter< double >::type coreWidth(coreWidthSEXP);
+    Rcpp::traits::input_parameter< double >::type bufferWidth(bufferWidthSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type pointsZ(pointsZSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    rcpp_result_gen = Rcpp::wrap(splitPointCloudBufferedIndices(pointsX, pointsY, coreWidth, bufferWidth, pointsZ, crownDiameter2TreeHeight));
+    return rcpp_result_gen;
+END_RCPP
+}
+// splitPointCloudQuadtreeIndices
+Rcpp::List splitPointCloudQuadtreeIndices(Rcpp::NumericVector pointsX, Rcpp::NumericVector pointsY, int maxNumPointsPerTile, double minCoreWidth, double bufferWidth, Rcpp::Nullable<Rcpp::NumericVector> pointsZ, double crownDiameter2TreeHeight);
+RcppExport SEXP _meanshiftr_splitPointCloudQuadtreeIndices(SEXP pointsXSEXP, SEXP pointsYSEXP, SEXP maxNumPointsPerTileSEXP, SEXP minCoreWidthSEXP, SEXP bufferWidthSEXP, SEXP pointsZSEXP, SEXP crownDiameter2TreeHeightSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type pointsX(pointsXSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type pointsY(pointsYSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumPointsPerTile(maxNumPointsPerTileSEXP);
+    Rcpp::traits::input_parameter< double >::type minCoreWidth(minCoreWidthSEXP);
+    Rcpp::traits::input_parameter< double >::type bufferWidth(bufferWidthSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type pointsZ(pointsZSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    rcpp_result_gen = Rcpp::wrap(splitPointCloudQuadtreeIndices(pointsX, pointsY, maxNumPointsPerTile, minCoreWidth, bufferWidth, pointsZ, crownDiameter2TreeHeight));
     return rcpp_result_gen;
 END_RCPP
 }
+// stitchTileCrowns
+Rcpp::IntegerVector stitchTileCrowns(Rcpp::IntegerVector tiles, Rcpp::IntegerVector pointIds, Rcpp::IntegerVector crownIds, Rcpp::LogicalVector isBuffer, Rcpp::NumericVector modesX, Rcpp::NumericVector modesY, Rcpp::NumericVector modesZ, double modeTolerance, int minNumSharedPoints);
+RcppExport SEXP _meanshiftr_stitchTileCrowns(SEXP tilesSEXP, SEXP pointIdsSEXP, SEXP crownIdsSEXP, SEXP isBufferSEXP, SEXP modesXSEXP, SEXP modesYSEXP, SEXP modesZSEXP, SEXP modeToleranceSEXP, SEXP minNumSharedPointsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type tiles(tilesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type pointIds(pointIdsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type crownIds(crownIdsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type isBuffer(isBufferSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type modesX(modesXSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type modesY(modesYSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type modesZ(modesZSEXP);
+    Rcpp::traits::input_parameter< double >::type modeTolerance(modeToleranceSEXP);
+    Rcpp::traits::input_parameter< int >::type minNumSharedPoints(minNumSharedPointsSEXP);
+    rcpp_result_gen = Rcpp::wrap(stitchTileCrowns(tiles, pointIds, crownIds, isBuffer, modesX, modesY, modesZ, modeTolerance, minNumSharedPoints));
+    return rcpp_result_gen;
+END_RCPP
+}
+// writeTileCacheFiles
+Rcpp::DataFrame writeTileCacheFiles(Rcpp::List tiles, Rcpp::CharacterVector files, double crownDiameter2TreeHeight, double minHeight, double quantization, int numThreads);
+RcppExport SEXP _meanshiftr_writeTileCacheFiles(SEXP tilesSEXP, SEXP filesSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP minHeightSEXP, SEXP quantizationSEXP, SEXP numThreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type tiles(tilesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type files(filesSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type minHeight(minHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type quantization(quantizationSEXP);
+    Rcpp::traits::input_parameter< int >::type numThreads(numThreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(writeTileCacheFiles(tiles, files, crownDiameter2TreeHeight, minHeight, quantization, numThreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readTileCacheFile
+Rcpp::DataFrame readTileCacheFile(std::string file);
+RcppExport SEXP _meanshiftr_readTileCacheFile(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(readTileCacheFile(file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// segmentTileCacheFiles
+Rcpp::DataFrame segmentTileCacheFiles(Rcpp::CharacterVector files, double crownDiameter2TreeHeight, double crownHeight2TreeHeight, int minNumNeighborsPerCore, double neighborhoodRadius, int maxNumCentroidsPerMode, int maxNumNeighbors, double minHeight, double bufferWidth, double seedBufferWidth, int numThreads, int seedChunkSize);
+RcppExport SEXP _meanshiftr_segmentTileCacheFiles(SEXP filesSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP crownHeight2TreeHeightSEXP, SEXP minNumNeighborsPerCoreSEXP, SEXP neighborhoodRadiusSEXP, SEXP maxNumCentroidsPerModeSEXP, SEXP maxNumNeighborsSEXP, SEXP minHeightSEXP, SEXP bufferWidthSEXP, SEXP seedBufferWidthSEXP, SEXP numThreadsSEXP, SEXP seedChunkSizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type files(filesSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type crownHeight2TreeHeight(crownHeight2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< int >::type minNumNeighborsPerCore(minNumNeighborsPerCoreSEXP);
+    Rcpp::traits::input_parameter< double >::type neighborhoodRadius(neighborhoodRadiusSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumCentroidsPerMode(maxNumCentroidsPerModeSEXP);
+    Rcpp::traits::input_parameter< int >::type maxNumNeighbors(maxNumNeighborsSEXP);
+    Rcpp::traits::input_parameter< double >::type minHeight(minHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type bufferWidth(bufferWidthSEXP);
+    Rcpp::traits::input_parameter< double >::type seedBufferWidth(seedBufferWidthSEXP);
+    Rcpp::traits::input_parameter< int >::type numThreads(numThreadsSEXP);
+    Rcpp::traits::input_parameter< int >::type seedChunkSize(seedChunkSizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(segmentTileCacheFiles(files, crownDiameter2TreeHeight, crownHeight2TreeHeight, minNumNeighborsPerCore, neighborhoodRadius, maxNumCentroidsPerMode, maxNumNeighbors, minHeight, bufferWidth, seedBufferWidth, numThreads, seedChunkSize));
+    return rcpp_result_gen;
+END_RCPP
+}
+// compareTileCacheLoad
+Rcpp::DataFrame compareTileCacheLoad(Rcpp::CharacterVector cacheFiles, Rcpp::CharacterVector csvFiles, double crownDiameter2TreeHeight, double minHeight);
+RcppExport SEXP _meanshiftr_compareTileCacheLoad(SEXP cacheFilesSEXP, SEXP csvFilesSEXP, SEXP crownDiameter2TreeHeightSEXP, SEXP minHeightSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type cacheFiles(cacheFilesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type csvFiles(csvFilesSEXP);
+    Rcpp::traits::input_parameter< double >::type crownDiameter2TreeHeight(crownDiameter2TreeHeightSEXP);
+    Rcpp::traits::input_parameter< double >::type minHeight(minHeightSEXP);
+    rcpp_result_gen = Rcpp::wrap(compareTileCacheLoad(cacheFiles, csvFiles, crownDiameter2TreeHeight, minHeight));
+    return rcpp_result_gen;
+END_RCPP
+}
+// openLasCrownWriter
+SEXP openLasCrownWriter(std::string sourceFile, std::string outputFile, bool withModes);
+RcppExport SEXP _meanshiftr_openLasCrownWriter(SEXP sourceFileSEXP, SEXP outputFileSEXP, SEXP withModesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type sourceFile(sourceFileSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputFile(outputFileSEXP);
+    Rcpp::traits::input_parameter< bool >::type withModes(withModesSEXP);
+    rcpp_result_gen = Rcpp::wrap(openLasCrownWriter(sourceFile, outputFile, withModes));
+    return rcpp_result_gen;
+END_RCPP
+}
+// writeLasCrowns
+void writeLasCrowns(SEXP writer, Rcpp::NumericVector pointIndices, Rcpp::IntegerVector crownIds, Rcpp::Nullable<Rcpp::NumericVector> modesX, Rcpp::Nullable<Rcpp::NumericVector> modesY, Rcpp::Nullable<Rcpp::NumericVector> modesZ);
+RcppExport SEXP _meanshiftr_writeLasCrowns(SEXP writerSEXP, SEXP pointIndicesSEXP, SEXP crownIdsSEXP, SEXP modesXSEXP, SEXP modesYSEXP, SEXP modesZSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type writer(writerSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type pointIndices(pointIndicesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type crownIds(crownIdsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type modesX(modesXSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type modesY(modesYSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type modesZ(modesZSEXP);
+    writeLasCrowns(writer, pointIndices, crownIds, modesX, modesY, modesZ);
+    return R_NilValue;
+END_RCPP
+}
+// closeLasCrownWriter
+void closeLasCrownWriter(SEXP writer);
+RcppExport SEXP _meanshiftr_closeLasCrownWriter(SEXP writerSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type writer(writerSEXP);
+    closeLasCrownWriter(writer);
+    return R_NilValue;
+END_RCPP
+}
+
+void registerMappedVectorClasses(DllInfo* dll);
+void registerBuilderVectorClass(DllInfo* dll);
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_meanshiftr_MeanShift_Voxels", (DL_FUNC) &_meanshiftr_MeanShift_Voxels, 8},
-    {"_meanshiftr_meanShiftClassic", (DL_FUNC) &_meanshiftr_meanShiftClassic, 4},
-    {"_meanshiftr_meanShiftClassicImproved", (DL_FUNC) &_meanshiftr_meanShiftClassicImproved, 4},
+    {"_meanshiftr_MeanShift_Voxels", (DL_FUNC) &_meanshiftr_MeanShift_Voxels, 11},
+    {"_meanshiftr_MeanShift_Voxels_Columns", (DL_FUNC) &_meanshiftr_MeanShift_Voxels_Columns, 14},
+    {"_meanshiftr_blurringMeanShift", (DL_FUNC) &_meanshiftr_blurringMeanShift, 8},
+    {"_meanshiftr_buildLasCatalog", (DL_FUNC) &_meanshiftr_buildLasCatalog, 4},
+    {"_meanshiftr_readLasCatalog", (DL_FUNC) &_meanshiftr_readLasCatalog, 1},
+    {"_meanshiftr_planLasCatalogTiles", (DL_FUNC) &_meanshiftr_planLasCatalogTiles, 2},
+    {"_meanshiftr_readLasCatalogTile", (DL_FUNC) &_meanshiftr_readLasCatalogTile, 6},
+    {"_meanshiftr_segmentLasCatalog", (DL_FUNC) &_meanshiftr_segmentLasCatalog, 19},
+    {"_meanshiftr_writeColumnFile", (DL_FUNC) &_meanshiftr_writeColumnFile, 2},
+    {"_meanshiftr_writeLasColumnFile", (DL_FUNC) &_meanshiftr_writeLasColumnFile, 4},
+    {"_meanshiftr_readColumnFile", (DL_FUNC) &_meanshiftr_readColumnFile, 1},
+    {"_meanshiftr_readColumnFileMatrix", (DL_FUNC) &_meanshiftr_readColumnFileMatrix, 2},
+    {"_meanshiftr_meanShiftClassic", (DL_FUNC) &_meanshiftr_meanShiftClassic, 8},
+    {"_meanshiftr_meanShiftClassicColumns", (DL_FUNC) &_meanshiftr_meanShiftClassicColumns, 10},
+    {"_meanshiftr_meanShiftClassicImproved", (DL_FUNC) &_meanshiftr_meanShiftClassicImproved, 9},
+    {"_meanshiftr_meanShiftClassicImprovedColumns", (DL_FUNC) &_meanshiftr_meanShiftClassicImprovedColumns, 11},
+    {"_meanshiftr_meanShiftClassicImprovedBuilder", (DL_FUNC) &_meanshiftr_meanShiftClassicImprovedBuilder, 9},
+    {"_meanshiftr_meanShiftFastGauss", (DL_FUNC) &_meanshiftr_meanShiftFastGauss, 9},
+    {"_meanshiftr_createPointCloudBuilder", (DL_FUNC) &_meanshiftr_createPointCloudBuilder, 3},
+    {"_meanshiftr_appendPointChunk", (DL_FUNC) &_meanshiftr_appendPointChunk, 6},
+    {"_meanshiftr_finalizePointCloudBuilder", (DL_FUNC) &_meanshiftr_finalizePointCloudBuilder, 2},
+    {"_meanshiftr_pointCloudBuilderColumns", (DL_FUNC) &_meanshiftr_pointCloudBuilderColumns, 1},
+    {"_meanshiftr_pointCloudBuilderMatrix", (DL_FUNC) &_meanshiftr_pointCloudBuilderMatrix, 1},
+    {"_meanshiftr_quickShift", (DL_FUNC) &_meanshiftr_quickShift, 7},
+    {"_meanshiftr_readLasPoints", (DL_FUNC) &_meanshiftr_readLasPoints, 6},
+    {"_meanshiftr_readLasPointsBuilder", (DL_FUNC) &_meanshiftr_readLasPointsBuilder, 7},
+    {"_meanshiftr_segmentTileFiles", (DL_FUNC) &_meanshiftr_segmentTileFiles, 15},
+    {"_meanshiftr_segmentTilesBatch", (DL_FUNC) &_meanshiftr_segmentTilesBatch, 13},
+    {"_meanshiftr_segmentTreeCrownsGlobal", (DL_FUNC) &_meanshiftr_segmentTreeCrownsGlobal, 8},
+    {"_meanshiftr_segmentTreeCrownsGlobalColumns", (DL_FUNC) &_meanshiftr_segmentTreeCrownsGlobalColumns, 10},
+    {"_meanshiftr_splitPointCloudBufferedIndices", (DL_FUNC) &_meanshiftr_splitPointCloudBufferedIndices, 6},
+    {"_meanshiftr_splitPointCloudQuadtreeIndices", (DL_FUNC) &_meanshiftr_splitPointCloudQuadtreeIndices, 7},
+    {"_meanshiftr_stitchTileCrowns", (DL_FUNC) &_meanshiftr_stitchTileCrowns, 9},
+    {"_meanshiftr_writeTileCacheFiles", (DL_FUNC) &_meanshiftr_writeTileCacheFiles, 6},
+    {"_meanshiftr_readTileCacheFile", (DL_FUNC) &_meanshiftr_readTileCacheFile, 1},
+    {"_meanshiftr_segmentTileCacheFiles", (DL_FUNC) &_meanshiftr_segmentTileCacheFiles, 12},
+    {"_meanshiftr_compareTileCacheLoad", (DL_FUNC) &_meanshiftr_compareTileCacheLoad, 4},
+    {"_meanshiftr_openLasCrownWriter", (DL_FUNC) &_meanshiftr_openLasCrownWriter, 3},
+    {"_meanshiftr_writeLasCrowns", (DL_FUNC) &_meanshiftr_writeLasCrowns, 6},
+    {"_meanshiftr_closeLasCrownWriter", (DL_FUNC) &_meanshiftr_closeLasCrownWriter, 1},
     {NULL, NULL, 0}
 };
 
 RcppExport void R_init_meanshiftr(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    registerMappedVectorClasses(dll);
+    registerBuilderVectorClass(dll);
 }
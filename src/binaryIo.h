@@ -0,0 +1,50 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <cstddef>
+#include <cstring>  // for std::memcpy
+#include <vector>
+
+
+// The binary files of the package are little-endian, like LAS files. All
+// platforms that R runs on are little-endian as well, so values are copied
+// byte by byte without swapping.
+
+/** Reads a value at \p offset bytes behind \p bytes. */
+template <typename T>
+T readValue(const unsigned char* bytes, const std::size_t offset) {
+  T value;
+  std::memcpy(&value, bytes + offset, sizeof(T));
+  return value;
+}
+
+/** Overwrites the value at \p offset in \p bytes. */
+template <typename T>
+void writeValue(
+    std::vector<unsigned char>& bytes, const std::size_t offset, const T value
+) {
+  std::memcpy(bytes.data() + offset, &value, sizeof(T));
+}
+
+/** Appends a value to \p bytes. */
+template <typename T>
+void appendValue(std::vector<unsigned char>& bytes, const T value) {
+  std::size_t offset{ bytes.size() };
+  bytes.resize(offset + sizeof(T));
+  std::memcpy(bytes.data() + offset, &value, sizeof(T));
+}
+
+/** Appends \p numValues values to \p bytes. */
+template <typename T>
+void appendValues(
+    std::vector<unsigned char>& bytes, const T* values, const std::size_t numValues
+) {
+  if (numValues == 0) {
+    return;
+  }
+  std::size_t offset{ bytes.size() };
+  bytes.resize(offset + numValues * sizeof(T));
+  std::memcpy(bytes.data() + offset, values, numValues * sizeof(T));
+}
+
+#endif  // define BINARY_IO_H
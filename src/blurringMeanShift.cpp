@@ -0,0 +1,268 @@
+#include "cylinderKernel.h"
+#include "heightBandedGridIndex.h"
+#include "modeTable.h"
+#include "parallelFor.h"
+#include "seedSet.h"
+
+#include <Rcpp.h>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace {
+
+/** Super-points that replace groups of coincident points. */
+struct ActivePoints {
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> z;
+  // Number of original points represented by each super-point
+  std::vector<double> masses;
+  std::vector<bool> converged;
+
+  int size() const { return static_cast<int>(x.size()); }
+
+  int add(const double pointX, const double pointY, const double pointZ,
+          const double mass, const bool isConverged) {
+    x.push_back(pointX);
+    y.push_back(pointY);
+    z.push_back(pointZ);
+    masses.push_back(mass);
+    converged.push_back(isConverged);
+    return size() - 1;
+  }
+};
+
+/** Merges converged points that lie within \p mergeTolerance of each other
+ *  into mass-weighted super-points.
+ *
+ *  Returns the merged points and stores the position of the super-point of
+ *  every input point in \p mergedIndices.
+ */
+ActivePoints mergeCoincidentPoints(
+    const ActivePoints& points, const double mergeTolerance,
+    std::vector<int>& mergedIndices
+) {
+  ActivePoints merged;
+  mergedIndices.assign(points.size(), -1);
+  std::unordered_map<std::int64_t, std::vector<int>> cells;
+  double squaredTolerance{ mergeTolerance * mergeTolerance };
+
+  for (int i{ 0 }; i < points.size(); i++) {
+    if (!points.converged[i]) {
+      mergedIndices[i] = merged.add(
+        points.x[i], points.y[i], points.z[i], points.masses[i], false
+      );
+      continue;
+    }
+
+    // Projected coordinates divided by a small tolerance easily exceed the
+    // range of int
+    std::int64_t cellX{
+      static_cast<std::int64_t>(std::floor(points.x[i] / mergeTolerance))
+    };
+    std::int64_t cellY{
+      static_cast<std::int64_t>(std::floor(points.y[i] / mergeTolerance))
+    };
+    std::int64_t cellZ{
+      static_cast<std::int64_t>(std::floor(points.z[i] / mergeTolerance))
+    };
+
+    // Look for an existing super-point in the surrounding cells
+    int target{ -1 };
+    for (int dx{ -1 }; dx <= 1 && target < 0; dx++) {
+      for (int dy{ -1 }; dy <= 1 && target < 0; dy++) {
+        for (int dz{ -1 }; dz <= 1 && target < 0; dz++) {
+          auto cell = cells.find(cellKey(cellX + dx, cellY + dy, cellZ + dz));
+          if (cell == cells.end()) {
+            continue;
+          }
+          for (int candidate : cell->second) {
+            double distX{ merged.x[candidate] - points.x[i] };
+            double distY{ merged.y[candidate] - points.y[i] };
+            double distZ{ merged.z[candidate] - points.z[i] };
+            if (distX * distX + distY * distY + distZ * distZ
+                <= squaredTolerance) {
+              target = candidate;
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    if (target < 0) {
+      target = merged.add(
+        points.x[i], points.y[i], points.z[i], points.masses[i], true
+      );
+      cells[cellKey(cellX, cellY, cellZ)].push_back(target);
+    } else {
+      // Move the super-point to the weighted mean of its members
+      double mass{ merged.masses[target] + points.masses[i] };
+      merged.x[target] += (points.x[i] - merged.x[target]) * points.masses[i] / mass;
+      merged.y[target] += (points.y[i] - merged.y[target]) * points.masses[i] / mass;
+      merged.z[target] += (points.z[i] - merged.z[target]) * points.masses[i] / mass;
+      merged.masses[target] = mass;
+    }
+    mergedIndices[i] = target;
+  }
+
+  return merged;
+}
+
+}  // namespace
+
+
+//' Blurring mean shift clustering
+//'
+//' Adaptive mean shift clustering to delineate tree crowns from lidar point
+//' clouds, in which the point cloud itself moves. In every round, all points
+//' move to the centroid of their kernel at the same time, using the cylinder
+//' kernel of \code{meanShiftClassicImproved}. Converged points that coincide
+//' are merged into weighted super-points, so the number of active points
+//' shrinks quickly from round to round.
+//'
+//' @param pointCloud Point cloud data in a three-column matrix where the
+//'   columns represent X, Y and Z coordinates and each row represents one
+//'   point.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param maxNumRounds Integer scalar. Maximum number of rounds in which all
+//'   points move. After the last round, the current positions of the points
+//'   are treated as their modes.
+//' @param mergeTolerance Numeric scalar. Converged points that are at most
+//'   this far apart are merged.
+//' @param numThreads Integer scalar. Number of threads that move the points
+//'   of a round in parallel. Non-positive values use all available cores.
+//' @param output Character scalar. "full" returns the coordinates of the
+//'   points and their modes, "modes" only the columns modeX, modeY and modeZ,
+//'   and "indexed" only the integer column modeIndex, which points into the
+//'   table of unique modes in the attribute "modes". The unique modes merge
+//'   the modes within \code{mergeTolerance} of each other.
+//' @param outputFile Character scalar. If not empty, the result is stored in
+//'   a column file at this path, which is created or overwritten, and its
+//'   columns are returned as mapped vectors like those of
+//'   \code{readColumnFile}.
+//'
+//' @return A data.frame with the coordinates in \code{pointCloud} and three
+//'   additional columns with the coordinates of the calculated modes, or one
+//'   of the lean forms selected by \code{output}. The
+//'   attribute \code{numActivePointsPerRound} holds the number of active
+//'   points at the start of each round.
+//'
+//' @details A point has converged when it moved less than 0.01 in a round.
+//'   The algorithm stops when all points have converged.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame blurringMeanShift(
+    Rcpp::NumericMatrix pointCloud,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int maxNumRounds = 100, double mergeTolerance = 0.01, int numThreads = 0,
+    std::string output = "full", std::string outputFile = ""
+){
+  if (mergeTolerance <= 0.0) {
+    Rcpp::stop("mergeTolerance must be positive.");
+  }
+  ModesOptions options{
+    selectModesOptions(output, mergeTolerance, outputFile)
+  };
+
+  int nrows{ pointCloud.nrow() };
+
+  // Every point starts as its own active point
+  ActivePoints points;
+  for (int i{ 0 }; i < nrows; i++) {
+    points.add(pointCloud(i, 0), pointCloud(i, 1), pointCloud(i, 2), 1.0, false);
+  }
+  // Position of each original point's super-point among the active points
+  std::vector<int> activeIndices(nrows);
+  for (int i{ 0 }; i < nrows; i++) {
+    activeIndices[i] = i;
+  }
+
+  Rcpp::IntegerVector numActivePointsPerRound;
+  std::vector<int> mergedIndices;
+
+  for (int round{ 0 }; round < maxNumRounds; round++) {
+    numActivePointsPerRound.push_back(points.size());
+
+    // Index the current positions of the active points
+    HeightBandedGridIndex index{
+      points.x.data(), points.y.data(), points.z.data(), points.size(),
+      crownDiameter2TreeHeight
+    };
+
+    // Move all points to the mass-weighted centroid of their kernel
+    ActivePoints moved{ points };
+    parallelFor(0, points.size(), numThreads, [&](int i) {
+      double sumX{ 0 };
+      double sumY{ 0 };
+      double sumZ{ 0 };
+      double sumWeights{ 0 };
+      forEachWeightedNeighbor(
+        index, points.x[i], points.y[i], points.z[i],
+        crownDiameter2TreeHeight, crownHeight2TreeHeight,
+        [&](double neighborX, double neighborY, double neighborZ, int j,
+            double weight) {
+          double massWeight{ weight * points.masses[j] };
+          sumX += massWeight * neighborX;
+          sumY += massWeight * neighborY;
+          sumZ += massWeight * neighborZ;
+          sumWeights += massWeight;
+        }
+      );
+      // Points without valid kernel weights, e.g. on the ground, stay where
+      // they are
+      if (sumWeights > 0.0) {
+        moved.x[i] = sumX / sumWeights;
+        moved.y[i] = sumY / sumWeights;
+        moved.z[i] = sumZ / sumWeights;
+      }
+    });
+
+    // Converged points moved less than the distance that ends the mean shift
+    // iterations of the other engines
+    bool allConverged{ true };
+    for (int i{ 0 }; i < points.size(); i++) {
+      moved.converged[i] = std::sqrt(
+          std::pow(moved.x[i] - points.x[i], 2.0)
+        + std::pow(moved.y[i] - points.y[i], 2.0)
+        + std::pow(moved.z[i] - points.z[i], 2.0)
+      ) <= 0.01;
+      allConverged = allConverged && moved.converged[i];
+    }
+
+    // Shrink the active set by merging coincident converged points
+    points = mergeCoincidentPoints(moved, mergeTolerance, mergedIndices);
+    for (int& activeIndex : activeIndices) {
+      activeIndex = mergedIndices[activeIndex];
+    }
+
+    if (allConverged) {
+      break;
+    }
+    Rcpp::checkUserInterrupt();
+  }
+
+  ModeVectors modes{ nrows, options };
+  for (int i{ 0 }; i < nrows; i++) {
+    modes.modesX[i] = points.x[activeIndices[i]];
+    modes.modesY[i] = points.y[activeIndices[i]];
+    modes.modesZ[i] = points.z[activeIndices[i]];
+  }
+
+  // Return the result as a data.frame with XYZ-coordinates of all points and
+  // their corresponding modes, or in the requested lean form
+  Rcpp::DataFrame result{
+    modes.createDataFrame(pointCloud, selectSeedRows(R_NilValue, nrows))
+  };
+  result.attr("numActivePointsPerRound") = numActivePointsPerRound;
+  return result;
+}
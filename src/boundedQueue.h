@@ -0,0 +1,61 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+
+/** A first-in first-out queue with a fixed capacity that connects the stages
+ *  of a pipeline.
+ *
+ *  push blocks while the queue is full, so a fast stage waits for the stage
+ *  after it instead of piling up items. pop blocks while the queue is empty
+ *  and returns false once the queue is closed and empty.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+
+  explicit BoundedQueue(const std::size_t capacity)
+    : capacity(capacity > 0 ? capacity : 1), isClosed(false) {}
+
+  void push(T item) {
+    std::unique_lock<std::mutex> lock{ mutex };
+    isNotFull.wait(lock, [this]() { return items.size() < capacity; });
+    items.push_back(std::move(item));
+    isNotEmpty.notify_one();
+  }
+
+  bool pop(T& item) {
+    std::unique_lock<std::mutex> lock{ mutex };
+    isNotEmpty.wait(lock, [this]() { return !items.empty() || isClosed; });
+    if (items.empty()) {
+      return false;
+    }
+    item = std::move(items.front());
+    items.pop_front();
+    isNotFull.notify_one();
+    return true;
+  }
+
+  /** Tells the consumers that no more items will come. */
+  void close() {
+    std::lock_guard<std::mutex> lock{ mutex };
+    isClosed = true;
+    isNotEmpty.notify_all();
+  }
+
+private:
+
+  std::size_t capacity;
+  bool isClosed;
+  std::deque<T> items;
+  std::mutex mutex;
+  std::condition_variable isNotFull;
+  std::condition_variable isNotEmpty;
+};
+
+#endif  // define BOUNDED_QUEUE_H
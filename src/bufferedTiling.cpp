@@ -0,0 +1,514 @@
+#include "bufferedTiling.h"
+
+#include <algorithm>  // for std::lower_bound, std::partition, std::sort, std::stable_sort, std::unique
+#include <cmath>      // for std::floor, std::isfinite
+#include <vector>
+
+
+namespace {
+
+// Returns the position of the tile with the given key or -1 if there are no
+// points in it
+int findTile(const std::vector<long long>& tileKeys, const long long key) {
+  auto position = std::lower_bound(tileKeys.begin(), tileKeys.end(), key);
+  if (position == tileKeys.end() || *position != key) {
+    return -1;
+  }
+  return static_cast<int>(position - tileKeys.begin());
+}
+
+
+/** A square of a quadtree. The points in it are the range [first, last) of
+ *  the point order of the quadtree.
+ */
+struct QuadtreeNode {
+  double lowerLeftX;
+  double lowerLeftY;
+  double width;
+  int first;
+  int last;
+  // Position of the first of the four children in the nodes, or -1 for
+  // leaves
+  int firstChild;
+};
+
+
+// Divides the node and its descendants until they hold few enough points
+void subdivide(
+    std::vector<QuadtreeNode>& nodes, const int node,
+    std::vector<int>& pointOrder,
+    const double* pointsX, const double* pointsY,
+    const int maxNumPointsPerTile, const double minCoreWidth
+) {
+  QuadtreeNode parent{ nodes[node] };
+  double halfWidth{ parent.width * 0.5 };
+  if (parent.last - parent.first <= maxNumPointsPerTile
+      || halfWidth < minCoreWidth) {
+    return;
+  }
+
+  // Partition the points into the lower and the upper half and each half
+  // into its left and its right part
+  double middleX{ parent.lowerLeftX + halfWidth };
+  double middleY{ parent.lowerLeftY + halfWidth };
+  auto begin = pointOrder.begin();
+  auto upper = std::partition(
+    begin + parent.first, begin + parent.last,
+    [pointsY, middleY](const int i) { return pointsY[i] < middleY; }
+  );
+  auto isLeft = [pointsX, middleX](const int i) {
+    return pointsX[i] < middleX;
+  };
+  auto lowerRight = std::partition(begin + parent.first, upper, isLeft);
+  auto upperRight = std::partition(upper, begin + parent.last, isLeft);
+  int bounds[5]{
+    parent.first, static_cast<int>(lowerRight - begin),
+    static_cast<int>(upper - begin), static_cast<int>(upperRight - begin),
+    parent.last
+  };
+
+  int firstChild{ static_cast<int>(nodes.size()) };
+  nodes[node].firstChild = firstChild;
+  for (int child{ 0 }; child < 4; child++) {
+    QuadtreeNode childNode;
+    childNode.lowerLeftX = parent.lowerLeftX + (child % 2) * halfWidth;
+    childNode.lowerLeftY = parent.lowerLeftY + (child / 2) * halfWidth;
+    childNode.width = halfWidth;
+    childNode.first = bounds[child];
+    childNode.last = bounds[child + 1];
+    childNode.firstChild = -1;
+    nodes.push_back(childNode);
+  }
+  for (int child{ 0 }; child < 4; child++) {
+    subdivide(
+      nodes, firstChild + child, pointOrder, pointsX, pointsY,
+      maxNumPointsPerTile, minCoreWidth
+    );
+  }
+}
+
+
+// Collects the leaves with points in depth-first order
+void collectLeaves(
+    const std::vector<QuadtreeNode>& nodes, const int node,
+    std::vector<int>& leaves
+) {
+  if (nodes[node].firstChild < 0) {
+    if (nodes[node].last > nodes[node].first) {
+      leaves.push_back(node);
+    }
+    return;
+  }
+  for (int child{ 0 }; child < 4; child++) {
+    collectLeaves(nodes, nodes[node].firstChild + child, leaves);
+  }
+}
+
+
+// Appends the points of the other leaves that lie at most width away from
+// the core area of the leaf in X and in Y. Only the nodes that overlap the
+// buffered extent are visited.
+void collectBufferPoints(
+    const std::vector<QuadtreeNode>& nodes, const int leaf,
+    const std::vector<int>& pointOrder,
+    const double* pointsX, const double* pointsY, const double width,
+    std::vector<int>& nodeStack, std::vector<int>& bufferPoints
+) {
+  const QuadtreeNode& core{ nodes[leaf] };
+  double bufferMinX{ core.lowerLeftX - width };
+  double bufferMaxX{ core.lowerLeftX + core.width + width };
+  double bufferMinY{ core.lowerLeftY - width };
+  double bufferMaxY{ core.lowerLeftY + core.width + width };
+  nodeStack.assign(1, 0);
+  while (!nodeStack.empty()) {
+    int node{ nodeStack.back() };
+    nodeStack.pop_back();
+    const QuadtreeNode& square{ nodes[node] };
+    if (node == leaf
+        || square.lowerLeftX > bufferMaxX
+        || square.lowerLeftX + square.width < bufferMinX
+        || square.lowerLeftY > bufferMaxY
+        || square.lowerLeftY + square.width < bufferMinY) {
+      continue;
+    }
+    if (square.firstChild >= 0) {
+      for (int child{ 0 }; child < 4; child++) {
+        nodeStack.push_back(square.firstChild + child);
+      }
+      continue;
+    }
+    for (int k{ square.first }; k < square.last; k++) {
+      int i{ pointOrder[k] };
+      if (bufferMinX <= pointsX[i] && pointsX[i] <= bufferMaxX
+          && bufferMinY <= pointsY[i] && pointsY[i] <= bufferMaxY) {
+        bufferPoints.push_back(i);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+
+BufferedTiling splitIntoBufferedTiles(
+    const double* pointsX, const double* pointsY, const int numPoints,
+    const double coreWidth, const double bufferWidth,
+    const double* pointsZ, const double crownDiameter2TreeHeight
+) {
+  BufferedTiling tiling;
+  tiling.tileStarts.push_back(0);
+
+  // Get the extent of all points with finite coordinates
+  double minX{ 0.0 };
+  double minY{ 0.0 };
+  double maxX{ 0.0 };
+  bool isEmpty{ true };
+  for (int i{ 0 }; i < numPoints; i++) {
+    if (!std::isfinite(pointsX[i]) || !std::isfinite(pointsY[i])) {
+      continue;
+    }
+    if (isEmpty) {
+      minX = maxX = pointsX[i];
+      minY = pointsY[i];
+      isEmpty = false;
+    }
+    minX = std::min(minX, pointsX[i]);
+    maxX = std::max(maxX, pointsX[i]);
+    minY = std::min(minY, pointsY[i]);
+  }
+  if (isEmpty || !(coreWidth > 0.0)) {
+    return tiling;
+  }
+
+  // The grid starts at the minimum rounded down to a multiple of the core
+  // width, like in calculate_plot_index
+  double gridMinX{ std::floor(minX / coreWidth) * coreWidth };
+  double gridMinY{ std::floor(minY / coreWidth) * coreWidth };
+  long long numColumns{
+    static_cast<long long>(std::floor((maxX - gridMinX) / coreWidth)) + 1
+  };
+
+  // Calculate the column and the row of every point's tile. The key of a tile
+  // is its plot index minus one.
+  std::vector<long long> pointTileKeys(numPoints, -1);
+  for (int i{ 0 }; i < numPoints; i++) {
+    if (!std::isfinite(pointsX[i]) || !std::isfinite(pointsY[i])) {
+      continue;
+    }
+    long long column{
+      static_cast<long long>(std::floor((pointsX[i] - gridMinX) / coreWidth))
+    };
+    long long row{
+      static_cast<long long>(std::floor((pointsY[i] - gridMinY) / coreWidth))
+    };
+    pointTileKeys[i] = column + numColumns * row;
+  }
+
+  // Collect the tiles that contain points
+  std::vector<long long> tileKeys;
+  tileKeys.reserve(numPoints);
+  for (long long key : pointTileKeys) {
+    if (key >= 0) {
+      tileKeys.push_back(key);
+    }
+  }
+  std::sort(tileKeys.begin(), tileKeys.end());
+  tileKeys.erase(std::unique(tileKeys.begin(), tileKeys.end()), tileKeys.end());
+  tileKeys.shrink_to_fit();
+  int numTiles{ static_cast<int>(tileKeys.size()) };
+
+  tiling.tileIds.resize(numTiles);
+  tiling.tileLowerLeftX.resize(numTiles);
+  tiling.tileLowerLeftY.resize(numTiles);
+  for (int tile{ 0 }; tile < numTiles; tile++) {
+    tiling.tileIds[tile] = static_cast<double>(tileKeys[tile] + 1);
+    tiling.tileLowerLeftX[tile] =
+      gridMinX + (tileKeys[tile] % numColumns) * coreWidth;
+    tiling.tileLowerLeftY[tile] =
+      gridMinY + (tileKeys[tile] / numColumns) * coreWidth;
+  }
+  tiling.tileCoreWidths.assign(numTiles, coreWidth);
+
+  // Find the tile of every point
+  std::vector<int> pointTiles(numPoints, -1);
+  std::vector<int> numCorePoints(numTiles, 0);
+  for (int i{ 0 }; i < numPoints; i++) {
+    if (pointTileKeys[i] >= 0) {
+      pointTiles[i] = findTile(tileKeys, pointTileKeys[i]);
+      numCorePoints[pointTiles[i]] += 1;
+    }
+  }
+  std::vector<long long>().swap(pointTileKeys);
+
+  // Look up the eight neighbors of every tile once. Neighbors without points
+  // are -1.
+  const int NUM_NEIGHBORS{ 8 };
+  const int NEIGHBOR_OFFSETS_X[NUM_NEIGHBORS]{ -1, 0, 1, -1, 1, -1, 0, 1 };
+  const int NEIGHBOR_OFFSETS_Y[NUM_NEIGHBORS]{ -1, -1, -1, 0, 0, 1, 1, 1 };
+  std::vector<int> neighborsOfTiles(numTiles * NUM_NEIGHBORS, -1);
+  for (int tile{ 0 }; tile < numTiles; tile++) {
+    long long column{ tileKeys[tile] % numColumns };
+    long long row{ tileKeys[tile] / numColumns };
+    for (int neighbor{ 0 }; neighbor < NUM_NEIGHBORS; neighbor++) {
+      long long neighborColumn{ column + NEIGHBOR_OFFSETS_X[neighbor] };
+      long long neighborRow{ row + NEIGHBOR_OFFSETS_Y[neighbor] };
+      if (neighborColumn >= 0 && neighborColumn < numColumns
+          && neighborRow >= 0) {
+        neighborsOfTiles[tile * NUM_NEIGHBORS + neighbor] =
+          findTile(tileKeys, neighborColumn + numColumns * neighborRow);
+      }
+    }
+  }
+
+  // Checks whether a coordinate lies in the buffer of the neighbor in the
+  // direction offset along one axis. A point can lie in the buffers of both
+  // neighbors if the buffers are wider than half the core.
+  auto isInBuffer = [coreWidth](
+    const double coordinate, const double lowerLeft, const int offset,
+    const double neighborBufferWidth
+  ) {
+    if (offset < 0) {
+      return coordinate > lowerLeft
+        && coordinate <= lowerLeft + neighborBufferWidth;
+    }
+    if (offset > 0) {
+      return coordinate >= lowerLeft + coreWidth - neighborBufferWidth;
+    }
+    return true;
+  };
+
+  // Finds the neighbor tiles in whose buffer point i lies, given the buffer
+  // widths of all tiles
+  std::vector<int> neighborTiles;
+  auto findNeighborTiles = [&](const int i,
+                               const std::vector<double>& bufferWidths) {
+    neighborTiles.clear();
+    int tile{ pointTiles[i] };
+    for (int neighbor{ 0 }; neighbor < NUM_NEIGHBORS; neighbor++) {
+      int neighborTile{ neighborsOfTiles[tile * NUM_NEIGHBORS + neighbor] };
+      if (neighborTile < 0) {
+        continue;
+      }
+      double neighborBufferWidth{ bufferWidths[neighborTile] };
+      if (isInBuffer(pointsX[i], tiling.tileLowerLeftX[tile],
+                     NEIGHBOR_OFFSETS_X[neighbor], neighborBufferWidth)
+          && isInBuffer(pointsY[i], tiling.tileLowerLeftY[tile],
+                        NEIGHBOR_OFFSETS_Y[neighbor], neighborBufferWidth)) {
+        neighborTiles.push_back(neighborTile);
+      }
+    }
+  };
+
+  // Derive the buffer width of every tile. The seeds of the core area can
+  // move up to bufferWidth into the buffer, so the kernels reach at most the
+  // largest crown radius of the core and of a buffer of full width.
+  tiling.tileBufferWidths.assign(numTiles, bufferWidth);
+  if (pointsZ != nullptr && crownDiameter2TreeHeight > 0.0) {
+    std::vector<double> maxZ(numTiles, 0.0);
+    for (int i{ 0 }; i < numPoints; i++) {
+      if (pointTiles[i] < 0 || !std::isfinite(pointsZ[i])) {
+        continue;
+      }
+      maxZ[pointTiles[i]] = std::max(maxZ[pointTiles[i]], pointsZ[i]);
+      findNeighborTiles(i, tiling.tileBufferWidths);
+      for (int neighborTile : neighborTiles) {
+        maxZ[neighborTile] = std::max(maxZ[neighborTile], pointsZ[i]);
+      }
+    }
+    for (int tile{ 0 }; tile < numTiles; tile++) {
+      tiling.tileBufferWidths[tile] = std::min(
+        bufferWidth, crownDiameter2TreeHeight * maxZ[tile] * 0.5
+      );
+    }
+  }
+
+  // Count the buffer points of every tile
+  std::vector<int> numBufferPoints(numTiles, 0);
+  for (int i{ 0 }; i < numPoints; i++) {
+    if (pointTiles[i] < 0) {
+      continue;
+    }
+    findNeighborTiles(i, tiling.tileBufferWidths);
+    for (int neighborTile : neighborTiles) {
+      numBufferPoints[neighborTile] += 1;
+    }
+  }
+
+  // Lay out the tiles one after another with the core points first
+  tiling.tileStarts.resize(numTiles + 1);
+  std::vector<int> nextCoreSlot(numTiles);
+  std::vector<int> nextBufferSlot(numTiles);
+  for (int tile{ 0 }; tile < numTiles; tile++) {
+    nextCoreSlot[tile] = tiling.tileStarts[tile];
+    nextBufferSlot[tile] = tiling.tileStarts[tile] + numCorePoints[tile];
+    tiling.tileStarts[tile + 1] =
+      nextBufferSlot[tile] + numBufferPoints[tile];
+  }
+
+  // Place the point indices
+  tiling.pointIndices.resize(tiling.tileStarts.back());
+  for (int i{ 0 }; i < numPoints; i++) {
+    if (pointTiles[i] < 0) {
+      continue;
+    }
+    tiling.pointIndices[nextCoreSlot[pointTiles[i]]++] = i;
+    findNeighborTiles(i, tiling.tileBufferWidths);
+    for (int neighborTile : neighborTiles) {
+      tiling.pointIndices[nextBufferSlot[neighborTile]++] = i;
+    }
+  }
+
+  // Sort the core and the buffer points of every tile by their coordinates.
+  // The sort is stable so that duplicate points keep their input order.
+  auto isBefore = [pointsX, pointsY](const int a, const int b) {
+    return pointsX[a] < pointsX[b]
+      || (pointsX[a] == pointsX[b] && pointsY[a] < pointsY[b]);
+  };
+  auto first = tiling.pointIndices.begin();
+  for (int tile{ 0 }; tile < numTiles; tile++) {
+    int bufferStart{ tiling.tileStarts[tile] + numCorePoints[tile] };
+    std::stable_sort(
+      first + tiling.tileStarts[tile], first + bufferStart, isBefore
+    );
+    std::stable_sort(
+      first + bufferStart, first + tiling.tileStarts[tile + 1], isBefore
+    );
+  }
+
+  tiling.numCorePoints = numCorePoints;
+
+  return tiling;
+}
+
+
+BufferedTiling splitIntoQuadtreeTiles(
+    const double* pointsX, const double* pointsY, const int numPoints,
+    const int maxNumPointsPerTile, const double minCoreWidth,
+    const double bufferWidth,
+    const double* pointsZ, const double crownDiameter2TreeHeight
+) {
+  BufferedTiling tiling;
+  tiling.tileStarts.push_back(0);
+
+  // Get the points with finite coordinates and their extent
+  std::vector<int> pointOrder;
+  double minX{ 0.0 };
+  double minY{ 0.0 };
+  double maxX{ 0.0 };
+  double maxY{ 0.0 };
+  for (int i{ 0 }; i < numPoints; i++) {
+    if (!std::isfinite(pointsX[i]) || !std::isfinite(pointsY[i])) {
+      continue;
+    }
+    if (pointOrder.empty()) {
+      minX = maxX = pointsX[i];
+      minY = maxY = pointsY[i];
+    }
+    minX = std::min(minX, pointsX[i]);
+    maxX = std::max(maxX, pointsX[i]);
+    minY = std::min(minY, pointsY[i]);
+    maxY = std::max(maxY, pointsY[i]);
+    pointOrder.push_back(i);
+  }
+  if (pointOrder.empty() || !(minCoreWidth > 0.0)) {
+    return tiling;
+  }
+
+  // Find the root square, which covers all points with its half-open extent
+  QuadtreeNode root;
+  root.lowerLeftX = std::floor(minX / minCoreWidth) * minCoreWidth;
+  root.lowerLeftY = std::floor(minY / minCoreWidth) * minCoreWidth;
+  root.width = minCoreWidth;
+  while (root.lowerLeftX + root.width <= maxX
+         || root.lowerLeftY + root.width <= maxY) {
+    root.width *= 2.0;
+  }
+  root.first = 0;
+  root.last = static_cast<int>(pointOrder.size());
+  root.firstChild = -1;
+
+  std::vector<QuadtreeNode> nodes{ root };
+  subdivide(
+    nodes, 0, pointOrder, pointsX, pointsY,
+    std::max(maxNumPointsPerTile, 1), minCoreWidth
+  );
+  std::vector<int> leaves;
+  collectLeaves(nodes, 0, leaves);
+  int numTiles{ static_cast<int>(leaves.size()) };
+
+  // The partitions of the quadtree do not keep the input order, so
+  // duplicate points are ordered by their input positions explicitly
+  auto isBefore = [pointsX, pointsY](const int a, const int b) {
+    return pointsX[a] < pointsX[b]
+      || (pointsX[a] == pointsX[b]
+          && (pointsY[a] < pointsY[b] || (pointsY[a] == pointsY[b] && a < b)));
+  };
+
+  std::vector<int> nodeStack;
+  std::vector<int> haloPoints;
+  for (int tile{ 0 }; tile < numTiles; tile++) {
+    const QuadtreeNode& leaf{ nodes[leaves[tile]] };
+    tiling.tileIds.push_back(tile + 1);
+    tiling.tileLowerLeftX.push_back(leaf.lowerLeftX);
+    tiling.tileLowerLeftY.push_back(leaf.lowerLeftY);
+    tiling.tileCoreWidths.push_back(leaf.width);
+
+    // Collect the points within a buffer of full width
+    haloPoints.clear();
+    collectBufferPoints(
+      nodes, leaves[tile], pointOrder, pointsX, pointsY, bufferWidth,
+      nodeStack, haloPoints
+    );
+
+    // Derive the buffer width of the tile. The seeds of the core area can
+    // move up to bufferWidth into the buffer, so the kernels reach at most
+    // the largest crown radius of the core and of the buffer of full width.
+    double tileBufferWidth{ bufferWidth };
+    if (pointsZ != nullptr && crownDiameter2TreeHeight > 0.0) {
+      double maxZ{ 0.0 };
+      for (int k{ leaf.first }; k < leaf.last; k++) {
+        if (std::isfinite(pointsZ[pointOrder[k]])) {
+          maxZ = std::max(maxZ, pointsZ[pointOrder[k]]);
+        }
+      }
+      for (int i : haloPoints) {
+        if (std::isfinite(pointsZ[i])) {
+          maxZ = std::max(maxZ, pointsZ[i]);
+        }
+      }
+      tileBufferWidth = std::min(
+        bufferWidth, crownDiameter2TreeHeight * maxZ * 0.5
+      );
+    }
+    tiling.tileBufferWidths.push_back(tileBufferWidth);
+
+    // Add the core points
+    std::size_t coreStart{ tiling.pointIndices.size() };
+    tiling.pointIndices.insert(
+      tiling.pointIndices.end(),
+      pointOrder.begin() + leaf.first, pointOrder.begin() + leaf.last
+    );
+    tiling.numCorePoints.push_back(leaf.last - leaf.first);
+
+    // Add the points of the full buffer that lie within the tile's buffer
+    double bufferMinX{ leaf.lowerLeftX - tileBufferWidth };
+    double bufferMaxX{ leaf.lowerLeftX + leaf.width + tileBufferWidth };
+    double bufferMinY{ leaf.lowerLeftY - tileBufferWidth };
+    double bufferMaxY{ leaf.lowerLeftY + leaf.width + tileBufferWidth };
+    std::size_t bufferStart{ tiling.pointIndices.size() };
+    for (int i : haloPoints) {
+      if (bufferMinX <= pointsX[i] && pointsX[i] <= bufferMaxX
+          && bufferMinY <= pointsY[i] && pointsY[i] <= bufferMaxY) {
+        tiling.pointIndices.push_back(i);
+      }
+    }
+
+    // Sort the core and the buffer points like splitIntoBufferedTiles does
+    auto first = tiling.pointIndices.begin();
+    std::sort(first + coreStart, first + bufferStart, isBefore);
+    std::sort(first + bufferStart, tiling.pointIndices.end(), isBefore);
+    tiling.tileStarts.push_back(static_cast<int>(tiling.pointIndices.size()));
+  }
+
+  return tiling;
+}
@@ -0,0 +1,92 @@
+#ifndef BUFFERED_TILING_H
+#define BUFFERED_TILING_H
+
+#include <vector>
+
+
+/** A split of a point cloud into square tiles with buffer zones.
+ *
+ *  The tiles either form a regular grid or the leaves of a quadtree. Only
+ *  tiles that contain at least one point are part of the tiling. Every tile
+ *  holds the points of its core area, followed by the points of the
+ *  neighboring tiles that lie within the buffer width of its core area.
+ *  Points are referenced by their position in the input arrays, so the
+ *  tiling never copies any coordinates.
+ */
+struct BufferedTiling {
+  // Plot index of each tile, numbered like calculate_plot_index for grids
+  // and consecutively for quadtrees
+  std::vector<double> tileIds;
+  // Lower left corner and side length of the core area of each tile
+  std::vector<double> tileLowerLeftX;
+  std::vector<double> tileLowerLeftY;
+  std::vector<double> tileCoreWidths;
+  // Offsets of the first point of each tile in pointIndices. Has one more
+  // element than there are tiles.
+  std::vector<int> tileStarts;
+  // Width of the buffer of each tile
+  std::vector<double> tileBufferWidths;
+  // Number of core points of each tile. They precede the buffer points.
+  std::vector<int> numCorePoints;
+  // Input positions of the points of all tiles. The core and the buffer
+  // points of each tile are each sorted by X and then by Y.
+  std::vector<int> pointIndices;
+
+  int numTiles() const { return static_cast<int>(tileIds.size()); }
+};
+
+
+/** Splits \p numPoints points into tiles of side length \p coreWidth with
+ *  buffers of width \p bufferWidth.
+ *
+ *  The tiles form a regular grid whose lower left corner is the minimum of
+ *  the point coordinates rounded down to a multiple of the core width.
+ *
+ *  If \p pointsZ is given and \p crownDiameter2TreeHeight is positive, the
+ *  buffer of every tile is only as wide as the largest kernel radius of its
+ *  core points and of the points that lie within \p bufferWidth of its core
+ *  area, crownDiameter2TreeHeight * maxZ / 2, since the kernels of the seeds
+ *  move into the buffer. \p bufferWidth is the upper limit of all buffer
+ *  widths.
+ *
+ *  A point belongs to the buffer of a neighboring tile if it is closer than
+ *  \p bufferWidth to that tile's core area. The boundaries follow the former
+ *  R implementation of split_point_cloud_buffered: a point that lies exactly
+ *  on the lower or left edge of its own tile is not added to the tiles below
+ *  or to the left of it. Points with non-finite coordinates are left out.
+ *  The split needs three passes over the points, one more with \p pointsZ,
+ *  plus one sort per tile.
+ */
+BufferedTiling splitIntoBufferedTiles(
+  const double* pointsX, const double* pointsY, const int numPoints,
+  const double coreWidth, const double bufferWidth,
+  const double* pointsZ = nullptr, const double crownDiameter2TreeHeight = 0.0
+);
+
+
+/** Splits \p numPoints points into the leaves of a quadtree with buffers of
+ *  width \p bufferWidth, so that dense areas get small tiles and sparse
+ *  areas get large ones.
+ *
+ *  The root of the quadtree is the smallest square whose lower left corner
+ *  is the minimum of the point coordinates rounded down to a multiple of
+ *  \p minCoreWidth and whose side length is \p minCoreWidth times a power of
+ *  two. Squares with more than \p maxNumPointsPerTile points are divided into
+ *  four, unless that would make them smaller than \p minCoreWidth. The tiles
+ *  are numbered in the order of a depth-first traversal.
+ *
+ *  A point belongs to the buffer of a tile if it lies outside the tile's
+ *  core area and at most the tile's buffer width away from it in X and in
+ *  Y. Since the buffers are derived from the geometry of every tile, tiles
+ *  of different sizes get the points of all their neighbors, however many
+ *  there are. \p pointsZ and \p crownDiameter2TreeHeight adapt the buffer
+ *  widths like in splitIntoBufferedTiles.
+ */
+BufferedTiling splitIntoQuadtreeTiles(
+  const double* pointsX, const double* pointsY, const int numPoints,
+  const int maxNumPointsPerTile, const double minCoreWidth,
+  const double bufferWidth,
+  const double* pointsZ = nullptr, const double crownDiameter2TreeHeight = 0.0
+);
+
+#endif  // define BUFFERED_TILING_H
@@ -0,0 +1,216 @@
+#include "columnFile.h"
+
+#include "binaryIo.h"
+
+#include <cstring>    // for std::memcpy, std::memset
+#include <fstream>
+#include <iterator>   // for std::istreambuf_iterator
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+const char MAGIC[4]{ 'M', 'S', 'C', 'F' };
+const std::uint32_t VERSION{ 1 };
+const std::size_t HEADER_SIZE{ 24 };
+const std::size_t MAX_NAME_LENGTH{ 32 };
+const std::size_t COLUMN_HEADER_SIZE{ MAX_NAME_LENGTH + 16 };
+const std::uint32_t MAX_NUM_COLUMNS{ 1 << 16 };
+
+std::size_t valueSize(const ColumnType type) {
+  return type == ColumnType::real ? sizeof(double) : sizeof(std::int32_t);
+}
+
+std::uint64_t alignTo8(const std::uint64_t offset) {
+  return (offset + 7) / 8 * 8;
+}
+
+}  // namespace
+
+
+ColumnFile::ColumnFile(const std::string& path)
+  : filePath(path), rowCount(0), bytes(nullptr), numBytes(0), isMapped(false),
+    isCreated(false) {
+  map();
+
+  auto fail = [&path]() {
+    throw std::runtime_error(path + " is not a column file.");
+  };
+  if (numBytes < HEADER_SIZE || std::memcmp(bytes, MAGIC, 4) != 0) {
+    fail();
+  }
+  if (readValue<std::uint32_t>(bytes, 4) != VERSION) {
+    throw std::runtime_error(
+      path + " was written by a newer version of meanshiftr."
+    );
+  }
+  rowCount = readValue<std::uint64_t>(bytes, 8);
+  std::uint32_t numColumns{ readValue<std::uint32_t>(bytes, 16) };
+  if (numColumns > MAX_NUM_COLUMNS
+      || (numBytes - HEADER_SIZE) / COLUMN_HEADER_SIZE < numColumns) {
+    fail();
+  }
+
+  for (std::uint32_t column{ 0 }; column < numColumns; column++) {
+    std::size_t offset{ HEADER_SIZE + column * COLUMN_HEADER_SIZE };
+    const char* name{ reinterpret_cast<const char*>(bytes + offset) };
+    ColumnInfo info;
+    std::size_t nameLength{ 0 };
+    while (nameLength < MAX_NAME_LENGTH && name[nameLength] != '\0') {
+      nameLength++;
+    }
+    info.name.assign(name, nameLength);
+    std::uint32_t type{ readValue<std::uint32_t>(bytes, offset + MAX_NAME_LENGTH) };
+    if (type > static_cast<std::uint32_t>(ColumnType::integer)) {
+      fail();
+    }
+    info.type = static_cast<ColumnType>(type);
+    info.offset = readValue<std::uint64_t>(bytes, offset + MAX_NAME_LENGTH + 8);
+
+    // The values must lie within the file
+    if (info.offset % 8 != 0 || info.offset > numBytes
+        || (numBytes - info.offset) / valueSize(info.type) < rowCount) {
+      fail();
+    }
+    columnInfos.push_back(info);
+  }
+}
+
+
+ColumnFile::ColumnFile(
+    const std::string& path, const std::vector<std::string>& names,
+    const std::vector<ColumnType>& types, const std::uint64_t numRows
+) : filePath(path), rowCount(numRows), bytes(nullptr), numBytes(0),
+    isMapped(false), isCreated(true) {
+  if (names.size() != types.size() || names.size() > MAX_NUM_COLUMNS) {
+    throw std::runtime_error("Every column needs a name and a type.");
+  }
+
+  std::uint64_t offset{ alignTo8(HEADER_SIZE + names.size() * COLUMN_HEADER_SIZE) };
+  for (std::size_t column{ 0 }; column < names.size(); column++) {
+    if (names[column].empty() || names[column].size() > MAX_NAME_LENGTH) {
+      throw std::runtime_error(
+        "Column names must have between 1 and 32 characters."
+      );
+    }
+    columnInfos.push_back(ColumnInfo{ names[column], types[column], offset });
+    offset = alignTo8(offset + numRows * valueSize(types[column]));
+  }
+  numBytes = static_cast<std::size_t>(offset);
+  map();
+
+  std::memcpy(bytes, MAGIC, 4);
+  std::uint32_t numColumns{ static_cast<std::uint32_t>(names.size()) };
+  std::memcpy(bytes + 4, &VERSION, sizeof(VERSION));
+  std::memcpy(bytes + 8, &rowCount, sizeof(rowCount));
+  std::memcpy(bytes + 16, &numColumns, sizeof(numColumns));
+  std::memset(bytes + 20, 0, 4);
+  for (std::size_t column{ 0 }; column < columnInfos.size(); column++) {
+    unsigned char* header{ bytes + HEADER_SIZE + column * COLUMN_HEADER_SIZE };
+    const ColumnInfo& info{ columnInfos[column] };
+    std::uint32_t type{ static_cast<std::uint32_t>(info.type) };
+    std::memset(header, 0, COLUMN_HEADER_SIZE);
+    std::memcpy(header, info.name.data(), info.name.size());
+    std::memcpy(header + MAX_NAME_LENGTH, &type, sizeof(type));
+    std::memcpy(header + MAX_NAME_LENGTH + 8, &info.offset, sizeof(info.offset));
+  }
+}
+
+
+void ColumnFile::map() {
+#ifndef _WIN32
+  int descriptor{ isCreated
+    ? open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+    : open(filePath.c_str(), O_RDONLY) };
+  if (descriptor < 0) {
+    throw std::runtime_error("Cannot open the file " + filePath + ".");
+  }
+  if (isCreated) {
+    if (ftruncate(descriptor, static_cast<off_t>(numBytes)) != 0) {
+      close(descriptor);
+      throw std::runtime_error("Cannot resize the file " + filePath + ".");
+    }
+  } else {
+    struct stat status;
+    if (fstat(descriptor, &status) != 0) {
+      close(descriptor);
+      throw std::runtime_error("Cannot open the file " + filePath + ".");
+    }
+    numBytes = static_cast<std::size_t>(status.st_size);
+  }
+  if (numBytes > 0) {
+    // Opened files are mapped privately, so writes to them stay in memory
+    void* mapping{ mmap(
+      nullptr, numBytes, PROT_READ | PROT_WRITE,
+      isCreated ? MAP_SHARED : MAP_PRIVATE, descriptor, 0
+    ) };
+    if (mapping == MAP_FAILED) {
+      close(descriptor);
+      throw std::runtime_error("Cannot map the file " + filePath + ".");
+    }
+    bytes = static_cast<unsigned char*>(mapping);
+    isMapped = true;
+  }
+  close(descriptor);
+#else
+  if (isCreated) {
+    buffer.assign(numBytes, 0);
+  } else {
+    std::ifstream stream{ filePath, std::ios::binary };
+    if (!stream) {
+      throw std::runtime_error("Cannot open the file " + filePath + ".");
+    }
+    buffer.assign(
+      std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()
+    );
+    numBytes = buffer.size();
+  }
+  bytes = buffer.data();
+#endif
+}
+
+
+ColumnFile::~ColumnFile() {
+  try {
+    flush();
+  } catch (const std::exception&) {
+    // Destructors must not throw, and flush() already wrote what it could
+  }
+#ifndef _WIN32
+  if (isMapped) {
+    munmap(bytes, numBytes);
+  }
+#endif
+}
+
+
+int ColumnFile::findColumn(const std::string& name) const {
+  for (std::size_t column{ 0 }; column < columnInfos.size(); column++) {
+    if (columnInfos[column].name == name) {
+      return static_cast<int>(column);
+    }
+  }
+  return -1;
+}
+
+
+void ColumnFile::flush() {
+  if (!isCreated || isMapped) {
+    return;
+  }
+  std::ofstream stream{ filePath, std::ios::binary | std::ios::trunc };
+  stream.write(
+    reinterpret_cast<const char*>(buffer.data()),
+    static_cast<std::streamsize>(buffer.size())
+  );
+  if (!stream) {
+    throw std::runtime_error("Cannot write the file " + filePath + ".");
+  }
+}
@@ -0,0 +1,89 @@
+#ifndef COLUMN_FILE_H
+#define COLUMN_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/** The types of the columns of a column file. */
+enum class ColumnType : std::uint32_t {
+  real = 0,
+  integer = 1
+};
+
+
+/** A column of a column file. */
+struct ColumnInfo {
+  std::string name;
+  ColumnType type;
+  // Position of the first value in the file
+  std::uint64_t offset;
+};
+
+
+/** A binary file of equally long columns of doubles or 32-bit integers,
+ *  which is memory-mapped so that its columns can be read and written in
+ *  place, and the operating system pages them in and out as needed.
+ *
+ *  The file starts with the magic "MSCF", the version, the number of rows and
+ *  the number of columns, followed by the name, type and offset of every
+ *  column. The values of the columns follow one column after the other,
+ *  each one starting at a multiple of 8 bytes. Consecutive columns of doubles
+ *  are therefore contiguous, like the columns of a matrix.
+ *
+ *  Opened files are mapped copy-on-write, so writing to their columns never
+ *  changes the file. Created files are mapped shared, so the values written
+ *  to their columns end up in the file. Where memory mapping is unavailable,
+ *  the file is held in memory and created files are written by flush() and
+ *  on destruction.
+ */
+class ColumnFile {
+public:
+
+  /** Opens an existing column file. */
+  explicit ColumnFile(const std::string& path);
+
+  /** Creates a column file with \p numRows rows and uninitialized values. */
+  ColumnFile(
+    const std::string& path, const std::vector<std::string>& names,
+    const std::vector<ColumnType>& types, const std::uint64_t numRows
+  );
+
+  ~ColumnFile();
+
+  ColumnFile(const ColumnFile&) = delete;
+  ColumnFile& operator=(const ColumnFile&) = delete;
+
+  const std::string& path() const { return filePath; }
+  std::uint64_t numRows() const { return rowCount; }
+  const std::vector<ColumnInfo>& columns() const { return columnInfos; }
+
+  /** The position of the column called \p name, or -1. */
+  int findColumn(const std::string& name) const;
+
+  /** The first value of a column. */
+  unsigned char* columnData(const int column) const {
+    return bytes + columnInfos[column].offset;
+  }
+
+  /** Writes the values of a created file to disk if it is not mapped. */
+  void flush();
+
+private:
+
+  /** Maps the file, or reads it into memory, and sets bytes and numBytes. */
+  void map();
+
+  std::string filePath;
+  std::uint64_t rowCount;
+  std::vector<ColumnInfo> columnInfos;
+  unsigned char* bytes;
+  std::size_t numBytes;
+  bool isMapped;
+  bool isCreated;
+  std::vector<unsigned char> buffer;
+};
+
+#endif  // define COLUMN_FILE_H
@@ -0,0 +1,175 @@
+#include "crownStitching.h"
+
+#include <algorithm>  // for std::sort
+#include <cmath>      // for std::sqrt
+#include <map>
+#include <numeric>    // for std::iota
+#include <utility>    // for std::make_pair, std::pair
+#include <vector>
+
+
+namespace {
+
+/** Disjoint sets with path halving and union by size. */
+class UnionFind {
+public:
+
+  explicit UnionFind(const int numElements)
+    : parents(numElements), sizes(numElements, 1) {
+    std::iota(parents.begin(), parents.end(), 0);
+  }
+
+  int find(int element) {
+    while (parents[element] != element) {
+      parents[element] = parents[parents[element]];
+      element = parents[element];
+    }
+    return element;
+  }
+
+  void unite(const int a, const int b) {
+    int rootA{ find(a) };
+    int rootB{ find(b) };
+    if (rootA == rootB) {
+      return;
+    }
+    if (sizes[rootA] < sizes[rootB]) {
+      std::swap(rootA, rootB);
+    }
+    parents[rootB] = rootA;
+    sizes[rootA] += sizes[rootB];
+  }
+
+private:
+  std::vector<int> parents;
+  std::vector<int> sizes;
+};
+
+}  // namespace
+
+
+std::vector<int> stitchCrowns(
+    const TileCrowns& tileCrowns,
+    const double modeTolerance, const int minNumSharedPoints
+) {
+  int numRows{ static_cast<int>(tileCrowns.tiles.size()) };
+
+  // Number the crowns of all tiles consecutively and get the mean position
+  // of the modes of each crown
+  std::map<std::pair<int, int>, int> crownsOfTiles;
+  std::vector<int> rowCrowns(numRows, -1);
+  std::vector<double> sumsX;
+  std::vector<double> sumsY;
+  std::vector<double> sumsZ;
+  std::vector<int> counts;
+  for (int row{ 0 }; row < numRows; row++) {
+    if (tileCrowns.crownIds[row] == 0) {
+      continue;
+    }
+    auto inserted = crownsOfTiles.insert(std::make_pair(
+      std::make_pair(tileCrowns.tiles[row], tileCrowns.crownIds[row]),
+      static_cast<int>(counts.size())
+    ));
+    if (inserted.second) {
+      sumsX.push_back(0.0);
+      sumsY.push_back(0.0);
+      sumsZ.push_back(0.0);
+      counts.push_back(0);
+    }
+    int crown{ inserted.first->second };
+    rowCrowns[row] = crown;
+    sumsX[crown] += tileCrowns.modesX[row];
+    sumsY[crown] += tileCrowns.modesY[row];
+    sumsZ[crown] += tileCrowns.modesZ[row];
+    counts[crown] += 1;
+  }
+  int numCrowns{ static_cast<int>(counts.size()) };
+
+  // Group the rows by point to find the crowns that share points
+  std::vector<int> rowsByPoint(numRows);
+  std::iota(rowsByPoint.begin(), rowsByPoint.end(), 0);
+  std::sort(
+    rowsByPoint.begin(), rowsByPoint.end(),
+    [&tileCrowns](const int a, const int b) {
+      return tileCrowns.pointIds[a] < tileCrowns.pointIds[b]
+        || (tileCrowns.pointIds[a] == tileCrowns.pointIds[b] && a < b);
+    }
+  );
+
+  std::map<std::pair<int, int>, int> numSharedPoints;
+  for (int first{ 0 }; first < numRows; ) {
+    int last{ first };
+    while (last < numRows
+           && tileCrowns.pointIds[rowsByPoint[last]]
+              == tileCrowns.pointIds[rowsByPoint[first]]) {
+      last++;
+    }
+    for (int a{ first }; a < last; a++) {
+      for (int b{ a + 1 }; b < last; b++) {
+        int crownA{ rowCrowns[rowsByPoint[a]] };
+        int crownB{ rowCrowns[rowsByPoint[b]] };
+        if (crownA >= 0 && crownB >= 0 && crownA != crownB) {
+          numSharedPoints[std::make_pair(
+            std::min(crownA, crownB), std::max(crownA, crownB)
+          )] += 1;
+        }
+      }
+    }
+    first = last;
+  }
+
+  // Merge crowns that share enough points and whose modes are close
+  UnionFind crowns{ numCrowns };
+  for (const auto& shared : numSharedPoints) {
+    if (shared.second < minNumSharedPoints) {
+      continue;
+    }
+    int a{ shared.first.first };
+    int b{ shared.first.second };
+    double dx{ sumsX[a] / counts[a] - sumsX[b] / counts[b] };
+    double dy{ sumsY[a] / counts[a] - sumsY[b] / counts[b] };
+    double dz{ sumsZ[a] / counts[a] - sumsZ[b] / counts[b] };
+    if (std::sqrt(dx * dx + dy * dy + dz * dz) <= modeTolerance) {
+      crowns.unite(a, b);
+    }
+  }
+
+  // Number the merged crowns in the order of the rows
+  std::vector<int> globalIdsOfRoots(numCrowns, 0);
+  int numGlobalIds{ 0 };
+  std::vector<int> globalIds(numRows, 0);
+  for (int row{ 0 }; row < numRows; row++) {
+    if (rowCrowns[row] < 0) {
+      continue;
+    }
+    int root{ crowns.find(rowCrowns[row]) };
+    if (globalIdsOfRoots[root] == 0) {
+      globalIdsOfRoots[root] = ++numGlobalIds;
+    }
+    globalIds[row] = globalIdsOfRoots[root];
+  }
+
+  // Give core rows without a crown the crown of a buffer row of their point
+  for (int first{ 0 }; first < numRows; ) {
+    int last{ first };
+    int bufferGlobalId{ 0 };
+    while (last < numRows
+           && tileCrowns.pointIds[rowsByPoint[last]]
+              == tileCrowns.pointIds[rowsByPoint[first]]) {
+      int row{ rowsByPoint[last] };
+      if (bufferGlobalId == 0 && tileCrowns.isBuffer[row]) {
+        bufferGlobalId = globalIds[row];
+      }
+      last++;
+    }
+    for (int k{ first }; k < last; k++) {
+      int row{ rowsByPoint[k] };
+      if (!tileCrowns.isBuffer[row] && globalIds[row] == 0) {
+        globalIds[row] = bufferGlobalId;
+      }
+    }
+    first = last;
+  }
+
+  return globalIds;
+}
@@ -0,0 +1,40 @@
+#ifndef CROWN_STITCHING_H
+#define CROWN_STITCHING_H
+
+#include <vector>
+
+
+/** The crowns that were found in each tile of a buffered tiling, with one
+ *  row per point and tile. A point that lies in the buffers of other tiles
+ *  has one row in each of them.
+ */
+struct TileCrowns {
+  std::vector<int> tiles;
+  // Identifies the same point in different tiles
+  std::vector<int> pointIds;
+  // Crown within the tile, 0 for points that are not part of a crown
+  std::vector<int> crownIds;
+  std::vector<bool> isBuffer;
+  std::vector<double> modesX;
+  std::vector<double> modesY;
+  std::vector<double> modesZ;
+};
+
+
+/** Merges the crowns of neighboring tiles into global crowns and returns the
+ *  global crown ID of every row.
+ *
+ *  Two crowns of different tiles are merged if they share at least
+ *  \p minNumSharedPoints points and the mean positions of their modes are at
+ *  most \p modeTolerance apart. The merges are transitive, so a crown that
+ *  spans several tiles gets one ID. Global IDs are numbered from 1 in the
+ *  order of the rows. A core row without a crown gets the crown of the first
+ *  buffer row of the same point that has one, so that the work done in the
+ *  buffers is not lost.
+ */
+std::vector<int> stitchCrowns(
+  const TileCrowns& tileCrowns,
+  const double modeTolerance, const int minNumSharedPoints = 1
+);
+
+#endif  // define CROWN_STITCHING_H
@@ -0,0 +1,153 @@
+#ifndef CYLINDER_KERNEL_H
+#define CYLINDER_KERNEL_H
+
+#include "heightBandedGridIndex.h"
+#include "littleFunctionsImproved.h"
+
+#include <cmath>
+
+
+/** Calls \p visit(neighborX, neighborY, neighborZ, neighborIndex, weight)
+ *  for every indexed point within the cylinder kernel of
+ *  meanShiftClassicImproved that belongs to the centroid (\p centroidX,
+ *  \p centroidY, \p centroidZ).
+ *
+ *  The weight is the product of the vertical epanechnikov weight and the
+ *  horizontal gaussian weight of the point. If \p maxNumNeighbors is
+ *  positive, the candidates from the index are subsampled such that about
+ *  that many of them lie within the radius of the cylinder. Returns whether
+ *  the candidates were subsampled.
+ */
+template <typename Index, typename Visitor>
+bool forEachWeightedNeighbor(
+    const BasicHeightBandedGridIndex<Index>& index,
+    const double centroidX, const double centroidY, const double centroidZ,
+    const double crownDiameter2TreeHeight, const double crownHeight2TreeHeight,
+    Visitor visit, const int maxNumNeighbors = 0
+) {
+  // Calculate cylinder dimensions based on point height
+  double cylinderRadius = crownDiameter2TreeHeight * centroidZ * 0.5;
+  double cylinderHeight = crownHeight2TreeHeight * centroidZ * 0.75;
+  double cylinderMiddleZ = centroidZ + cylinderHeight * 1.0/6.0;
+
+  // Calculate the vertical extent of the cylinder in the same way as
+  // intersectsCylinder does
+  double cylinderTopZ{ cylinderMiddleZ + (0.5 * cylinderHeight) };
+  double cylinderBottomZ{ cylinderTopZ - cylinderHeight };
+
+  // Loop through the indexed candidates to identify the neighbors
+  return index.forEachCandidate(
+    centroidX, centroidY, centroidZ,
+    cylinderRadius, cylinderBottomZ, cylinderTopZ,
+    [&](double neighborX, double neighborY, double neighborZ, Index neighborIndex) {
+      if (
+        intersectsCylinder(
+          neighborX, neighborY, neighborZ,
+          cylinderRadius, cylinderHeight,
+          centroidX, centroidY, cylinderMiddleZ
+        )
+      ) {
+        // Weight the neighbor depending on its relative position within the
+        // cylinder
+        double verticalweight{ calculateVerticalWeight(
+          neighborZ, cylinderMiddleZ, cylinderHeight
+        ) };
+        double horizontalweight{ calculateHorizontalWeight(
+            neighborX, neighborY, cylinderRadius, centroidX, centroidY
+        ) };
+        visit(
+          neighborX, neighborY, neighborZ, neighborIndex,
+          verticalweight * horizontalweight
+        );
+      }
+    },
+    maxNumNeighbors
+  );
+}
+
+
+/** The end point of the trajectory of one seed. */
+struct Mode {
+  double x;
+  double y;
+  double z;
+  int numIterations;
+  // Number of iterations whose neighbors were subsampled
+  int numCappedIterations;
+};
+
+
+/** Moves the cylinder kernel of meanShiftClassicImproved from the seed
+ *  (\p seedX, \p seedY, \p seedZ) to the centroid of its neighbors until it
+ *  moves less than 0.01 or \p maxNumCentroidsPerMode centroids have been
+ *  calculated.
+ *
+ *  \p maxNumNeighbors is passed on to forEachWeightedNeighbor. The function
+ *  does not call the R API, so trajectories can run on several threads.
+ */
+template <typename Index>
+Mode findMode(
+    const BasicHeightBandedGridIndex<Index>& index,
+    const double seedX, const double seedY, const double seedZ,
+    const double crownDiameter2TreeHeight, const double crownHeight2TreeHeight,
+    const int maxNumCentroidsPerMode, const int maxNumNeighbors = 0
+) {
+  Mode mode{ seedX, seedY, seedZ, 0, 0 };
+
+  // Declare variables for storing the centroid of the previous iteration
+  double oldX;
+  double oldY;
+  double oldZ;
+
+  do {
+    // Increase the iteration counter
+    mode.numIterations += 1;
+
+    // Initialize helper variables for the calculation of kernel centroids
+    double sumX{ 0 };
+    double sumY{ 0 };
+    double sumZ{ 0 };
+    double sumWeights{ 0 };
+
+    // Remember the centroid of the previous iteration.
+    oldX = mode.x;
+    oldY = mode.y;
+    oldZ = mode.z;
+
+    // Calculate the centroid by multiplying all coodinates by their
+    // weights, depending on their relative position within the cylinder,
+    // summing up the products and dividing by the sum of all weights
+    bool isCapped{ forEachWeightedNeighbor(
+      index, mode.x, mode.y, mode.z,
+      crownDiameter2TreeHeight, crownHeight2TreeHeight,
+      [&](double neighborX, double neighborY, double neighborZ, Index,
+          double weight) {
+        sumX += weight * neighborX;
+        sumY += weight * neighborY;
+        sumZ += weight * neighborZ;
+        sumWeights += weight;
+      },
+      maxNumNeighbors
+    ) };
+    mode.numCappedIterations += isCapped;
+
+    mode.x = sumX / sumWeights;
+    mode.y = sumY / sumWeights;
+    mode.z = sumZ / sumWeights;
+
+    // If the new position is very close to the previous position (kernel
+    // stopped moving), or if the maximum number of iterations is reached, stop
+    // the iterations.
+  } while (
+    std::sqrt(
+        std::pow(mode.x - oldX, 2.0)
+      + std::pow(mode.y - oldY, 2.0)
+      + std::pow(mode.z - oldZ, 2.0)
+    ) > 0.01
+    && mode.numIterations < maxNumCentroidsPerMode
+  );
+
+  return mode;
+}
+
+#endif  // define CYLINDER_KERNEL_H
@@ -0,0 +1,326 @@
+#include "heightBandedGridIndex.h"
+
+#include "binaryIo.h"
+
+#include <algorithm>  // for std::sort, std::stable_sort, std::max, std::min
+#include <cmath>      // for std::ceil, std::floor, std::log2, std::pow, std::sqrt
+#include <cstdint>
+#include <cstring>    // for std::memcpy
+#include <numeric>    // for std::iota
+#include <utility>    // for std::pair
+#include <vector>
+
+
+namespace {
+
+// Upper limit for the number of height bands. With a ratio of two between the
+// upper boundaries of neighboring bands twelve bands cover three orders of
+// magnitude of kernel sizes.
+const int MAX_NUM_HEIGHT_BANDS{ 12 };
+
+// Upper boundary of the lowest height band when the number of bands is chosen
+// automatically.
+const double LOWEST_BAND_TOP_Z{ 2.0 };
+
+int cellCoordinate(const double coordinate, const double min, const double cellSize) {
+  return static_cast<int>(std::floor((coordinate - min) / cellSize));
+}
+
+}  // namespace
+
+
+template <typename Index>
+BasicHeightBandedGridIndex<Index>::BasicHeightBandedGridIndex(
+    const double* pointsX, const double* pointsY, const double* pointsZ,
+    const Index numPoints,
+    const double crownDiameter2TreeHeight,
+    const int numHeightBands
+) : crownDiameter2TreeHeight{ crownDiameter2TreeHeight },
+    hasAutomaticHeightBands{ numHeightBands <= 0 },
+    minX{ 0.0 }, minY{ 0.0 } {
+  if (numPoints <= 0) {
+    return;
+  }
+
+  // Get the extent of the point cloud
+  minX = *std::min_element(pointsX, pointsX + numPoints);
+  minY = *std::min_element(pointsY, pointsY + numPoints);
+  double maxX{ *std::max_element(pointsX, pointsX + numPoints) };
+  double maxY{ *std::max_element(pointsY, pointsY + numPoints) };
+  double maxZ{ *std::max_element(pointsZ, pointsZ + numPoints) };
+
+  // The cells must not become so small that there are many more cells than
+  // points, so the cell size is at least the side length of a square that
+  // holds one point on average.
+  double area{ (maxX - minX) * (maxY - minY) };
+  double minCellSize{ area > 0.0 ? std::sqrt(area / numPoints) : 1.0 };
+  minCellSize = std::max(minCellSize, 1e-6 * std::max(maxX - minX, maxY - minY));
+
+  // Choose the number of height bands
+  int numBands{ numHeightBands };
+  if (numBands <= 0) {
+    numBands = maxZ > LOWEST_BAND_TOP_Z
+      ? 1 + static_cast<int>(std::ceil(std::log2(maxZ / LOWEST_BAND_TOP_Z)))
+      : 1;
+  }
+  numBands = std::min(numBands, MAX_NUM_HEIGHT_BANDS);
+
+  // Derive the upper boundaries and cell sizes of the bands
+  heightBands.resize(numBands);
+  for (int band{ 0 }; band < numBands; band++) {
+    HeightBand& heightBand{ heightBands[band] };
+    heightBand.topZ = maxZ / std::pow(2.0, numBands - 1 - band);
+
+    double largestRadius{ crownDiameter2TreeHeight * heightBand.topZ * 0.5 };
+    heightBand.cellSize = std::isfinite(largestRadius)
+      ? std::max(largestRadius, minCellSize)
+      : minCellSize;
+    heightBand.numCellsX =
+      cellCoordinate(maxX, minX, heightBand.cellSize) + 1;
+    heightBand.numCellsY =
+      cellCoordinate(maxY, minY, heightBand.cellSize) + 1;
+  }
+  // Kernels above the highest point still use the coarsest grid
+  heightBands.back().topZ = std::max(heightBands.back().topZ, maxZ);
+
+  // Sort the points by cell of the finest grid and by height within cells
+  const HeightBand& finestBand{ heightBands.front() };
+  std::vector<std::pair<int, double>> sortKeys(numPoints);
+  for (Index i{ 0 }; i < numPoints; i++) {
+    sortKeys[i] = std::make_pair(
+      cellCoordinate(pointsX[i], minX, finestBand.cellSize)
+        + cellCoordinate(pointsY[i], minY, finestBand.cellSize)
+          * finestBand.numCellsX,
+      pointsZ[i]
+    );
+  }
+  originalIndices.resize(numPoints);
+  std::iota(originalIndices.begin(), originalIndices.end(), 0);
+  std::sort(
+    originalIndices.begin(), originalIndices.end(),
+    [&sortKeys](const Index a, const Index b) { return sortKeys[a] < sortKeys[b]; }
+  );
+
+  sortedX.resize(numPoints);
+  sortedY.resize(numPoints);
+  sortedZ.resize(numPoints);
+  for (Index position{ 0 }; position < numPoints; position++) {
+    Index i{ originalIndices[position] };
+    sortedX[position] = pointsX[i];
+    sortedY[position] = pointsY[i];
+    sortedZ[position] = pointsZ[i];
+  }
+
+  // Sorting all positions by height once and distributing them to the cells
+  // of each grid with a stable counting sort keeps them sorted by height
+  // within every cell.
+  std::vector<Index> positionsByHeight(numPoints);
+  std::iota(positionsByHeight.begin(), positionsByHeight.end(), 0);
+  std::stable_sort(
+    positionsByHeight.begin(), positionsByHeight.end(),
+    [this](const Index a, const Index b) { return sortedZ[a] < sortedZ[b]; }
+  );
+
+  std::vector<int> cellOfPosition(numPoints);
+  for (HeightBand& heightBand : heightBands) {
+    int numCells{ heightBand.numCellsX * heightBand.numCellsY };
+    heightBand.cellStarts.assign(numCells + 1, 0);
+
+    // Count the points per cell...
+    for (Index position{ 0 }; position < numPoints; position++) {
+      cellOfPosition[position] =
+        cellCoordinate(sortedX[position], minX, heightBand.cellSize)
+        + cellCoordinate(sortedY[position], minY, heightBand.cellSize)
+          * heightBand.numCellsX;
+      heightBand.cellStarts[cellOfPosition[position] + 1] += 1;
+    }
+    // ...turn the counts into offsets...
+    for (int cell{ 0 }; cell < numCells; cell++) {
+      heightBand.cellStarts[cell + 1] += heightBand.cellStarts[cell];
+    }
+    // ...and place the positions in order of increasing height.
+    std::vector<Index> nextSlot(
+      heightBand.cellStarts.begin(), heightBand.cellStarts.end() - 1
+    );
+    heightBand.pointPositions.resize(numPoints);
+    for (Index position : positionsByHeight) {
+      heightBand.pointPositions[nextSlot[cellOfPosition[position]]++] =
+        position;
+    }
+  }
+}
+
+
+template <typename Index>
+const typename BasicHeightBandedGridIndex<Index>::HeightBand&
+BasicHeightBandedGridIndex<Index>::selectHeightBand(const double centroidZ) const {
+  for (const HeightBand& heightBand : heightBands) {
+    if (centroidZ <= heightBand.topZ) {
+      return heightBand;
+    }
+  }
+  return heightBands.back();
+}
+
+
+// The serialized index consists of the number of points, the
+// crownDiameter2TreeHeight, the origin of the grids, the number of height
+// bands, the height bands with their cell offsets and point positions, and
+// finally the original indices of the sorted points. All integers are int32.
+// Indices with a fixed number of height bands are written with -1 bands and
+// are never restored, since isSerializedFor only accepts automatic bands.
+
+template <typename Index>
+BasicHeightBandedGridIndex<Index>::BasicHeightBandedGridIndex(
+    const double* pointsX, const double* pointsY, const double* pointsZ,
+    const Index numPoints, const unsigned char* serializedIndex
+) : hasAutomaticHeightBands{ true } {
+  static_assert(
+    sizeof(Index) == sizeof(std::int32_t), "Only 32-bit indices are serialized."
+  );
+  const unsigned char* bytes{ serializedIndex };
+  std::size_t offset{ 4 };
+  crownDiameter2TreeHeight = readValue<double>(bytes, offset);
+  minX = readValue<double>(bytes, offset + 8);
+  minY = readValue<double>(bytes, offset + 16);
+  int numBands{ readValue<std::int32_t>(bytes, offset + 24) };
+  offset += 28;
+
+  heightBands.resize(numBands);
+  for (HeightBand& heightBand : heightBands) {
+    heightBand.topZ = readValue<double>(bytes, offset);
+    heightBand.cellSize = readValue<double>(bytes, offset + 8);
+    heightBand.numCellsX = readValue<std::int32_t>(bytes, offset + 16);
+    heightBand.numCellsY = readValue<std::int32_t>(bytes, offset + 20);
+    offset += 24;
+
+    int numCells{ heightBand.numCellsX * heightBand.numCellsY };
+    heightBand.cellStarts.resize(numCells + 1);
+    std::memcpy(heightBand.cellStarts.data(), bytes + offset,
+                (numCells + 1) * sizeof(std::int32_t));
+    offset += (numCells + 1) * sizeof(std::int32_t);
+    heightBand.pointPositions.resize(numPoints);
+    std::memcpy(heightBand.pointPositions.data(), bytes + offset,
+                numPoints * sizeof(std::int32_t));
+    offset += numPoints * sizeof(std::int32_t);
+  }
+
+  originalIndices.resize(numPoints);
+  std::memcpy(originalIndices.data(), bytes + offset,
+              numPoints * sizeof(std::int32_t));
+
+  sortedX.resize(numPoints);
+  sortedY.resize(numPoints);
+  sortedZ.resize(numPoints);
+  for (Index position{ 0 }; position < numPoints; position++) {
+    Index i{ originalIndices[position] };
+    sortedX[position] = pointsX[i];
+    sortedY[position] = pointsY[i];
+    sortedZ[position] = pointsZ[i];
+  }
+}
+
+
+template <typename Index>
+void BasicHeightBandedGridIndex<Index>::serialize(
+    std::vector<unsigned char>& bytes
+) const {
+  static_assert(
+    sizeof(Index) == sizeof(std::int32_t), "Only 32-bit indices are serialized."
+  );
+  appendValue<std::int32_t>(bytes, numPoints());
+  appendValue<double>(bytes, crownDiameter2TreeHeight);
+  appendValue<double>(bytes, minX);
+  appendValue<double>(bytes, minY);
+  appendValue<std::int32_t>(bytes, hasAutomaticHeightBands ? numHeightBands() : -1);
+  for (const HeightBand& heightBand : heightBands) {
+    appendValue<double>(bytes, heightBand.topZ);
+    appendValue<double>(bytes, heightBand.cellSize);
+    appendValue<std::int32_t>(bytes, heightBand.numCellsX);
+    appendValue<std::int32_t>(bytes, heightBand.numCellsY);
+    appendValues(bytes, heightBand.cellStarts.data(), heightBand.cellStarts.size());
+    appendValues(bytes, heightBand.pointPositions.data(),
+                 heightBand.pointPositions.size());
+  }
+  appendValues(bytes, originalIndices.data(), originalIndices.size());
+}
+
+
+template <typename Index>
+bool BasicHeightBandedGridIndex<Index>::isSerializedFor(
+    const unsigned char* bytes, const std::size_t numBytes,
+    const int numPoints, const double crownDiameter2TreeHeight
+) {
+  if (numBytes < 32
+      || readValue<std::int32_t>(bytes, 0) != numPoints
+      || readValue<double>(bytes, 4) != crownDiameter2TreeHeight) {
+    return false;
+  }
+  int numBands{ readValue<std::int32_t>(bytes, 28) };
+  if (numBands < 0 || numBands > MAX_NUM_HEIGHT_BANDS
+      || (numBands == 0) != (numPoints == 0)) {
+    return false;
+  }
+
+  // Check the sizes and ranges of all arrays, so that restoring the index
+  // can neither read past the bytes nor produce invalid positions
+  std::size_t n{ static_cast<std::size_t>(numPoints) };
+  std::size_t offset{ 32 };
+  for (int band{ 0 }; band < numBands; band++) {
+    if (offset + 24 > numBytes) {
+      return false;
+    }
+    std::int32_t numCellsX{ readValue<std::int32_t>(bytes, offset + 16) };
+    std::int32_t numCellsY{ readValue<std::int32_t>(bytes, offset + 20) };
+    offset += 24;
+    if (numCellsX <= 0 || numCellsY <= 0
+        || static_cast<double>(numCellsX) * numCellsY > (numBytes - offset) / 4.0) {
+      return false;
+    }
+    std::size_t numCells{ static_cast<std::size_t>(numCellsX) * numCellsY };
+    if (offset + (numCells + 1 + n) * 4 > numBytes) {
+      return false;
+    }
+    std::int32_t previousStart{ 0 };
+    for (std::size_t cell{ 0 }; cell <= numCells; cell++) {
+      std::int32_t start{ readValue<std::int32_t>(bytes, offset + 4 * cell) };
+      if (start < previousStart || (cell == 0 && start != 0)) {
+        return false;
+      }
+      previousStart = start;
+    }
+    if (previousStart != numPoints) {
+      return false;
+    }
+    offset += (numCells + 1) * 4;
+    for (std::size_t k{ 0 }; k < n; k++) {
+      std::int32_t position{ readValue<std::int32_t>(bytes, offset + 4 * k) };
+      if (position < 0 || position >= numPoints) {
+        return false;
+      }
+    }
+    offset += n * 4;
+  }
+  if (offset + n * 4 != numBytes) {
+    return false;
+  }
+  for (std::size_t k{ 0 }; k < n; k++) {
+    std::int32_t index{ readValue<std::int32_t>(bytes, offset + 4 * k) };
+    if (index < 0 || index >= numPoints) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+template class BasicHeightBandedGridIndex<std::int32_t>;
+
+// The 64-bit index is built from the points but never serialized
+template BasicHeightBandedGridIndex<std::int64_t>::BasicHeightBandedGridIndex(
+  const double* pointsX, const double* pointsY, const double* pointsZ,
+  const std::int64_t numPoints, const double crownDiameter2TreeHeight,
+  const int numHeightBands
+);
+template const BasicHeightBandedGridIndex<std::int64_t>::HeightBand&
+BasicHeightBandedGridIndex<std::int64_t>::selectHeightBand(const double centroidZ) const;
@@ -0,0 +1,257 @@
+#ifndef HEIGHT_BANDED_GRID_INDEX_H
+#define HEIGHT_BANDED_GRID_INDEX_H
+
+#include <algorithm>  // for std::lower_bound, std::upper_bound, std::max, std::min
+#include <cmath>      // for std::ceil, std::floor, std::isfinite
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/** A spatial index for kernels whose radius grows with their height.
+ *
+ *  The kernel radius of the adaptive mean shift is proportional to the height
+ *  of the kernel's centroid. A single grid with one cell size is therefore
+ *  either much too coarse for small understory kernels or much too fine for
+ *  the kernels of emergent trees. This index holds several horizontal grids,
+ *  one per height band. The upper boundary of each band is twice the upper
+ *  boundary of the band below it and the cell size of each band equals the
+ *  largest kernel radius within the band. A query uses the grid of the band
+ *  that contains the kernel's centroid and visits at most 3 x 3 cells, so the
+ *  number of candidates per query stays proportional to the kernel area
+ *  across the whole height range.
+ *
+ *  The points are copied once into an internal buffer that is sorted by cell
+ *  of the finest grid and by height within each cell. Within the cells of
+ *  every grid the points are sorted by height as well, so that a query only
+ *  visits the points inside the vertical extent of the kernel.
+ *
+ *  \p Index is the type of the point positions. The 32-bit
+ *  HeightBandedGridIndex keeps tiles and most point clouds compact, while
+ *  LargeHeightBandedGridIndex holds point clouds with 2^31 or more points.
+ *  Only the 32-bit index can be serialized.
+ */
+template <typename Index>
+class BasicHeightBandedGridIndex {
+public:
+
+  /** Builds the index over \p numPoints points.
+   *
+   *  \p crownDiameter2TreeHeight is used to derive the largest kernel radius
+   *  of each height band. If \p numHeightBands is not positive, the number of
+   *  bands is chosen such that the lowest band ends at about two meters.
+   */
+  BasicHeightBandedGridIndex(
+    const double* pointsX, const double* pointsY, const double* pointsZ,
+    const Index numPoints,
+    const double crownDiameter2TreeHeight,
+    const int numHeightBands = 0
+  );
+
+  /** Restores an index from the bytes that serialize wrote for the same
+   *  points. The bytes must have passed isSerializedFor.
+   */
+  BasicHeightBandedGridIndex(
+    const double* pointsX, const double* pointsY, const double* pointsZ,
+    const Index numPoints, const unsigned char* serializedIndex
+  );
+
+  /** Appends the index without the coordinates of its points to \p bytes.
+   *  Restoring it skips the sorting of the points.
+   */
+  void serialize(std::vector<unsigned char>& bytes) const;
+
+  /** Whether \p numBytes bytes hold a complete serialized index of
+   *  \p numPoints points that was built with \p crownDiameter2TreeHeight
+   *  and the automatic number of height bands.
+   */
+  static bool isSerializedFor(
+    const unsigned char* bytes, const std::size_t numBytes,
+    const int numPoints, const double crownDiameter2TreeHeight
+  );
+
+  /** Calls \p visit(x, y, z, pointIndex) for every point that lies inside
+   *  the square of half side length \p radius around (\p centerX,
+   *  \p centerY), rounded outwards to the cells of the height band of
+   *  \p centroidZ, and inside the vertical interval [\p bottomZ, \p topZ].
+   *
+   *  \p pointIndex is the position of the point in the arrays the index was
+   *  built from.
+   *
+   *  If \p maxNumInCircle is positive, it caps the number of visited
+   *  candidates inside the circle of \p radius, which is how kernels count
+   *  their neighbors. This number is estimated from the number of candidates
+   *  and the ratio of the circle area to the area of the visited cells. If
+   *  it exceeds \p maxNumInCircle, only every k-th candidate of the
+   *  candidates of all cells, taken cell by cell, is visited, with k chosen
+   *  such that about \p maxNumInCircle candidates inside the circle are
+   *  visited. Every cell thus keeps its share of the sample up to one
+   *  candidate, also cells with fewer than k candidates. Since the points of
+   *  a cell are sorted by height, this is a deterministic sample that is
+   *  stratified by cell and by height. Returns whether the candidates were
+   *  subsampled.
+   */
+  template <typename Visitor>
+  bool forEachCandidate(
+    const double centerX, const double centerY, const double centroidZ,
+    const double radius, const double bottomZ, const double topZ,
+    Visitor visit, const int maxNumInCircle = 0
+  ) const;
+
+  Index numPoints() const { return static_cast<Index>(sortedZ.size()); }
+  int numHeightBands() const { return static_cast<int>(heightBands.size()); }
+
+private:
+
+  struct HeightBand {
+    double topZ;
+    double cellSize;
+    int numCellsX;
+    int numCellsY;
+    // Offsets of the first point of each cell in pointPositions. Has one more
+    // element than there are cells.
+    std::vector<Index> cellStarts;
+    // Positions in the sorted point buffer, grouped by cell and sorted by
+    // height within each cell.
+    std::vector<Index> pointPositions;
+  };
+
+  const HeightBand& selectHeightBand(const double centroidZ) const;
+
+  // Calls visitRange(first, last) with the range of point positions within
+  // the vertical interval for every cell that the query square touches and
+  // returns the area of these cells
+  template <typename RangeVisitor>
+  double forEachCellRange(
+    const double centerX, const double centerY, const double centroidZ,
+    const double radius, const double bottomZ, const double topZ,
+    RangeVisitor visitRange
+  ) const;
+
+  double crownDiameter2TreeHeight;
+  // Whether the number of height bands was chosen automatically
+  bool hasAutomaticHeightBands;
+  double minX;
+  double minY;
+
+  // The points sorted by cell of the finest grid and by height within cells.
+  std::vector<double> sortedX;
+  std::vector<double> sortedY;
+  std::vector<double> sortedZ;
+  std::vector<Index> originalIndices;
+
+  std::vector<HeightBand> heightBands;
+};
+
+
+typedef BasicHeightBandedGridIndex<std::int32_t> HeightBandedGridIndex;
+typedef BasicHeightBandedGridIndex<std::int64_t> LargeHeightBandedGridIndex;
+
+
+template <typename Index>
+template <typename RangeVisitor>
+double BasicHeightBandedGridIndex<Index>::forEachCellRange(
+    const double centerX, const double centerY, const double centroidZ,
+    const double radius, const double bottomZ, const double topZ,
+    RangeVisitor visitRange
+) const {
+  if (heightBands.empty()
+      || !std::isfinite(centerX) || !std::isfinite(centerY)
+      || !std::isfinite(radius) || radius < 0.0) {
+    return 0.0;
+  }
+
+  const HeightBand& band{ selectHeightBand(centroidZ) };
+
+  // Clamp the cell range to the grid before converting to integers so that
+  // very large kernels cannot overflow the cell indices
+  double lastCellX{ band.numCellsX - 1.0 };
+  double lastCellY{ band.numCellsY - 1.0 };
+  int firstX{ static_cast<int>(std::max(0.0, std::min(lastCellX,
+    std::floor((centerX - radius - minX) / band.cellSize)))) };
+  int lastX{ static_cast<int>(std::max(0.0, std::min(lastCellX,
+    std::floor((centerX + radius - minX) / band.cellSize)))) };
+  int firstY{ static_cast<int>(std::max(0.0, std::min(lastCellY,
+    std::floor((centerY - radius - minY) / band.cellSize)))) };
+  int lastY{ static_cast<int>(std::max(0.0, std::min(lastCellY,
+    std::floor((centerY + radius - minY) / band.cellSize)))) };
+
+  auto isLower = [this](const Index position, const double z) {
+    return sortedZ[position] < z;
+  };
+  auto isHigher = [this](const double z, const Index position) {
+    return z < sortedZ[position];
+  };
+
+  for (int cellY{ firstY }; cellY <= lastY; cellY++) {
+    for (int cellX{ firstX }; cellX <= lastX; cellX++) {
+      int cell{ cellX + cellY * band.numCellsX };
+      auto cellBegin = band.pointPositions.begin() + band.cellStarts[cell];
+      auto cellEnd = band.pointPositions.begin() + band.cellStarts[cell + 1];
+
+      // Only visit the points of the cell that lie in the vertical interval
+      auto first = std::lower_bound(cellBegin, cellEnd, bottomZ, isLower);
+      auto last = std::upper_bound(first, cellEnd, topZ, isHigher);
+      if (first != last) {
+        visitRange(first, last);
+      }
+    }
+  }
+  return (lastX - firstX + 1.0) * (lastY - firstY + 1.0)
+    * band.cellSize * band.cellSize;
+}
+
+
+template <typename Index>
+template <typename Visitor>
+bool BasicHeightBandedGridIndex<Index>::forEachCandidate(
+    const double centerX, const double centerY, const double centroidZ,
+    const double radius, const double bottomZ, const double topZ,
+    Visitor visit, const int maxNumInCircle
+) const {
+  typedef typename std::vector<Index>::const_iterator PositionIterator;
+
+  // Count the candidates first if their number is limited. Only the
+  // candidates inside the circle count, so their number is estimated from
+  // the share of the circle in the visited cells.
+  std::ptrdiff_t stride{ 1 };
+  if (maxNumInCircle > 0) {
+    std::ptrdiff_t numCandidates{ 0 };
+    double cellArea{ forEachCellRange(
+      centerX, centerY, centroidZ, radius, bottomZ, topZ,
+      [&numCandidates](PositionIterator first, PositionIterator last) {
+        numCandidates += last - first;
+      }
+    ) };
+    double circleArea{ 3.14159265358979323846 * radius * radius };
+    double numInCircle{ cellArea > circleArea
+      ? numCandidates * circleArea / cellArea
+      : static_cast<double>(numCandidates) };
+    stride = static_cast<std::ptrdiff_t>(std::ceil(numInCircle / maxNumInCircle));
+    stride = std::max(stride, static_cast<std::ptrdiff_t>(1));
+  }
+
+  // Take every stride-th candidate of the concatenated cell ranges, starting
+  // in the middle of the first stride. The position of the next sample is
+  // carried from one range to the next, so that sparse cells are sampled as
+  // well instead of being skipped.
+  std::ptrdiff_t next{ (stride - 1) / 2 };
+  forEachCellRange(
+    centerX, centerY, centroidZ, radius, bottomZ, topZ,
+    [&](PositionIterator first, PositionIterator last) {
+      std::ptrdiff_t numInRange{ last - first };
+      for (; next < numInRange; next += stride) {
+        Index position{ first[next] };
+        visit(
+          sortedX[position], sortedY[position], sortedZ[position],
+          originalIndices[position]
+        );
+      }
+      next -= numInRange;
+    }
+  );
+
+  return stride > 1;
+}
+
+#endif  // define HEIGHT_BANDED_GRID_INDEX_H
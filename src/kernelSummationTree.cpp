@@ -0,0 +1,325 @@
+#include "kernelSummationTree.h"
+#include "littleFunctionsImproved.h"
+
+#include <algorithm>  // for std::min_element, std::nth_element, std::stable_sort
+#include <cmath>      // for std::exp, std::floor, std::max
+#include <numeric>    // for std::iota
+#include <vector>
+
+
+namespace {
+
+// Thickness of the horizontal slabs in meters
+const double SLAB_THICKNESS{ 1.0 };
+
+// Maximum number of points in a leaf of the kd-trees
+const int MAX_NUM_POINTS_PER_LEAF{ 16 };
+
+// Squared horizontal distances from a point to the closest and the farthest
+// point of an axis-aligned rectangle
+double squaredMinDistance(
+    const double x, const double y,
+    const double minX, const double maxX, const double minY, const double maxY
+) {
+  double dx{ std::max(0.0, std::max(minX - x, x - maxX)) };
+  double dy{ std::max(0.0, std::max(minY - y, y - maxY)) };
+  return dx * dx + dy * dy;
+}
+
+double squaredMaxDistance(
+    const double x, const double y,
+    const double minX, const double maxX, const double minY, const double maxY
+) {
+  double dx{ std::max(x - minX, maxX - x) };
+  double dy{ std::max(y - minY, maxY - y) };
+  return dx * dx + dy * dy;
+}
+
+}  // namespace
+
+
+KernelSums KernelSummationTree::addExpandedNode(
+    KernelSums sums, const Node& node,
+    const double centerX, const double centerY, const double cylinderRadius,
+    const double c0, const double c1, const double c2
+) {
+  const Moments& m{ node.moments };
+
+  // Apply the epanechnikov polynomial to the moments
+  auto vertical = [c0, c1, c2](double a0, double a1, double a2) {
+    return c0 * a0 + c1 * a1 + c2 * a2;
+  };
+  double v{ vertical(m.count, m.z, m.zz) };
+  double vz{ vertical(m.z, m.zz, m.zzz) };
+  double vdx{ vertical(m.dx, m.dxz, m.dxzz) };
+  double vdy{ vertical(m.dy, m.dyz, m.dyzz) };
+  double vdxz{ vertical(m.dxz, m.dxzz, m.dxzzz) };
+  double vdyz{ vertical(m.dyz, m.dyzz, m.dyzzz) };
+  double vdxdx{ vertical(m.dxdx, m.dxdxz, m.dxdxzz) };
+  double vdxdy{ vertical(m.dxdy, m.dxdyz, m.dxdyzz) };
+  double vdydy{ vertical(m.dydy, m.dydyz, m.dydyzz) };
+
+  // Value and gradient of the gaussian at the node center
+  double nodeCenterX{ 0.5 * (node.minX + node.maxX) };
+  double nodeCenterY{ 0.5 * (node.minY + node.maxY) };
+  double g{ calculateHorizontalWeight(
+    nodeCenterX, nodeCenterY, cylinderRadius, centerX, centerY
+  ) };
+  double gradientFactor{ -10.0 * g / (cylinderRadius * cylinderRadius) };
+  double gx{ gradientFactor * (nodeCenterX - centerX) };
+  double gy{ gradientFactor * (nodeCenterY - centerY) };
+
+  // Sum the expansion g + gx * dx + gy * dy times the epanechnikov weight
+  double sumWeights{ g * v + gx * vdx + gy * vdy };
+  sums.sumWeights += sumWeights;
+  sums.sumX += nodeCenterX * sumWeights + g * vdx + gx * vdxdx + gy * vdxdy;
+  sums.sumY += nodeCenterY * sumWeights + g * vdy + gx * vdxdy + gy * vdydy;
+  sums.sumZ += g * vz + gx * vdxz + gy * vdyz;
+  return sums;
+}
+
+
+KernelSummationTree::KernelSummationTree(
+    const double* pointsX, const double* pointsY, const double* pointsZ,
+    const int numPoints
+) : offsetX{ 0.0 }, offsetY{ 0.0 } {
+  if (numPoints <= 0) {
+    return;
+  }
+
+  offsetX = *std::min_element(pointsX, pointsX + numPoints);
+  offsetY = *std::min_element(pointsY, pointsY + numPoints);
+  double minZ{ *std::min_element(pointsZ, pointsZ + numPoints) };
+
+  sortedX.resize(numPoints);
+  sortedY.resize(numPoints);
+  sortedZ.resize(numPoints);
+  for (int i{ 0 }; i < numPoints; i++) {
+    sortedX[i] = pointsX[i] - offsetX;
+    sortedY[i] = pointsY[i] - offsetY;
+    sortedZ[i] = pointsZ[i];
+  }
+
+  // Group the points by slab...
+  std::vector<int> slabOfPoint(numPoints);
+  for (int i{ 0 }; i < numPoints; i++) {
+    slabOfPoint[i] =
+      static_cast<int>(std::floor((sortedZ[i] - minZ) / SLAB_THICKNESS));
+  }
+  std::vector<int> order(numPoints);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(
+    order.begin(), order.end(),
+    [&slabOfPoint](const int a, const int b) {
+      return slabOfPoint[a] < slabOfPoint[b];
+    }
+  );
+
+  // ...and build one tree per slab
+  nodes.reserve(2 * numPoints / MAX_NUM_POINTS_PER_LEAF + 2);
+  int slabBegin{ 0 };
+  while (slabBegin < numPoints) {
+    int slabEnd{ slabBegin };
+    while (slabEnd < numPoints
+           && slabOfPoint[order[slabEnd]] == slabOfPoint[order[slabBegin]]) {
+      slabEnd++;
+    }
+    slabRoots.push_back(buildNode(order, slabBegin, slabEnd));
+    slabBegin = slabEnd;
+  }
+
+  // Store the points in tree order
+  std::vector<double> buffer(numPoints);
+  for (std::vector<double>* coordinates : { &sortedX, &sortedY, &sortedZ }) {
+    for (int position{ 0 }; position < numPoints; position++) {
+      buffer[position] = (*coordinates)[order[position]];
+    }
+    coordinates->swap(buffer);
+  }
+}
+
+
+int KernelSummationTree::buildNode(
+    std::vector<int>& order, const int begin, const int end
+) {
+  Node node;
+  node.begin = begin;
+  node.end = end;
+  node.left = -1;
+  node.right = -1;
+
+  // Calculate the bounding box and the moments of the node's points
+  int first{ order[begin] };
+  node.minX = node.maxX = sortedX[first];
+  node.minY = node.maxY = sortedY[first];
+  node.minZ = node.maxZ = sortedZ[first];
+  for (int position{ begin }; position < end; position++) {
+    int i{ order[position] };
+    node.minX = std::min(node.minX, sortedX[i]);
+    node.maxX = std::max(node.maxX, sortedX[i]);
+    node.minY = std::min(node.minY, sortedY[i]);
+    node.maxY = std::max(node.maxY, sortedY[i]);
+    node.minZ = std::min(node.minZ, sortedZ[i]);
+    node.maxZ = std::max(node.maxZ, sortedZ[i]);
+  }
+
+  double centerX{ 0.5 * (node.minX + node.maxX) };
+  double centerY{ 0.5 * (node.minY + node.maxY) };
+  Moments& m{ node.moments };
+  m = Moments{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+  for (int position{ begin }; position < end; position++) {
+    int i{ order[position] };
+    double dx{ sortedX[i] - centerX };
+    double dy{ sortedY[i] - centerY };
+    double z{ sortedZ[i] };
+    double zz{ z * z };
+
+    m.count += 1.0;
+    m.z += z;
+    m.zz += zz;
+    m.zzz += zz * z;
+    m.dx += dx;
+    m.dxz += dx * z;
+    m.dxzz += dx * zz;
+    m.dxzzz += dx * zz * z;
+    m.dy += dy;
+    m.dyz += dy * z;
+    m.dyzz += dy * zz;
+    m.dyzzz += dy * zz * z;
+    m.dxdx += dx * dx;
+    m.dxdxz += dx * dx * z;
+    m.dxdxzz += dx * dx * zz;
+    m.dxdy += dx * dy;
+    m.dxdyz += dx * dy * z;
+    m.dxdyzz += dx * dy * zz;
+    m.dydy += dy * dy;
+    m.dydyz += dy * dy * z;
+    m.dydyzz += dy * dy * zz;
+  }
+
+  int nodeIndex{ static_cast<int>(nodes.size()) };
+  nodes.push_back(node);
+
+  // Split larger nodes at the median of their wider horizontal side
+  if (end - begin > MAX_NUM_POINTS_PER_LEAF) {
+    const std::vector<double>& splitCoordinates{
+      node.maxX - node.minX >= node.maxY - node.minY ? sortedX : sortedY
+    };
+    int middle{ begin + (end - begin) / 2 };
+    std::nth_element(
+      order.begin() + begin, order.begin() + middle, order.begin() + end,
+      [&splitCoordinates](const int a, const int b) {
+        return splitCoordinates[a] < splitCoordinates[b];
+      }
+    );
+    int left{ buildNode(order, begin, middle) };
+    int right{ buildNode(order, middle, end) };
+    nodes[nodeIndex].left = left;
+    nodes[nodeIndex].right = right;
+  }
+
+  return nodeIndex;
+}
+
+
+KernelSums KernelSummationTree::sumCylinderKernel(
+    const double centerX, const double centerY,
+    const double cylinderMiddleZ,
+    const double cylinderRadius, const double cylinderHeight,
+    const double absoluteTolerance
+) const {
+  KernelSums sums{ 0.0, 0.0, 0.0, 0.0, 0 };
+
+  double x{ centerX - offsetX };
+  double y{ centerY - offsetY };
+  double squaredRadius{ cylinderRadius * cylinderRadius };
+
+  // Use the same vertical extent as intersectsCylinder
+  double topZ{ cylinderMiddleZ + (0.5 * cylinderHeight) };
+  double bottomZ{ topZ - cylinderHeight };
+
+  // Coefficients of the epanechnikov weight as polynomial in the height:
+  // 1 - ((z - middle) / halfHeight)^2 = c0 + c1 * z + c2 * z^2
+  double squaredHalfHeight{ 0.25 * cylinderHeight * cylinderHeight };
+  double c0{ 1.0 - cylinderMiddleZ * cylinderMiddleZ / squaredHalfHeight };
+  double c1{ 2.0 * cylinderMiddleZ / squaredHalfHeight };
+  double c2{ -1.0 / squaredHalfHeight };
+
+  std::vector<int> stack;
+  for (int root : slabRoots) {
+    stack.push_back(root);
+
+    while (!stack.empty()) {
+      const Node& node{ nodes[stack.back()] };
+      stack.pop_back();
+
+      // Skip nodes outside of the cylinder
+      if (node.maxZ < bottomZ || node.minZ > topZ) {
+        continue;
+      }
+      double squaredMinDist{ squaredMinDistance(
+        x, y, node.minX, node.maxX, node.minY, node.maxY
+      ) };
+      if (squaredMinDist > squaredRadius) {
+        continue;
+      }
+
+      // Sum nodes that lie completely inside the cylinder and over which the
+      // first order expansion of the gaussian is accurate enough in one step
+      if (bottomZ <= node.minZ && node.maxZ <= topZ
+          && squaredMaxDistance(
+               x, y, node.minX, node.maxX, node.minY, node.maxY
+             ) <= squaredRadius) {
+        double halfWidth{ 0.5 * (node.maxX - node.minX) };
+        double halfDepth{ 0.5 * (node.maxY - node.minY) };
+        double maxError{
+          5.0 * (halfWidth * halfWidth + halfDepth * halfDepth) / squaredRadius
+        };
+        if (maxError <= absoluteTolerance) {
+          sums = addExpandedNode(
+            sums, node, x, y, cylinderRadius, c0, c1, c2
+          );
+          sums.numExpandedNodes += 1;
+          continue;
+        }
+      }
+
+      if (node.left >= 0) {
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+        continue;
+      }
+
+      // Sum the points of leaves that are cut by the cylinder one by one
+      for (int position{ node.begin }; position < node.end; position++) {
+        double neighborX{ sortedX[position] };
+        double neighborY{ sortedY[position] };
+        double neighborZ{ sortedZ[position] };
+        if (
+          intersectsCylinder(
+            neighborX, neighborY, neighborZ,
+            cylinderRadius, cylinderHeight,
+            x, y, cylinderMiddleZ
+          )
+        ) {
+          double weight{
+            calculateVerticalWeight(neighborZ, cylinderMiddleZ, cylinderHeight)
+            * calculateHorizontalWeight(
+                neighborX, neighborY, cylinderRadius, x, y
+              )
+          };
+          sums.sumX += weight * neighborX;
+          sums.sumY += weight * neighborY;
+          sums.sumZ += weight * neighborZ;
+          sums.sumWeights += weight;
+        }
+      }
+    }
+  }
+
+  // Shift the weighted horizontal coordinates back to the original origin
+  sums.sumX += offsetX * sums.sumWeights;
+  sums.sumY += offsetY * sums.sumWeights;
+
+  return sums;
+}
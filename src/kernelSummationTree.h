@@ -0,0 +1,139 @@
+#ifndef KERNEL_SUMMATION_TREE_H
+#define KERNEL_SUMMATION_TREE_H
+
+#include <vector>
+
+
+/** Weighted sums of the points within a cylinder kernel. */
+struct KernelSums {
+  double sumX;
+  double sumY;
+  double sumZ;
+  double sumWeights;
+  // Number of tree nodes whose sums were approximated from their moments
+  int numExpandedNodes;
+};
+
+
+/** A tree for approximating the kernel sums of the improved mean shift.
+ *
+ *  The weight of a point within the cylinder kernel is the product of a
+ *  gaussian of its horizontal distance to the kernel center and an
+ *  epanechnikov function of its height. The epanechnikov function is a
+ *  polynomial of second degree in the height, so the epanechnikov weighted
+ *  sums of a group of points can be calculated exactly from a few height
+ *  moments of the group, as long as the whole group lies within the vertical
+ *  extent of the kernel. To make that the common case, the points are first
+ *  split into horizontal slabs of fixed thickness. The points of every slab
+ *  are then organized in a kd-tree over their horizontal coordinates whose
+ *  nodes store the bounding box and moments of their points.
+ *
+ *  A query descends the trees of all slabs that overlap the kernel. Within
+ *  a node that lies completely inside the cylinder, the gaussian is replaced
+ *  by its first order Taylor expansion around the center of the node, which
+ *  turns the node's contribution into a combination of its moments. The
+ *  error of the expansion is bounded by the largest second derivative of the
+ *  gaussian times half the squared distance from the node center to its
+ *  farthest corner, so nodes are only summed this way if that bound does not
+ *  exceed the tolerance. Nodes that lie completely outside of the cylinder
+ *  are skipped and the points of leaves that are cut by the cylinder
+ *  boundary are summed exactly. The weight used for every point therefore
+ *  differs by at most the tolerance from its exact weight.
+ */
+class KernelSummationTree {
+public:
+
+  KernelSummationTree(
+    const double* pointsX, const double* pointsY, const double* pointsZ,
+    const int numPoints
+  );
+
+  /** Sums the weights and the weighted coordinates of all points within the
+   *  cylinder that is used by meanShiftClassicImproved.
+   *
+   *  The cylinder has the radius \p cylinderRadius, the height
+   *  \p cylinderHeight and its center is at (\p centerX, \p centerY,
+   *  \p cylinderMiddleZ). The weight of every point may deviate by up to
+   *  \p absoluteTolerance from its exact weight.
+   */
+  KernelSums sumCylinderKernel(
+    const double centerX, const double centerY,
+    const double cylinderMiddleZ,
+    const double cylinderRadius, const double cylinderHeight,
+    const double absoluteTolerance
+  ) const;
+
+  int numNodes() const { return static_cast<int>(nodes.size()); }
+
+private:
+
+  // Sums of the point coordinates relative to the node center and of their
+  // products, each also multiplied with the height and the squared height.
+  // That is everything needed to apply a first order polynomial of the
+  // horizontal coordinates times a second degree polynomial of the height to
+  // a group of points at once.
+  struct Moments {
+    double count;
+    double z;
+    double zz;
+    double zzz;
+    double dx;
+    double dxz;
+    double dxzz;
+    double dxzzz;
+    double dy;
+    double dyz;
+    double dyzz;
+    double dyzzz;
+    double dxdx;
+    double dxdxz;
+    double dxdxzz;
+    double dxdy;
+    double dxdyz;
+    double dxdyzz;
+    double dydy;
+    double dydyz;
+    double dydyzz;
+  };
+
+  struct Node {
+    double minX;
+    double maxX;
+    double minY;
+    double maxY;
+    double minZ;
+    double maxZ;
+    Moments moments;
+    // Range of the node's points in the sorted point buffer
+    int begin;
+    int end;
+    // Children of the node, -1 for leaves
+    int left;
+    int right;
+  };
+
+  int buildNode(std::vector<int>& order, const int begin, const int end);
+
+  // Adds the contribution of a node's points to the sums using the first
+  // order expansion of the gaussian around the node center. c0, c1 and c2 are
+  // the coefficients of the epanechnikov weight as a polynomial in the height.
+  static KernelSums addExpandedNode(
+    KernelSums sums, const Node& node,
+    const double centerX, const double centerY, const double cylinderRadius,
+    const double c0, const double c1, const double c2
+  );
+
+  // The horizontal coordinates are stored relative to the lower left corner
+  // of the point cloud to keep the moments numerically stable.
+  double offsetX;
+  double offsetY;
+
+  std::vector<double> sortedX;
+  std::vector<double> sortedY;
+  std::vector<double> sortedZ;
+
+  std::vector<Node> nodes;
+  std::vector<int> slabRoots;
+};
+
+#endif  // define KERNEL_SUMMATION_TREE_H
@@ -0,0 +1,677 @@
+#include "lasCatalog.h"
+
+#include "binaryIo.h"
+#include "parallelFor.h"
+
+#include <algorithm>  // for std::max, std::min, std::sort, std::stable_sort
+#include <cmath>      // for std::floor, std::fabs, std::isfinite, std::round
+#include <cstring>    // for std::memcmp
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+const char MAGIC[4]{ 'M', 'S', 'L', 'C' };
+const std::uint32_t FORMAT_VERSION{ 1 };
+
+// Records of the same cell that are at most this many records apart are
+// merged into one run. Decoding the records in between is cheaper than
+// keeping and seeking to many short runs.
+const std::uint64_t MAX_RUN_GAP{ 256 };
+
+// Largest number of grid cells of one file
+const long long MAX_NUM_CELLS{ 1LL << 24 };
+
+int findCell(
+    const double coordinate, const double gridMin, const double cellSize,
+    const int numCells
+) {
+  double cell{ std::floor((coordinate - gridMin) / cellSize) };
+  return static_cast<int>(std::max(0.0, std::min(numCells - 1.0, cell)));
+}
+
+// Lays a grid with cells aligned to multiples of cellSize over the extent.
+// Returns false if the grid would have too many cells.
+bool setGrid(
+    LasCatalogEntry& entry, const double minX, const double maxX,
+    const double minY, const double maxY, const double cellSize
+) {
+  double gridMinX{ std::floor(minX / cellSize) * cellSize };
+  double gridMinY{ std::floor(minY / cellSize) * cellSize };
+  double numCellsX{ std::floor((maxX - gridMinX) / cellSize) + 1.0 };
+  double numCellsY{ std::floor((maxY - gridMinY) / cellSize) + 1.0 };
+  if (!(numCellsX * numCellsY <= static_cast<double>(MAX_NUM_CELLS))) {
+    return false;
+  }
+  entry.gridMinX = gridMinX;
+  entry.gridMinY = gridMinY;
+  entry.numCellsX = static_cast<int>(numCellsX);
+  entry.numCellsY = static_cast<int>(numCellsY);
+  return true;
+}
+
+
+// Decodes every record once to get the exact extent of the points and to
+// group their records into runs per cell of the grid of the entry. Returns
+// false if a point lies outside the grid, in which case only the extent is
+// complete.
+bool indexRecords(LasFile& las, LasCatalogEntry& entry, const double cellSize) {
+  const double NA{ std::numeric_limits<double>::quiet_NaN() };
+  entry.minX = entry.maxX = entry.minY = entry.maxY = NA;
+  entry.minZ = entry.maxZ = NA;
+  int numCells{ entry.numCells() };
+
+  // Extend the open run of the cell of every point or close it and start a
+  // new one. An open run that ends at 0 does not exist yet.
+  std::vector<std::uint64_t> openFirsts(numCells, 0);
+  std::vector<std::uint64_t> openEnds(numCells, 0);
+  std::vector<int> runCells;
+  std::vector<LasRecordRun> runs;
+  entry.cellNumPoints.assign(numCells, 0);
+  bool isInGrid{ true };
+  bool isEmpty{ true };
+  double x, y, z;
+  for (std::uint64_t i{ 0 }; i < entry.numPoints; i++) {
+    las.coordinates(i, x, y, z);
+    if (!std::isfinite(x) || !std::isfinite(y)) {
+      continue;
+    }
+    if (isEmpty) {
+      entry.minX = entry.maxX = x;
+      entry.minY = entry.maxY = y;
+      entry.minZ = entry.maxZ = z;
+      isEmpty = false;
+    }
+    entry.minX = std::min(entry.minX, x);
+    entry.maxX = std::max(entry.maxX, x);
+    entry.minY = std::min(entry.minY, y);
+    entry.maxY = std::max(entry.maxY, y);
+    entry.minZ = std::min(entry.minZ, z);
+    entry.maxZ = std::max(entry.maxZ, z);
+    if (!isInGrid) {
+      continue;
+    }
+
+    double cellX{ std::floor((x - entry.gridMinX) / cellSize) };
+    double cellY{ std::floor((y - entry.gridMinY) / cellSize) };
+    if (!(cellX >= 0.0 && cellX < entry.numCellsX
+          && cellY >= 0.0 && cellY < entry.numCellsY)) {
+      isInGrid = false;
+      continue;
+    }
+    int cell{ static_cast<int>(cellX) + entry.numCellsX * static_cast<int>(cellY) };
+    entry.cellNumPoints[cell] += 1;
+    if (openEnds[cell] > 0 && i - openEnds[cell] <= MAX_RUN_GAP) {
+      openEnds[cell] = i + 1;
+      continue;
+    }
+    if (openEnds[cell] > 0) {
+      runCells.push_back(cell);
+      runs.push_back(LasRecordRun{
+        openFirsts[cell], openEnds[cell] - openFirsts[cell]
+      });
+    }
+    openFirsts[cell] = i;
+    openEnds[cell] = i + 1;
+  }
+  if (!isInGrid) {
+    return false;
+  }
+  for (int cell{ 0 }; cell < numCells; cell++) {
+    if (openEnds[cell] > 0) {
+      runCells.push_back(cell);
+      runs.push_back(LasRecordRun{
+        openFirsts[cell], openEnds[cell] - openFirsts[cell]
+      });
+    }
+  }
+
+  // Group the runs by cell. The runs of each cell were closed in the order
+  // of their records, so they stay sorted.
+  entry.cellRunStarts.assign(numCells + 1, 0);
+  for (int cell : runCells) {
+    entry.cellRunStarts[cell + 1] += 1;
+  }
+  for (int cell{ 0 }; cell < numCells; cell++) {
+    entry.cellRunStarts[cell + 1] += entry.cellRunStarts[cell];
+  }
+  std::vector<std::uint64_t> nextSlots(
+    entry.cellRunStarts.begin(), entry.cellRunStarts.end() - 1
+  );
+  entry.runs.resize(runs.size());
+  for (std::size_t run{ 0 }; run < runs.size(); run++) {
+    entry.runs[nextSlots[runCells[run]]++] = runs[run];
+  }
+  return true;
+}
+
+
+LasCatalogEntry createEntry(const std::string& path, const double cellSize) {
+  LasFile las{ path };
+  const LasHeader& header{ las.header() };
+  const double NA{ std::numeric_limits<double>::quiet_NaN() };
+  LasCatalogEntry entry;
+  entry.path = path;
+  entry.numPoints = header.numPoints;
+
+  // The extent in the header is usually correct, so the records only need
+  // to be decoded once over a grid of that extent. If a point lies outside
+  // of it, the records are decoded again over a grid of the decoded extent.
+  // Without a usable extent the first pass only decodes the extent.
+  entry.gridMinX = entry.gridMinY = NA;
+  entry.numCellsX = entry.numCellsY = 0;
+  bool hasExtent{
+    header.minX <= header.maxX && header.minY <= header.maxY
+    && std::isfinite(header.minX) && std::isfinite(header.maxX)
+    && std::isfinite(header.minY) && std::isfinite(header.maxY)
+  };
+  if (!hasExtent
+      || !setGrid(entry, header.minX, header.maxX, header.minY, header.maxY, cellSize)) {
+    entry.numCellsX = entry.numCellsY = 0;
+  }
+  if (!indexRecords(las, entry, cellSize)) {
+    if (!setGrid(entry, entry.minX, entry.maxX, entry.minY, entry.maxY, cellSize)) {
+      throw std::runtime_error(
+        path + " needs too many grid cells. Use a larger cell size."
+      );
+    }
+    indexRecords(las, entry, cellSize);
+  }
+
+  if (!std::isfinite(entry.minX)) {
+    // Files without points have no cells
+    entry.gridMinX = entry.gridMinY = NA;
+    entry.numCellsX = entry.numCellsY = 0;
+    entry.cellRunStarts.assign(1, 0);
+    entry.cellNumPoints.clear();
+    entry.runs.clear();
+  }
+  return entry;
+}
+
+// Reads the values of a catalog file one after another and throws if the
+// file ends too early
+class CatalogReader {
+public:
+
+  CatalogReader(const MappedFile& file, const std::string& path)
+    : bytes(file.data()), numBytes(file.size()), offset(0), path(path) {}
+
+  template <typename T>
+  T next() {
+    require(sizeof(T));
+    T value{ readValue<T>(bytes, offset) };
+    offset += sizeof(T);
+    return value;
+  }
+
+  std::string nextString(const std::size_t length) {
+    require(length);
+    std::string value(reinterpret_cast<const char*>(bytes + offset), length);
+    offset += length;
+    return value;
+  }
+
+  void fail() const {
+    throw std::runtime_error(path + " is a damaged LAS catalog file.");
+  }
+
+  void require(const std::size_t length) const {
+    if (numBytes - offset < length) {
+      fail();
+    }
+  }
+
+private:
+
+  const unsigned char* bytes;
+  std::size_t numBytes;
+  std::size_t offset;
+  std::string path;
+};
+
+// A point of a tile that is read from the catalog
+struct CatalogPoint {
+  double x;
+  double y;
+  double z;
+};
+
+}  // namespace
+
+
+LasCatalog::LasCatalog(
+    const std::vector<std::string>& paths, const double cellSize,
+    const int numThreads
+) : gridCellSize(cellSize) {
+  if (!(cellSize > 0.0) || !std::isfinite(cellSize)) {
+    throw std::runtime_error("The cell size of a LAS catalog must be positive.");
+  }
+
+  int numFiles{ static_cast<int>(paths.size()) };
+  catalogEntries.resize(numFiles);
+  std::vector<std::string> errors(numFiles);
+  parallelFor(0, numFiles, numThreads, [&](int file) {
+    try {
+      catalogEntries[file] = createEntry(paths[file], cellSize);
+    } catch (const std::exception& exception) {
+      errors[file] = exception.what();
+    }
+  }, 1);
+  for (const std::string& error : errors) {
+    if (!error.empty()) {
+      throw std::runtime_error(error);
+    }
+  }
+}
+
+
+LasCatalog::LasCatalog(const std::string& path) {
+  MappedFile file{ path };
+  CatalogReader reader{ file, path };
+  if (file.size() < sizeof(MAGIC)
+      || std::memcmp(file.data(), MAGIC, sizeof(MAGIC)) != 0) {
+    throw std::runtime_error(path + " is not a LAS catalog file.");
+  }
+  reader.nextString(sizeof(MAGIC));
+  if (reader.next<std::uint32_t>() != FORMAT_VERSION) {
+    throw std::runtime_error(path + " has an unknown LAS catalog version.");
+  }
+  gridCellSize = reader.next<double>();
+  std::uint64_t numEntries{ reader.next<std::uint64_t>() };
+  if (!(gridCellSize > 0.0) || numEntries > file.size()) {
+    reader.fail();
+  }
+
+  catalogEntries.resize(numEntries);
+  for (LasCatalogEntry& entry : catalogEntries) {
+    entry.path = reader.nextString(reader.next<std::uint64_t>());
+    entry.numPoints = reader.next<std::uint64_t>();
+    double* values[8]{
+      &entry.minX, &entry.maxX, &entry.minY, &entry.maxY,
+      &entry.minZ, &entry.maxZ, &entry.gridMinX, &entry.gridMinY
+    };
+    for (double* value : values) {
+      *value = reader.next<double>();
+    }
+    entry.numCellsX = reader.next<std::int32_t>();
+    entry.numCellsY = reader.next<std::int32_t>();
+    if (entry.numCellsX < 0 || entry.numCellsY < 0
+        || static_cast<long long>(entry.numCellsX) * entry.numCellsY
+             > MAX_NUM_CELLS) {
+      reader.fail();
+    }
+    std::uint64_t numRuns{ reader.next<std::uint64_t>() };
+    std::size_t numCells{ static_cast<std::size_t>(entry.numCells()) };
+    reader.require((2 * numCells + 1) * sizeof(std::uint64_t));
+    entry.cellRunStarts.resize(numCells + 1);
+    for (std::uint64_t& start : entry.cellRunStarts) {
+      start = reader.next<std::uint64_t>();
+    }
+    entry.cellNumPoints.resize(numCells);
+    for (std::uint64_t& count : entry.cellNumPoints) {
+      count = reader.next<std::uint64_t>();
+    }
+    if (numRuns > file.size()) {
+      reader.fail();
+    }
+    entry.runs.resize(numRuns);
+    for (LasRecordRun& run : entry.runs) {
+      run.first = reader.next<std::uint64_t>();
+      run.count = reader.next<std::uint64_t>();
+      if (run.first > entry.numPoints || run.count > entry.numPoints - run.first) {
+        reader.fail();
+      }
+    }
+
+    // The runs of the cells must be consecutive ranges of all runs
+    if (entry.cellRunStarts.front() != 0
+        || entry.cellRunStarts.back() != numRuns) {
+      reader.fail();
+    }
+    for (std::size_t cell{ 0 }; cell < numCells; cell++) {
+      if (entry.cellRunStarts[cell] > entry.cellRunStarts[cell + 1]) {
+        reader.fail();
+      }
+    }
+  }
+}
+
+
+void LasCatalog::save(const std::string& path) const {
+  std::vector<unsigned char> bytes(MAGIC, MAGIC + sizeof(MAGIC));
+  appendValue<std::uint32_t>(bytes, FORMAT_VERSION);
+  appendValue<double>(bytes, gridCellSize);
+  appendValue<std::uint64_t>(bytes, catalogEntries.size());
+  for (const LasCatalogEntry& entry : catalogEntries) {
+    appendValue<std::uint64_t>(bytes, entry.path.size());
+    appendValues(
+      bytes, reinterpret_cast<const unsigned char*>(entry.path.data()),
+      entry.path.size()
+    );
+    appendValue<std::uint64_t>(bytes, entry.numPoints);
+    const double values[8]{
+      entry.minX, entry.maxX, entry.minY, entry.maxY,
+      entry.minZ, entry.maxZ, entry.gridMinX, entry.gridMinY
+    };
+    appendValues(bytes, values, 8);
+    appendValue<std::int32_t>(bytes, entry.numCellsX);
+    appendValue<std::int32_t>(bytes, entry.numCellsY);
+    appendValue<std::uint64_t>(bytes, entry.runs.size());
+    appendValues(bytes, entry.cellRunStarts.data(), entry.cellRunStarts.size());
+    appendValues(bytes, entry.cellNumPoints.data(), entry.cellNumPoints.size());
+    for (const LasRecordRun& run : entry.runs) {
+      appendValue<std::uint64_t>(bytes, run.first);
+      appendValue<std::uint64_t>(bytes, run.count);
+    }
+  }
+
+  std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+  file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  file.close();
+  if (!file) {
+    throw std::runtime_error("The LAS catalog file " + path
+                             + " cannot be written.");
+  }
+}
+
+
+void LasCatalog::findRuns(
+    const int entryIndex, const double minX, const double minY,
+    const double maxX, const double maxY, std::vector<LasRecordRun>& runs
+) const {
+  const LasCatalogEntry& entry{ catalogEntries[entryIndex] };
+  if (entry.numCells() == 0
+      || maxX < entry.minX || minX > entry.maxX
+      || maxY < entry.minY || minY > entry.maxY) {
+    return;
+  }
+
+  int firstX{ findCell(minX, entry.gridMinX, gridCellSize, entry.numCellsX) };
+  int lastX{ findCell(maxX, entry.gridMinX, gridCellSize, entry.numCellsX) };
+  int firstY{ findCell(minY, entry.gridMinY, gridCellSize, entry.numCellsY) };
+  int lastY{ findCell(maxY, entry.gridMinY, gridCellSize, entry.numCellsY) };
+  std::vector<LasRecordRun> cellRuns;
+  for (int cellY{ firstY }; cellY <= lastY; cellY++) {
+    for (int cellX{ firstX }; cellX <= lastX; cellX++) {
+      int cell{ cellX + cellY * entry.numCellsX };
+      cellRuns.insert(
+        cellRuns.end(), entry.runs.begin() + entry.cellRunStarts[cell],
+        entry.runs.begin() + entry.cellRunStarts[cell + 1]
+      );
+    }
+  }
+
+  // Merge the runs of different cells that overlap or touch, so that every
+  // record is decoded once
+  std::sort(
+    cellRuns.begin(), cellRuns.end(),
+    [](const LasRecordRun& a, const LasRecordRun& b) {
+      return a.first < b.first;
+    }
+  );
+  std::size_t numRuns{ runs.size() };
+  for (const LasRecordRun& run : cellRuns) {
+    if (runs.size() > numRuns
+        && run.first <= runs.back().first + runs.back().count) {
+      runs.back().count = std::max(
+        runs.back().count, run.first + run.count - runs.back().first
+      );
+    } else {
+      runs.push_back(run);
+    }
+  }
+}
+
+
+CatalogTileGrid LasCatalog::tileGrid(const double coreWidth) const {
+  CatalogTileGrid grid{ 0.0, 0.0, coreWidth, 0, 0 };
+  bool isEmpty{ true };
+  double maxX{ 0.0 };
+  double maxY{ 0.0 };
+  for (const LasCatalogEntry& entry : catalogEntries) {
+    if (entry.numCells() == 0) {
+      continue;
+    }
+    if (isEmpty) {
+      grid.minX = entry.minX;
+      grid.minY = entry.minY;
+      maxX = entry.maxX;
+      maxY = entry.maxY;
+      isEmpty = false;
+    }
+    grid.minX = std::min(grid.minX, entry.minX);
+    grid.minY = std::min(grid.minY, entry.minY);
+    maxX = std::max(maxX, entry.maxX);
+    maxY = std::max(maxY, entry.maxY);
+  }
+  if (isEmpty || !(coreWidth > 0.0)) {
+    return grid;
+  }
+
+  grid.minX = std::floor(grid.minX / coreWidth) * coreWidth;
+  grid.minY = std::floor(grid.minY / coreWidth) * coreWidth;
+  grid.numColumns =
+    static_cast<long long>(std::floor((maxX - grid.minX) / coreWidth)) + 1;
+  grid.numRows =
+    static_cast<long long>(std::floor((maxY - grid.minY) / coreWidth)) + 1;
+  return grid;
+}
+
+
+std::vector<CatalogTile> LasCatalog::planTiles(
+    const CatalogTileGrid& grid
+) const {
+  if (grid.numColumns == 0) {
+    return std::vector<CatalogTile>();
+  }
+
+  // Finds the tiles that the interval [first, last] of a cell overlaps and
+  // the share of the interval that falls into each of them
+  auto overlapTiles = [&grid](
+    const double first, const double last, const double gridMin,
+    const long long numTiles, long long& firstTile, long long& lastTile
+  ) {
+    firstTile = static_cast<long long>(
+      std::floor((first - gridMin) / grid.coreWidth)
+    );
+    lastTile = static_cast<long long>(
+      std::floor((last - gridMin) / grid.coreWidth)
+    );
+    firstTile = std::max(0LL, std::min(numTiles - 1, firstTile));
+    lastTile = std::max(firstTile, std::min(numTiles - 1, lastTile));
+  };
+  auto share = [&grid](
+    const double first, const double last, const double gridMin,
+    const long long tile
+  ) {
+    if (!(last > first)) {
+      return 1.0;
+    }
+    double tileFirst{ gridMin + tile * grid.coreWidth };
+    double overlap{
+      std::min(last, tileFirst + grid.coreWidth) - std::max(first, tileFirst)
+    };
+    return std::max(0.0, overlap) / (last - first);
+  };
+
+  std::map<long long, double> tileNumPoints;
+  for (const LasCatalogEntry& entry : catalogEntries) {
+    for (int cell{ 0 }; cell < entry.numCells(); cell++) {
+      if (entry.cellNumPoints[cell] == 0) {
+        continue;
+      }
+
+      // Clip the cell to the extent of the points of the file, and to its
+      // own upper and right edges, which belong to the next cells
+      double cellMinX{ entry.gridMinX + (cell % entry.numCellsX) * gridCellSize };
+      double cellMinY{ entry.gridMinY + (cell / entry.numCellsX) * gridCellSize };
+      double firstX{ std::max(cellMinX, entry.minX) };
+      double lastX{ std::min(cellMinX + gridCellSize, entry.maxX) };
+      double firstY{ std::max(cellMinY, entry.minY) };
+      double lastY{ std::min(cellMinY + gridCellSize, entry.maxY) };
+      long long firstColumn, lastColumn, firstRow, lastRow;
+      overlapTiles(firstX, lastX, grid.minX, grid.numColumns,
+                   firstColumn, lastColumn);
+      overlapTiles(firstY, lastY, grid.minY, grid.numRows, firstRow, lastRow);
+      if (lastColumn > firstColumn
+          && grid.minX + lastColumn * grid.coreWidth >= cellMinX + gridCellSize) {
+        lastColumn--;
+      }
+      if (lastRow > firstRow
+          && grid.minY + lastRow * grid.coreWidth >= cellMinY + gridCellSize) {
+        lastRow--;
+      }
+
+      for (long long row{ firstRow }; row <= lastRow; row++) {
+        for (long long column{ firstColumn }; column <= lastColumn; column++) {
+          tileNumPoints[column + grid.numColumns * row] +=
+            entry.cellNumPoints[cell]
+            * share(firstX, lastX, grid.minX, column)
+            * share(firstY, lastY, grid.minY, row);
+        }
+      }
+    }
+  }
+
+  std::vector<CatalogTile> tiles;
+  tiles.reserve(tileNumPoints.size());
+  for (const auto& tile : tileNumPoints) {
+    tiles.push_back(CatalogTile{
+      tile.first,
+      grid.minX + (tile.first % grid.numColumns) * grid.coreWidth,
+      grid.minY + (tile.first / grid.numColumns) * grid.coreWidth,
+      std::round(tile.second)
+    });
+  }
+  return tiles;
+}
+
+
+bool LasCatalog::readTile(
+    const CatalogTileGrid& grid, const long long tileKey,
+    const double bufferWidth, const LasPointFilter& filter,
+    TileColumns& columns, std::string& error
+) const {
+  columns.pointsX.clear();
+  columns.pointsY.clear();
+  columns.pointsZ.clear();
+  columns.buffer.clear();
+  columns.hasCoreExtent = false;
+  if (grid.numColumns == 0 || tileKey < 0) {
+    error = "The LAS catalog has no tile " + std::to_string(tileKey + 1) + ".";
+    return false;
+  }
+
+  double coreWidth{ grid.coreWidth };
+  long long tileColumn{ tileKey % grid.numColumns };
+  long long tileRow{ tileKey / grid.numColumns };
+  double lowerLeftX{ grid.minX + tileColumn * coreWidth };
+  double lowerLeftY{ grid.minY + tileRow * coreWidth };
+
+  // Checks whether a coordinate lies in the buffer of the neighbor in the
+  // direction offset along one axis, like splitIntoBufferedTiles
+  auto isInBuffer = [coreWidth, bufferWidth](
+    const double coordinate, const double lowerLeft, const long long offset
+  ) {
+    if (offset < 0) {
+      return coordinate > lowerLeft && coordinate <= lowerLeft + bufferWidth;
+    }
+    if (offset > 0) {
+      return coordinate >= lowerLeft + coreWidth - bufferWidth;
+    }
+    return true;
+  };
+
+  // Search a slightly larger rectangle, since the tile boundaries of the
+  // points are calculated from the lower left corners of their own tiles
+  double margin{ 1e-9 * (std::fabs(lowerLeftX) + std::fabs(lowerLeftY)
+                         + coreWidth + bufferWidth) };
+  double searchMinX{ lowerLeftX - bufferWidth - margin };
+  double searchMaxX{ lowerLeftX + coreWidth + bufferWidth + margin };
+  double searchMinY{ lowerLeftY - bufferWidth - margin };
+  double searchMaxY{ lowerLeftY + coreWidth + bufferWidth + margin };
+
+  std::vector<CatalogPoint> corePoints;
+  std::vector<CatalogPoint> bufferPoints;
+  std::vector<LasRecordRun> runs;
+  for (int entry{ 0 }; entry < static_cast<int>(catalogEntries.size()); entry++) {
+    runs.clear();
+    findRuns(entry, searchMinX, searchMinY, searchMaxX, searchMaxY, runs);
+    if (runs.empty()) {
+      continue;
+    }
+
+    try {
+      LasFile las{ catalogEntries[entry].path };
+      if (las.header().numPoints != catalogEntries[entry].numPoints) {
+        error = catalogEntries[entry].path
+          + " has changed since the LAS catalog was built.";
+        return false;
+      }
+      for (const LasRecordRun& run : runs) {
+        for (std::uint64_t i{ run.first }; i < run.first + run.count; i++) {
+          if (!las.isKept(i, filter)) {
+            continue;
+          }
+          CatalogPoint point;
+          las.coordinates(i, point.x, point.y, point.z);
+          if (!std::isfinite(point.x) || !std::isfinite(point.y)) {
+            continue;
+          }
+
+          long long column{ static_cast<long long>(
+            std::floor((point.x - grid.minX) / coreWidth)
+          ) };
+          long long row{ static_cast<long long>(
+            std::floor((point.y - grid.minY) / coreWidth)
+          ) };
+          if (column == tileColumn && row == tileRow) {
+            corePoints.push_back(point);
+            continue;
+          }
+          long long offsetX{ tileColumn - column };
+          long long offsetY{ tileRow - row };
+          if (offsetX < -1 || offsetX > 1 || offsetY < -1 || offsetY > 1) {
+            continue;
+          }
+          if (isInBuffer(point.x, grid.minX + column * coreWidth, offsetX)
+              && isInBuffer(point.y, grid.minY + row * coreWidth, offsetY)) {
+            bufferPoints.push_back(point);
+          }
+        }
+      }
+    } catch (const std::exception& exception) {
+      error = exception.what();
+      return false;
+    }
+  }
+
+  // Sort the core and the buffer points like splitIntoBufferedTiles
+  auto isBefore = [](const CatalogPoint& a, const CatalogPoint& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  };
+  std::stable_sort(corePoints.begin(), corePoints.end(), isBefore);
+  std::stable_sort(bufferPoints.begin(), bufferPoints.end(), isBefore);
+
+  std::size_t numPoints{ corePoints.size() + bufferPoints.size() };
+  columns.pointsX.reserve(numPoints);
+  columns.pointsY.reserve(numPoints);
+  columns.pointsZ.reserve(numPoints);
+  columns.buffer.reserve(numPoints);
+  const std::vector<CatalogPoint>* parts[2]{ &corePoints, &bufferPoints };
+  for (int part{ 0 }; part < 2; part++) {
+    for (const CatalogPoint& point : *parts[part]) {
+      columns.pointsX.push_back(point.x);
+      columns.pointsY.push_back(point.y);
+      columns.pointsZ.push_back(point.z);
+      columns.buffer.push_back(part);
+    }
+  }
+  return true;
+}
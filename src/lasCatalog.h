@@ -0,0 +1,146 @@
+#ifndef LAS_CATALOG_H
+#define LAS_CATALOG_H
+
+#include "lasFile.h"
+#include "tileFiles.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/** The consecutive point records [first, first + count) of a LAS file. */
+struct LasRecordRun {
+  std::uint64_t first;
+  std::uint64_t count;
+};
+
+
+/** What a LasCatalog knows about one LAS file. */
+struct LasCatalogEntry {
+  std::string path;
+  std::uint64_t numPoints;
+  // Extent of the decoded points, which is exact even if the header is not.
+  // NaN for files without points.
+  double minX;
+  double maxX;
+  double minY;
+  double maxY;
+  double minZ;
+  double maxZ;
+  // A coarse grid over the extent in the header, or over the extent of the
+  // decoded points if the header misses some of them, whose cells are
+  // aligned to multiples of the cell size of the catalog. Files without
+  // points have no cells.
+  double gridMinX;
+  double gridMinY;
+  int numCellsX;
+  int numCellsY;
+  // Offsets of the first run of each cell in runs. Has one more element than
+  // there are cells.
+  std::vector<std::uint64_t> cellRunStarts;
+  std::vector<std::uint64_t> cellNumPoints;
+  // The records of the points of each cell, sorted by their first record.
+  // Runs may include a few records of other cells.
+  std::vector<LasRecordRun> runs;
+
+  int numCells() const { return numCellsX * numCellsY; }
+};
+
+
+/** The grid of square tiles of split_point_cloud_buffered over all points of
+ *  a catalog. The key of a tile is column + numColumns * row, its plot index
+ *  minus one.
+ */
+struct CatalogTileGrid {
+  double minX;
+  double minY;
+  double coreWidth;
+  long long numColumns;
+  long long numRows;
+};
+
+
+/** A tile of a CatalogTileGrid that may contain points. */
+struct CatalogTile {
+  long long key;
+  double lowerLeftX;
+  double lowerLeftY;
+  // The number of points in the core area, estimated from the cells of the
+  // catalog. It is exact if the core width is a multiple of the cell size.
+  double numPoints;
+};
+
+
+/** An index of the points of many LAS files that tells which records of
+ *  which files can lie in a rectangle, so that a tile and its buffer are read
+ *  without scanning or even opening the other files.
+ *
+ *  Building it reads every file once, or twice if the extent in its header
+ *  misses some of its points. For every file, it records the extent
+ *  and the number of points and, for every cell of a coarse grid, the runs
+ *  of records whose points lie in the cell. Records that are at most a few
+ *  hundred records apart are merged into one run, so files that are stored
+ *  in scan or in spatial order need few runs. The catalog is saved to a small
+ *  binary file. Errors throw std::runtime_error. None of the member functions
+ *  calls the R API.
+ */
+class LasCatalog {
+public:
+
+  /** Builds the catalog of the LAS files \p paths with grid cells of side
+   *  length \p cellSize, reading \p numThreads files at a time.
+   */
+  LasCatalog(
+    const std::vector<std::string>& paths, const double cellSize,
+    const int numThreads
+  );
+
+  /** Reads a catalog file that save wrote. */
+  explicit LasCatalog(const std::string& path);
+
+  void save(const std::string& path) const;
+
+  double cellSize() const { return gridCellSize; }
+  const std::vector<LasCatalogEntry>& entries() const { return catalogEntries; }
+
+  /** Appends the runs of the records of entry \p entry whose points can lie
+   *  in the rectangle [\p minX, \p maxX] x [\p minY, \p maxY] to \p runs. The
+   *  appended runs are sorted and do not overlap.
+   */
+  void findRuns(
+    const int entry, const double minX, const double minY,
+    const double maxX, const double maxY, std::vector<LasRecordRun>& runs
+  ) const;
+
+  /** The tile grid with the core width \p coreWidth. Its lower left corner
+   *  is the minimum of the points of all files rounded down to a multiple of
+   *  the core width, like in split_point_cloud_buffered.
+   */
+  CatalogTileGrid tileGrid(const double coreWidth) const;
+
+  /** The tiles of \p grid that are touched by a cell with points, sorted by
+   *  their keys. Only needs the catalog, not the LAS files.
+   */
+  std::vector<CatalogTile> planTiles(const CatalogTileGrid& grid) const;
+
+  /** Reads the points of the tile with the key \p tileKey of \p grid and
+   *  its buffer of width \p bufferWidth, like split_point_cloud_buffered for
+   *  the points of all files, but only decodes the records that the catalog
+   *  finds near the tile. Only the points that pass \p filter are read; the
+   *  filter does not change the grid. Returns false and sets \p error if a
+   *  file cannot be read.
+   */
+  bool readTile(
+    const CatalogTileGrid& grid, const long long tileKey,
+    const double bufferWidth, const LasPointFilter& filter,
+    TileColumns& columns, std::string& error
+  ) const;
+
+private:
+
+  double gridCellSize;
+  std::vector<LasCatalogEntry> catalogEntries;
+};
+
+#endif  // define LAS_CATALOG_H
@@ -0,0 +1,373 @@
+#include "lasCatalog.h"
+#include "lasFile.h"
+#include "tileFiles.h"
+#include "tilePipeline.h"
+#include "tileSegmentation.h"
+#include "tileTables.h"
+
+#include <Rcpp.h>
+#include <cmath>  // for std::floor
+#include <string>
+#include <vector>
+
+
+namespace {
+
+Rcpp::DataFrame createCatalogTable(const LasCatalog& catalog) {
+  const std::vector<LasCatalogEntry>& entries{ catalog.entries() };
+  int numFiles{ static_cast<int>(entries.size()) };
+  Rcpp::CharacterVector files(numFiles);
+  Rcpp::NumericVector numPoints(numFiles);
+  Rcpp::NumericVector minX(numFiles);
+  Rcpp::NumericVector maxX(numFiles);
+  Rcpp::NumericVector minY(numFiles);
+  Rcpp::NumericVector maxY(numFiles);
+  Rcpp::NumericVector minZ(numFiles);
+  Rcpp::NumericVector maxZ(numFiles);
+  Rcpp::NumericVector numRuns(numFiles);
+  for (int file{ 0 }; file < numFiles; file++) {
+    const LasCatalogEntry& entry{ entries[file] };
+    files[file] = entry.path;
+    numPoints[file] = static_cast<double>(entry.numPoints);
+    minX[file] = entry.minX;
+    maxX[file] = entry.maxX;
+    minY[file] = entry.minY;
+    maxY[file] = entry.maxY;
+    minZ[file] = entry.minZ;
+    maxZ[file] = entry.maxZ;
+    numRuns[file] = static_cast<double>(entry.runs.size());
+  }
+
+  Rcpp::DataFrame table{ Rcpp::DataFrame::create(
+    Rcpp::Named("file") = files,
+    Rcpp::Named("numPoints") = numPoints,
+    Rcpp::Named("minX") = minX,
+    Rcpp::Named("maxX") = maxX,
+    Rcpp::Named("minY") = minY,
+    Rcpp::Named("maxY") = maxY,
+    Rcpp::Named("minZ") = minZ,
+    Rcpp::Named("maxZ") = maxZ,
+    Rcpp::Named("numRuns") = numRuns,
+    Rcpp::Named("stringsAsFactors") = false
+  ) };
+  table.attr("cellSize") = catalog.cellSize();
+  return table;
+}
+
+LasPointFilter createFilter(
+    Rcpp::Nullable<Rcpp::IntegerVector> classifications,
+    Rcpp::Nullable<Rcpp::IntegerVector> returnNumbers
+) {
+  LasPointFilter filter;
+  if (classifications.isNotNull()) {
+    filter.classifications = Rcpp::as<std::vector<int> >(classifications);
+  }
+  if (returnNumbers.isNotNull()) {
+    filter.returnNumbers = Rcpp::as<std::vector<int> >(returnNumbers);
+  }
+  return filter;
+}
+
+// Converts plot indices of planLasCatalogTiles to tile keys of the grid
+std::vector<long long> getTileKeys(
+    Rcpp::NumericVector tileIds, const CatalogTileGrid& grid
+) {
+  std::vector<long long> keys(tileIds.size());
+  long long numTiles{ grid.numColumns * grid.numRows };
+  for (R_xlen_t tile{ 0 }; tile < tileIds.size(); tile++) {
+    double id{ tileIds[tile] };
+    if (!(id >= 1.0 && id <= static_cast<double>(numTiles))
+        || id != std::floor(id)) {
+      Rcpp::stop("The tile IDs must be plot indices of the tile grid.");
+    }
+    keys[tile] = static_cast<long long>(id) - 1;
+  }
+  return keys;
+}
+
+}  // namespace
+
+
+//' Build a catalog of LAS files
+//'
+//' Reads every LAS file once, or twice if the extent in its header misses
+//' some of its points, and records the extent and the number of its
+//' points, and for every cell of a coarse grid the ranges of point records
+//' that lie in the cell. With the catalog, the points of a tile and its
+//' buffer are read from only the files that overlap it, and only from the
+//' records near it, so large surveys are planned and tiled without scanning
+//' all files again.
+//'
+//' @param files Character vector with the paths of uncompressed LAS files,
+//'   as for \code{readLasPoints}. The paths are stored as they are given, so
+//'   absolute paths keep the catalog usable from other working directories.
+//' @param catalogFile Character scalar. Path of the catalog file to write.
+//' @param cellSize Numeric scalar. Side length of the grid cells in meters.
+//'   If the core width of the tiles is a multiple of it,
+//'   \code{planLasCatalogTiles} counts the points of the tiles exactly.
+//' @param numThreads Integer scalar. Number of files that are read at the
+//'   same time. Non-positive values use all available cores.
+//'
+//' @return A data.frame with one row per file and the columns \code{file},
+//'   \code{numPoints}, \code{minX}, \code{maxX}, \code{minY}, \code{maxY},
+//'   \code{minZ}, \code{maxZ} (the extent of the points, NA for files without
+//'   points) and \code{numRuns} (the number of record ranges in the grid).
+//'   The attribute \code{cellSize} holds the cell size.
+//'
+//' @details Records of a cell that are at most 256 records apart are stored
+//'   as one range, so files in scan order or in spatial order need few
+//'   ranges and the catalog stays small.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame buildLasCatalog(
+    Rcpp::CharacterVector files, std::string catalogFile,
+    double cellSize = 10, int numThreads = 0
+){
+  LasCatalog catalog{
+    Rcpp::as<std::vector<std::string> >(files), cellSize, numThreads
+  };
+  catalog.save(catalogFile);
+  return createCatalogTable(catalog);
+}
+
+
+//' Read a catalog of LAS files
+//'
+//' @param catalogFile Character scalar. Path of a file of
+//'   \code{buildLasCatalog}.
+//'
+//' @return The data.frame of \code{buildLasCatalog}.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame readLasCatalog(std::string catalogFile){
+  return createCatalogTable(LasCatalog{ catalogFile });
+}
+
+
+//' Plan the buffered tiles of a catalog of LAS files
+//'
+//' Finds the tiles of \code{split_point_cloud_buffered} for the points of all
+//' files of a catalog from the catalog alone, without reading the LAS files.
+//'
+//' @param catalogFile Character scalar. Path of a file of
+//'   \code{buildLasCatalog}.
+//' @param coreWidth Numeric scalar. Width of the core area of the tiles in
+//'   meters.
+//'
+//' @return A data.frame with one row per tile that may contain points and the
+//'   columns \code{tileId} (the plot index of \code{calculate_plot_index}),
+//'   \code{lowerLeftX}, \code{lowerLeftY} (the lower left corner of the core
+//'   area) and \code{numPoints} (the number of points in the core area).
+//'
+//' @details The grid of the tiles is aligned to multiples of
+//'   \code{coreWidth}, like in \code{split_point_cloud_buffered}. The number
+//'   of points of a tile is exact if \code{coreWidth} is a multiple of the
+//'   cell size of the catalog. Otherwise, it is estimated from the share of
+//'   every cell that overlaps the tile, and tiles at the edge of the points
+//'   may turn out to have no points in their core area.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame planLasCatalogTiles(std::string catalogFile, double coreWidth){
+  if (!(coreWidth > 0.0)) {
+    Rcpp::stop("coreWidth must be positive.");
+  }
+  LasCatalog catalog{ catalogFile };
+  std::vector<CatalogTile> tiles{
+    catalog.planTiles(catalog.tileGrid(coreWidth))
+  };
+
+  int numTiles{ static_cast<int>(tiles.size()) };
+  Rcpp::NumericVector tileIds(numTiles);
+  Rcpp::NumericVector lowerLeftX(numTiles);
+  Rcpp::NumericVector lowerLeftY(numTiles);
+  Rcpp::NumericVector numPoints(numTiles);
+  for (int tile{ 0 }; tile < numTiles; tile++) {
+    tileIds[tile] = static_cast<double>(tiles[tile].key + 1);
+    lowerLeftX[tile] = tiles[tile].lowerLeftX;
+    lowerLeftY[tile] = tiles[tile].lowerLeftY;
+    numPoints[tile] = tiles[tile].numPoints;
+  }
+  return Rcpp::DataFrame::create(
+    Rcpp::Named("tileId") = tileIds,
+    Rcpp::Named("lowerLeftX") = lowerLeftX,
+    Rcpp::Named("lowerLeftY") = lowerLeftY,
+    Rcpp::Named("numPoints") = numPoints
+  );
+}
+
+
+//' Read a buffered tile from a catalog of LAS files
+//'
+//' @param catalogFile Character scalar. Path of a file of
+//'   \code{buildLasCatalog}.
+//' @param tileId Numeric scalar. The plot index of the tile, e.g. from
+//'   \code{planLasCatalogTiles}.
+//' @param coreWidth Numeric scalar. Width of the core area of the tiles in
+//'   meters.
+//' @param bufferWidth Numeric scalar. Width of the buffer around the core
+//'   area in meters.
+//' @param classifications NULL or an integer vector. If given, only points
+//'   with one of these classifications are read.
+//' @param returnNumbers NULL or an integer vector. If given, only points
+//'   with one of these return numbers are read.
+//'
+//' @return A data.frame with the columns X, Y, Z and Buffer (1 for buffer
+//'   points, 0 otherwise) that holds the same points in the same order as
+//'   the tile of \code{split_point_cloud_buffered} for the points of all
+//'   files.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame readLasCatalogTile(
+    std::string catalogFile, double tileId, double coreWidth,
+    double bufferWidth,
+    Rcpp::Nullable<Rcpp::IntegerVector> classifications = R_NilValue,
+    Rcpp::Nullable<Rcpp::IntegerVector> returnNumbers = R_NilValue
+){
+  if (!(coreWidth > 0.0)) {
+    Rcpp::stop("coreWidth must be positive.");
+  }
+  LasCatalog catalog{ catalogFile };
+  CatalogTileGrid grid{ catalog.tileGrid(coreWidth) };
+  std::vector<long long> keys{
+    getTileKeys(Rcpp::NumericVector::create(tileId), grid)
+  };
+
+  TileColumns columns;
+  std::string error;
+  if (!catalog.readTile(grid, keys.front(), bufferWidth,
+                        createFilter(classifications, returnNumbers),
+                        columns, error)) {
+    Rcpp::stop(error);
+  }
+
+  return Rcpp::DataFrame::create(
+    Rcpp::Named("X") = columns.pointsX,
+    Rcpp::Named("Y") = columns.pointsY,
+    Rcpp::Named("Z") = columns.pointsZ,
+    Rcpp::Named("Buffer") = columns.buffer
+  );
+}
+
+
+//' Tree crown segmentation of the tiles of a catalog of LAS files
+//'
+//' Segments the buffered tiles of a catalog of LAS files like
+//' \code{segmentTileFiles}, but the reader threads read every tile and its
+//' buffer directly from the records of the LAS files that the catalog finds
+//' near it, instead of from tile files that were split beforehand.
+//'
+//' @param catalogFile Character scalar. Path of a file of
+//'   \code{buildLasCatalog}.
+//' @param tileIds Numeric vector with the plot indices of the tiles to
+//'   segment, e.g. from \code{planLasCatalogTiles}.
+//' @param outputFiles Character vector with one output path per tile.
+//'   The files get the columns X, Y, Z, modeX, modeY, modeZ and crown_id.
+//' @param coreWidth Numeric scalar. Width of the core area of the tiles in
+//'   meters.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param minNumNeighborsPerCore Integer scalar. The minimum number of
+//'   neighbors that a mode needs to have in order to be considered as a core
+//'   mode by DBSCAN.
+//' @param neighborhoodRadius Numeric scalar. The radius of the neighborhood of
+//'   a mode in DBSCAN.
+//' @param maxNumCentroidsPerMode Integer scalar. Maximum number of
+//'   iterations, i.e. steps that the kernel can move for each point.
+//' @param maxNumNeighbors Integer scalar. If positive, kernels with more
+//'   neighbors than this only use a deterministic subsample of them.
+//' @param minHeight Numeric scalar. Points below this height are ignored.
+//' @param bufferWidth Numeric scalar. Width of the buffer around the core
+//'   area of the tiles in meters.
+//' @param seedBufferWidth Numeric scalar. Width of the part of the buffer
+//'   whose points get their own modes. Negative values use the largest crown
+//'   radius of every tile, capped at \code{bufferWidth}.
+//' @param classifications NULL or an integer vector. If given, only points
+//'   with one of these classifications are segmented.
+//' @param returnNumbers NULL or an integer vector. If given, only points
+//'   with one of these return numbers are segmented.
+//' @param numReaders Integer scalar. Number of threads that read tiles.
+//' @param numSegmenters Integer scalar. Number of threads that segment tiles.
+//'   Non-positive values use all available cores.
+//' @param numWriters Integer scalar. Number of threads that write files.
+//' @param queueCapacity Integer scalar. Number of tiles that may wait between
+//'   reading and segmenting and between segmenting and writing.
+//'
+//' @return The data.frame of \code{segmentTileFiles}.
+//'
+//' @details Every tile is segmented exactly like the same tile of
+//'   \code{split_point_cloud_buffered} for the points of all files that pass
+//'   the filters.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame segmentLasCatalog(
+    std::string catalogFile, Rcpp::NumericVector tileIds,
+    Rcpp::CharacterVector outputFiles, double coreWidth,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int minNumNeighborsPerCore, double neighborhoodRadius,
+    int maxNumCentroidsPerMode = 200, int maxNumNeighbors = 0,
+    double minHeight = 2, double bufferWidth = 10, double seedBufferWidth = -1,
+    Rcpp::Nullable<Rcpp::IntegerVector> classifications = R_NilValue,
+    Rcpp::Nullable<Rcpp::IntegerVector> returnNumbers = R_NilValue,
+    int numReaders = 1, int numSegmenters = 0, int numWriters = 1,
+    int queueCapacity = 4
+){
+  if (tileIds.size() != outputFiles.size()) {
+    Rcpp::stop("tileIds and outputFiles must have the same length.");
+  }
+  if (!(coreWidth > 0.0)) {
+    Rcpp::stop("coreWidth must be positive.");
+  }
+  if (neighborhoodRadius <= 0.0) {
+    Rcpp::stop("neighborhoodRadius must be positive.");
+  }
+
+  TileSegmentationParameters parameters;
+  parameters.crownDiameter2TreeHeight = crownDiameter2TreeHeight;
+  parameters.crownHeight2TreeHeight = crownHeight2TreeHeight;
+  parameters.maxNumCentroidsPerMode = maxNumCentroidsPerMode;
+  parameters.maxNumNeighbors = maxNumNeighbors;
+  parameters.minNumNeighborsPerCore = minNumNeighborsPerCore;
+  parameters.neighborhoodRadius = neighborhoodRadius;
+  parameters.minHeight = minHeight;
+  parameters.bufferWidth = bufferWidth;
+  parameters.seedBufferWidth = seedBufferWidth;
+
+  TilePipelineSettings settings;
+  settings.numReaders = numReaders;
+  settings.numSegmenters = numSegmenters;
+  settings.numWriters = numWriters;
+  settings.queueCapacity = queueCapacity;
+
+  LasCatalog catalog{ catalogFile };
+  CatalogTileGrid grid{ catalog.tileGrid(coreWidth) };
+  std::vector<long long> keys{ getTileKeys(tileIds, grid) };
+  LasPointFilter filter{ createFilter(classifications, returnNumbers) };
+  TileReader tileReader{
+    [&](int tile, TileColumns& columns, std::string& error) {
+      return catalog.readTile(
+        grid, keys[tile], bufferWidth, filter, columns, error
+      );
+    }
+  };
+
+  std::vector<std::string> outputPaths{
+    Rcpp::as<std::vector<std::string> >(outputFiles)
+  };
+  TilePipelineStatistics statistics{ runTilePipeline(
+    static_cast<int>(keys.size()), tileReader, outputPaths, parameters,
+    settings
+  ) };
+  if (!statistics.errors.empty()) {
+    Rcpp::stop(statistics.errors.front());
+  }
+
+  return createPipelineStageTable(statistics);
+}
@@ -0,0 +1,370 @@
+#include "lasCrownWriter.h"
+
+#include "binaryIo.h"
+
+#include <algorithm>  // for std::sort, std::min
+#include <cstring>    // for std::memcpy, std::strncpy
+#include <limits>
+#include <numeric>    // for std::iota
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+// Sizes of the parts of a LAS file
+const int VLR_HEADER_SIZE{ 54 };
+const int EXTRA_BYTES_DESCRIPTOR_SIZE{ 192 };
+
+// Data types of extra bytes
+const unsigned char EXTRA_BYTES_UNDOCUMENTED{ 0 };
+const unsigned char EXTRA_BYTES_INT32{ 6 };
+const unsigned char EXTRA_BYTES_DOUBLE{ 10 };
+
+// Number of point records that are copied at a time
+const std::uint64_t RECORDS_PER_BLOCK{ 65536 };
+
+// Appends the description of one extra bytes attribute
+void appendDescriptor(
+    std::vector<unsigned char>& bytes, const unsigned char dataType,
+    const char* name, const char* description
+) {
+  std::size_t start{ bytes.size() };
+  bytes.resize(start + EXTRA_BYTES_DESCRIPTOR_SIZE, 0);
+  bytes[start + 2] = dataType;
+  std::strncpy(reinterpret_cast<char*>(&bytes[start + 4]), name, 31);
+  std::strncpy(reinterpret_cast<char*>(&bytes[start + 160]), description, 31);
+}
+
+// Number of bytes of the records that the extra bytes descriptors of a VLR
+// describe
+std::size_t numDescribedBytes(const unsigned char* descriptors,
+                              const std::size_t numDescriptorBytes) {
+  const std::size_t SIZES[11]{ 0, 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+  std::size_t numBytes{ 0 };
+  for (std::size_t start{ 0 };
+       start + EXTRA_BYTES_DESCRIPTOR_SIZE <= numDescriptorBytes;
+       start += EXTRA_BYTES_DESCRIPTOR_SIZE) {
+    int dataType{ descriptors[start + 2] };
+    if (dataType == EXTRA_BYTES_UNDOCUMENTED) {
+      numBytes += descriptors[start + 3];
+    } else if (dataType <= 10) {
+      numBytes += SIZES[dataType];
+    } else if (dataType <= 30) {
+      // Deprecated arrays of two or three values
+      numBytes += (dataType <= 20 ? 2 : 3) * SIZES[(dataType - 1) % 10 + 1];
+    }
+  }
+  return numBytes;
+}
+
+// Appends descriptors for extra bytes of unknown meaning, so that the
+// attributes after them are found at the right place
+void appendUndocumentedDescriptors(std::vector<unsigned char>& bytes,
+                                   std::size_t numBytes) {
+  while (numBytes > 0) {
+    std::size_t numDescribed{ std::min<std::size_t>(numBytes, 255) };
+    std::size_t start{ bytes.size() };
+    appendDescriptor(bytes, EXTRA_BYTES_UNDOCUMENTED, "unknown", "");
+    bytes[start + 3] = static_cast<unsigned char>(numDescribed);
+    numBytes -= numDescribed;
+  }
+}
+
+// Appends the header of a variable length record
+void appendVlrHeader(
+    std::vector<unsigned char>& bytes, const char* userId,
+    const std::uint16_t recordId, const std::uint16_t recordLength,
+    const char* description
+) {
+  std::size_t start{ bytes.size() };
+  bytes.resize(start + VLR_HEADER_SIZE, 0);
+  std::strncpy(reinterpret_cast<char*>(&bytes[start + 2]), userId, 16);
+  writeValue<std::uint16_t>(bytes, start + 18, recordId);
+  writeValue<std::uint16_t>(bytes, start + 20, recordLength);
+  std::strncpy(reinterpret_cast<char*>(&bytes[start + 22]), description, 31);
+}
+
+}  // namespace
+
+
+LasCrownWriter::LasCrownWriter(
+    const std::string& sourcePath, const std::string& outputPath,
+    const bool withModes
+) : source(sourcePath), mapping(nullptr), mappingSize(0), isOpen(false),
+    withModes(withModes) {
+  const LasHeader& header{ source.header() };
+  const unsigned char* bytes{ source.data() };
+
+  std::vector<unsigned char> descriptors;
+  appendDescriptor(descriptors, EXTRA_BYTES_INT32, "crown_id",
+                   "Tree crown, 0 for none");
+  if (withModes) {
+    appendDescriptor(descriptors, EXTRA_BYTES_DOUBLE, "modeX", "Mode X");
+    appendDescriptor(descriptors, EXTRA_BYTES_DOUBLE, "modeY", "Mode Y");
+    appendDescriptor(descriptors, EXTRA_BYTES_DOUBLE, "modeZ", "Mode Z");
+  }
+  std::size_t numSourceExtraBytes{
+    static_cast<std::size_t>(source.numExtraBytes())
+  };
+  int numExtraBytes{ withModes ? 28 : 4 };
+  extraBytesOffset = header.pointRecordLength;
+  recordLength = header.pointRecordLength + numExtraBytes;
+  if (recordLength > std::numeric_limits<std::uint16_t>::max()) {
+    throw std::runtime_error(sourcePath + " has too long point records.");
+  }
+
+  // Copy the header and the VLRs, and add the new attributes to the extra
+  // bytes VLR, which lists the attributes in the order of the record
+  std::vector<unsigned char> front(bytes, bytes + header.headerSize);
+  std::uint32_t numVlrs{ readValue<std::uint32_t>(bytes, 100) };
+  std::size_t position{ static_cast<std::size_t>(header.headerSize) };
+  bool hasExtraBytesVlr{ false };
+  for (std::uint32_t vlr{ 0 }; vlr < numVlrs; vlr++) {
+    if (position + VLR_HEADER_SIZE > header.offsetToPointData) {
+      throw std::runtime_error(sourcePath + " has broken VLRs.");
+    }
+    std::string userId(reinterpret_cast<const char*>(bytes + position + 2), 16);
+    userId = userId.substr(0, userId.find('\0'));
+    std::uint16_t recordId{ readValue<std::uint16_t>(bytes, position + 18) };
+    std::size_t length{ readValue<std::uint16_t>(bytes, position + 20) };
+    std::size_t end{ position + VLR_HEADER_SIZE + length };
+    if (end > header.offsetToPointData) {
+      throw std::runtime_error(sourcePath + " has broken VLRs.");
+    }
+
+    std::size_t start{ front.size() };
+    front.insert(front.end(), bytes + position, bytes + end);
+    if (userId == "LASF_Spec" && recordId == 4 && !hasExtraBytesVlr) {
+      std::size_t numDescribed{
+        numDescribedBytes(bytes + position + VLR_HEADER_SIZE, length)
+      };
+      if (numDescribed < numSourceExtraBytes) {
+        appendUndocumentedDescriptors(front, numSourceExtraBytes - numDescribed);
+      }
+      front.insert(front.end(), descriptors.begin(), descriptors.end());
+      std::size_t newLength{ front.size() - start - VLR_HEADER_SIZE };
+      if (newLength > std::numeric_limits<std::uint16_t>::max()) {
+        throw std::runtime_error(sourcePath + " has too many extra bytes.");
+      }
+      writeValue<std::uint16_t>(front, start + 20,
+                                static_cast<std::uint16_t>(newLength));
+      hasExtraBytesVlr = true;
+    }
+    position = end;
+  }
+  if (!hasExtraBytesVlr) {
+    std::vector<unsigned char> allDescriptors;
+    appendUndocumentedDescriptors(allDescriptors, numSourceExtraBytes);
+    allDescriptors.insert(allDescriptors.end(), descriptors.begin(),
+                          descriptors.end());
+    appendVlrHeader(front, "LASF_Spec", 4,
+                    static_cast<std::uint16_t>(allDescriptors.size()),
+                    "Extra bytes");
+    front.insert(front.end(), allDescriptors.begin(), allDescriptors.end());
+    numVlrs++;
+  }
+  // Keep any bytes between the VLRs and the points
+  front.insert(front.end(), bytes + position, bytes + header.offsetToPointData);
+
+  offsetToPointData = front.size();
+  if (offsetToPointData > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error(sourcePath + " has too large VLRs.");
+  }
+  writeValue<std::uint32_t>(front, 96, static_cast<std::uint32_t>(offsetToPointData));
+  writeValue<std::uint32_t>(front, 100, numVlrs);
+  writeValue<std::uint16_t>(front, 105, static_cast<std::uint16_t>(recordLength));
+
+  // The waveform data (LAS 1.3) and the extended VLRs (LAS 1.4) follow the
+  // points and move with their end
+  std::uint64_t sourcePointsEnd{
+    header.offsetToPointData + header.numPoints * header.pointRecordLength
+  };
+  std::uint64_t pointsEnd{ offsetToPointData + header.numPoints * recordLength };
+  const std::size_t tailOffsets[2]{ 227, 235 };
+  for (std::size_t offset : tailOffsets) {
+    if (offset + 8 <= static_cast<std::size_t>(header.headerSize)) {
+      std::uint64_t start{ readValue<std::uint64_t>(bytes, offset) };
+      if (start >= sourcePointsEnd) {
+        writeValue<std::uint64_t>(front, offset, start - sourcePointsEnd + pointsEnd);
+      }
+    }
+  }
+
+  output.open(outputPath, std::ios::in | std::ios::out | std::ios::binary
+                | std::ios::trunc);
+  if (!output) {
+    throw std::runtime_error("Cannot write the file " + outputPath + ".");
+  }
+  output.write(reinterpret_cast<const char*>(front.data()), front.size());
+
+  // Copy the point records block by block with empty attributes
+  std::vector<unsigned char> emptyAttributes(numExtraBytes, 0);
+  if (withModes) {
+    double noMode{ std::numeric_limits<double>::quiet_NaN() };
+    for (int coordinate{ 0 }; coordinate < 3; coordinate++) {
+      std::memcpy(&emptyAttributes[4 + 8 * coordinate], &noMode, sizeof(double));
+    }
+  }
+  std::vector<unsigned char> block;
+  for (std::uint64_t first{ 0 }; first < header.numPoints;
+       first += RECORDS_PER_BLOCK) {
+    std::uint64_t last{ std::min(header.numPoints, first + RECORDS_PER_BLOCK) };
+    block.resize((last - first) * recordLength);
+    for (std::uint64_t i{ first }; i < last; i++) {
+      unsigned char* record{ &block[(i - first) * recordLength] };
+      std::memcpy(record, source.record(i), header.pointRecordLength);
+      std::memcpy(record + extraBytesOffset, emptyAttributes.data(), numExtraBytes);
+    }
+    output.write(reinterpret_cast<const char*>(block.data()), block.size());
+  }
+
+  output.write(reinterpret_cast<const char*>(bytes + sourcePointsEnd),
+               source.size() - sourcePointsEnd);
+  if (!output) {
+    throw std::runtime_error("Cannot write the file " + outputPath + ".");
+  }
+  isOpen = true;
+
+#ifndef _WIN32
+  // Map the copy, so that the attributes are written without any seeks
+  output.close();
+  if (output.fail()) {
+    throw std::runtime_error("Cannot write the file " + outputPath + ".");
+  }
+  int descriptor{ ::open(outputPath.c_str(), O_RDWR) };
+  if (descriptor < 0) {
+    throw std::runtime_error("Cannot open the file " + outputPath + ".");
+  }
+  mappingSize = static_cast<std::size_t>(pointsEnd);
+  if (mappingSize > 0) {
+    void* mapped{ mmap(
+      nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0
+    ) };
+    if (mapped == MAP_FAILED) {
+      ::close(descriptor);
+      throw std::runtime_error("Cannot map the file " + outputPath + ".");
+    }
+    mapping = static_cast<unsigned char*>(mapped);
+  }
+  ::close(descriptor);
+#endif
+}
+
+
+LasCrownWriter::~LasCrownWriter() {
+  // Destructors must not throw, and the mapped records are written anyway
+  unmap();
+}
+
+
+void LasCrownWriter::write(
+    const std::vector<std::uint64_t>& pointIndices,
+    const std::vector<int>& crownIds,
+    const double* modesX, const double* modesY, const double* modesZ
+) {
+  if (!isOpen) {
+    throw std::runtime_error("The LAS file is already closed.");
+  }
+  if (crownIds.size() != pointIndices.size()) {
+    throw std::runtime_error("Every point index needs one crown ID.");
+  }
+  for (std::uint64_t pointIndex : pointIndices) {
+    if (pointIndex >= numPoints()) {
+      throw std::runtime_error("A point index lies outside the LAS file.");
+    }
+  }
+
+  // Visit the records in the order of the file
+  std::vector<std::size_t> order(pointIndices.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return pointIndices[a] < pointIndices[b];
+  });
+
+  // Without given modes, the modes in the file are kept
+  bool isWritingModes{ withModes && modesX != nullptr };
+  auto setAttributes = [&](unsigned char* record, const std::size_t i) {
+    std::int32_t crownId{ crownIds[i] };
+    std::memcpy(record + extraBytesOffset, &crownId, 4);
+    if (isWritingModes) {
+      std::memcpy(record + extraBytesOffset + 4, &modesX[i], 8);
+      std::memcpy(record + extraBytesOffset + 12, &modesY[i], 8);
+      std::memcpy(record + extraBytesOffset + 20, &modesZ[i], 8);
+    }
+  };
+
+  if (mapping != nullptr) {
+    unsigned char* points{ mapping + offsetToPointData };
+    for (std::size_t i : order) {
+      setAttributes(points + pointIndices[i] * recordLength, i);
+    }
+    return;
+  }
+
+  // Without a mapping, read, update and write back each run of consecutive
+  // records of at most RECORDS_PER_BLOCK records at once
+  std::vector<unsigned char> block;
+  std::size_t runBegin{ 0 };
+  while (runBegin < order.size()) {
+    std::uint64_t first{ pointIndices[order[runBegin]] };
+    std::size_t runEnd{ runBegin + 1 };
+    while (runEnd < order.size()
+           && pointIndices[order[runEnd]] <= pointIndices[order[runEnd - 1]] + 1
+           && pointIndices[order[runEnd]] < first + RECORDS_PER_BLOCK) {
+      runEnd++;
+    }
+    std::uint64_t last{ pointIndices[order[runEnd - 1]] };
+    block.resize((last - first + 1) * recordLength);
+    std::streamoff position{ static_cast<std::streamoff>(
+      offsetToPointData + first * recordLength
+    ) };
+    output.seekg(position);
+    output.read(reinterpret_cast<char*>(block.data()), block.size());
+    for (std::size_t run{ runBegin }; run < runEnd; run++) {
+      std::size_t i{ order[run] };
+      setAttributes(&block[(pointIndices[i] - first) * recordLength], i);
+    }
+    output.seekp(position);
+    output.write(reinterpret_cast<const char*>(block.data()), block.size());
+    runBegin = runEnd;
+  }
+  if (!output) {
+    throw std::runtime_error("Cannot write to the LAS file.");
+  }
+}
+
+
+bool LasCrownWriter::unmap() {
+#ifndef _WIN32
+  if (mapping != nullptr) {
+    bool isSynced{ msync(mapping, mappingSize, MS_SYNC) == 0 };
+    bool isUnmapped{ munmap(mapping, mappingSize) == 0 };
+    mapping = nullptr;
+    return isSynced && isUnmapped;
+  }
+#endif
+  return true;
+}
+
+
+void LasCrownWriter::close() {
+  if (!isOpen) {
+    return;
+  }
+  isOpen = false;
+  bool isUnmapped{ unmap() };
+  if (output.is_open()) {
+    output.close();
+  }
+  if (!isUnmapped || output.fail()) {
+    throw std::runtime_error("Cannot write to the LAS file.");
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef LAS_CROWN_WRITER_H
+#define LAS_CROWN_WRITER_H
+
+#include "lasFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+/** Writes a copy of a LAS file whose point records have the extra bytes
+ *  attribute crown_id (int32) and, optionally, modeX, modeY and modeZ
+ *  (double).
+ *
+ *  The constructor copies the header, the variable length records and the
+ *  point records of the source file verbatim, appends the descriptions of
+ *  the new attributes to the extra bytes VLR and gives every point the crown
+ *  ID 0 and NaN modes. write then fills in the attributes of the points of
+ *  one tile at a time, so only the results of one tile are held in memory.
+ *  On POSIX systems the copied file is then memory-mapped shared, so write
+ *  copies the attributes into the mapped records. Elsewhere, write reads and
+ *  writes each run of consecutive records at once. Errors throw
+ *  std::runtime_error.
+ */
+class LasCrownWriter {
+public:
+
+  LasCrownWriter(
+    const std::string& sourcePath, const std::string& outputPath,
+    const bool withModes
+  );
+  ~LasCrownWriter();
+
+  LasCrownWriter(const LasCrownWriter&) = delete;
+  LasCrownWriter& operator=(const LasCrownWriter&) = delete;
+
+  /** Sets the attributes of the points with the 0-based positions
+   *  \p pointIndices in the source file. \p modesX, \p modesY and \p modesZ
+   *  are ignored without modes and may be null otherwise.
+   */
+  void write(
+    const std::vector<std::uint64_t>& pointIndices,
+    const std::vector<int>& crownIds,
+    const double* modesX, const double* modesY, const double* modesZ
+  );
+
+  /** Flushes, unmaps and closes the output file. */
+  void close();
+
+  std::uint64_t numPoints() const { return source.header().numPoints; }
+  bool hasModes() const { return withModes; }
+
+private:
+
+  /** Unmaps the output file if it is mapped. Returns false on failure. */
+  bool unmap();
+
+  LasFile source;
+  std::fstream output;
+  unsigned char* mapping;
+  std::size_t mappingSize;
+  bool isOpen;
+  bool withModes;
+  std::uint64_t offsetToPointData;
+  int recordLength;
+  int extraBytesOffset;
+};
+
+#endif  // define LAS_CROWN_WRITER_H
@@ -0,0 +1,197 @@
+#include "lasFile.h"
+
+#include "binaryIo.h"
+
+#include <algorithm>  // for std::find
+#include <fstream>
+#include <iterator>   // for std::istreambuf_iterator
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+// The smallest record length of every point data format
+const int MIN_RECORD_LENGTHS[11]{
+  20, 28, 26, 34, 57, 63, 30, 36, 38, 59, 67
+};
+
+}  // namespace
+
+
+MappedFile::MappedFile(const std::string& path)
+  : bytes(nullptr), numBytes(0), isMapped(false) {
+#ifndef _WIN32
+  int descriptor{ open(path.c_str(), O_RDONLY) };
+  if (descriptor < 0) {
+    throw std::runtime_error("Cannot open the file " + path + ".");
+  }
+  struct stat status;
+  if (fstat(descriptor, &status) != 0) {
+    close(descriptor);
+    throw std::runtime_error("Cannot open the file " + path + ".");
+  }
+  numBytes = static_cast<std::size_t>(status.st_size);
+  if (numBytes > 0) {
+    void* mapping{ mmap(nullptr, numBytes, PROT_READ, MAP_PRIVATE, descriptor, 0) };
+    if (mapping == MAP_FAILED) {
+      close(descriptor);
+      throw std::runtime_error("Cannot map the file " + path + ".");
+    }
+    bytes = static_cast<const unsigned char*>(mapping);
+    isMapped = true;
+  }
+  close(descriptor);
+#else
+  std::ifstream stream{ path, std::ios::binary };
+  if (!stream) {
+    throw std::runtime_error("Cannot open the file " + path + ".");
+  }
+  buffer.assign(
+    std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()
+  );
+  bytes = buffer.data();
+  numBytes = buffer.size();
+#endif
+}
+
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (isMapped) {
+    munmap(const_cast<unsigned char*>(bytes), numBytes);
+  }
+#endif
+}
+
+
+LasPointFilter::LasPointFilter()
+  : minX(-std::numeric_limits<double>::infinity()),
+    maxX(std::numeric_limits<double>::infinity()),
+    minY(-std::numeric_limits<double>::infinity()),
+    maxY(std::numeric_limits<double>::infinity()),
+    minZ(-std::numeric_limits<double>::infinity()) {}
+
+
+LasFile::LasFile(const std::string& path) : file(path), points(nullptr) {
+  const unsigned char* bytes{ file.data() };
+  if (file.size() < 227 || std::string(bytes, bytes + 4) != "LASF") {
+    throw std::runtime_error(path + " is not a LAS file.");
+  }
+
+  lasHeader.versionMajor = readValue<std::uint8_t>(bytes, 24);
+  lasHeader.versionMinor = readValue<std::uint8_t>(bytes, 25);
+  lasHeader.headerSize = readValue<std::uint16_t>(bytes, 94);
+  lasHeader.offsetToPointData = readValue<std::uint32_t>(bytes, 96);
+  int formatByte{ readValue<std::uint8_t>(bytes, 104) };
+  lasHeader.pointRecordLength = readValue<std::uint16_t>(bytes, 105);
+  lasHeader.numPoints = readValue<std::uint32_t>(bytes, 107);
+  lasHeader.scaleX = readValue<double>(bytes, 131);
+  lasHeader.scaleY = readValue<double>(bytes, 139);
+  lasHeader.scaleZ = readValue<double>(bytes, 147);
+  lasHeader.offsetX = readValue<double>(bytes, 155);
+  lasHeader.offsetY = readValue<double>(bytes, 163);
+  lasHeader.offsetZ = readValue<double>(bytes, 171);
+  lasHeader.maxX = readValue<double>(bytes, 179);
+  lasHeader.minX = readValue<double>(bytes, 187);
+  lasHeader.maxY = readValue<double>(bytes, 195);
+  lasHeader.minY = readValue<double>(bytes, 203);
+  lasHeader.maxZ = readValue<double>(bytes, 211);
+  lasHeader.minZ = readValue<double>(bytes, 219);
+
+  if (lasHeader.versionMajor != 1
+      || lasHeader.versionMinor < 2 || lasHeader.versionMinor > 4) {
+    throw std::runtime_error(path + " is not a LAS file of version 1.2 to 1.4.");
+  }
+
+  // LAS 1.4 counts the points with 64 bits
+  if (lasHeader.versionMinor == 4 && lasHeader.headerSize >= 375
+      && file.size() >= 255) {
+    std::uint64_t numPoints{ readValue<std::uint64_t>(bytes, 247) };
+    if (numPoints > 0) {
+      lasHeader.numPoints = numPoints;
+    }
+  }
+
+  // The two highest bits of the format mark compressed points
+  if (formatByte & 0xC0) {
+    throw std::runtime_error(path + " has compressed points (LAZ).");
+  }
+  lasHeader.pointDataFormat = formatByte;
+  if (lasHeader.pointDataFormat > 10) {
+    throw std::runtime_error(path + " has an unknown point data format.");
+  }
+  if (lasHeader.pointRecordLength
+      < MIN_RECORD_LENGTHS[lasHeader.pointDataFormat]) {
+    throw std::runtime_error(path + " has too short point records.");
+  }
+  if (lasHeader.offsetToPointData
+      + lasHeader.numPoints * lasHeader.pointRecordLength > file.size()) {
+    throw std::runtime_error(path + " is truncated.");
+  }
+
+  points = bytes + lasHeader.offsetToPointData;
+}
+
+
+int LasFile::numExtraBytes() const {
+  return lasHeader.pointRecordLength
+    - MIN_RECORD_LENGTHS[lasHeader.pointDataFormat];
+}
+
+
+int LasFile::classification(const std::uint64_t i) const {
+  // The formats 6 to 10 have a whole byte for the classification, the older
+  // formats share it with three flags
+  if (lasHeader.pointDataFormat >= 6) {
+    return readValue<std::uint8_t>(record(i), 16);
+  }
+  return readValue<std::uint8_t>(record(i), 15) & 0x1F;
+}
+
+
+int LasFile::returnNumber(const std::uint64_t i) const {
+  if (lasHeader.pointDataFormat >= 6) {
+    return readValue<std::uint8_t>(record(i), 14) & 0x0F;
+  }
+  return readValue<std::uint8_t>(record(i), 14) & 0x07;
+}
+
+
+void LasFile::coordinates(
+    const std::uint64_t i, double& x, double& y, double& z
+) const {
+  const unsigned char* bytes{ record(i) };
+  x = readValue<std::int32_t>(bytes, 0) * lasHeader.scaleX + lasHeader.offsetX;
+  y = readValue<std::int32_t>(bytes, 4) * lasHeader.scaleY + lasHeader.offsetY;
+  z = readValue<std::int32_t>(bytes, 8) * lasHeader.scaleZ + lasHeader.offsetZ;
+}
+
+
+bool LasFile::isKept(const std::uint64_t i, const LasPointFilter& filter) const {
+  if (!filter.classifications.empty()
+      && std::find(filter.classifications.begin(), filter.classifications.end(),
+                   classification(i)) == filter.classifications.end()) {
+    return false;
+  }
+  if (!filter.returnNumbers.empty()
+      && std::find(filter.returnNumbers.begin(), filter.returnNumbers.end(),
+                   returnNumber(i)) == filter.returnNumbers.end()) {
+    return false;
+  }
+  double x;
+  double y;
+  double z;
+  coordinates(i, x, y, z);
+  return filter.minX <= x && x <= filter.maxX
+    && filter.minY <= y && y <= filter.maxY
+    && filter.minZ <= z;
+}
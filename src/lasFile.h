@@ -0,0 +1,121 @@
+#ifndef LAS_FILE_H
+#define LAS_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/** A read-only view of the bytes of a file. On POSIX systems the file is
+ *  memory-mapped, so only the pages that are accessed are read from disk.
+ *  Elsewhere, the file is read into memory.
+ */
+class MappedFile {
+public:
+
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const unsigned char* data() const { return bytes; }
+  std::size_t size() const { return numBytes; }
+
+private:
+
+  const unsigned char* bytes;
+  std::size_t numBytes;
+  bool isMapped;
+  std::vector<unsigned char> buffer;
+};
+
+
+/** The fields of the public header block of a LAS file that are needed to
+ *  decode its points.
+ */
+struct LasHeader {
+  int versionMajor;
+  int versionMinor;
+  int headerSize;
+  int pointDataFormat;
+  int pointRecordLength;
+  std::uint64_t offsetToPointData;
+  std::uint64_t numPoints;
+  double scaleX;
+  double scaleY;
+  double scaleZ;
+  double offsetX;
+  double offsetY;
+  double offsetZ;
+  double minX;
+  double maxX;
+  double minY;
+  double maxY;
+  double minZ;
+  double maxZ;
+};
+
+
+/** The conditions that points need to fulfil to be read. Empty vectors and
+ *  infinite bounds do not exclude any points.
+ */
+struct LasPointFilter {
+  std::vector<int> classifications;
+  std::vector<int> returnNumbers;
+  double minX;
+  double maxX;
+  double minY;
+  double maxY;
+  double minZ;
+
+  LasPointFilter();
+};
+
+
+/** A memory-mapped LAS file of version 1.2 to 1.4 with uncompressed points
+ *  of the point data formats 0 to 10.
+ *
+ *  The points are decoded directly from the mapped records, so excluded
+ *  points and unused attributes are never copied. The constructor throws
+ *  std::runtime_error for files that cannot be read. The member functions
+ *  do not call the R API and can be used from several threads.
+ */
+class LasFile {
+public:
+
+  explicit LasFile(const std::string& path);
+
+  const LasHeader& header() const { return lasHeader; }
+
+  /** The bytes of the record of point \p i. */
+  const unsigned char* record(const std::uint64_t i) const {
+    return points + i * lasHeader.pointRecordLength;
+  }
+
+  /** The bytes of the whole file, starting with the header. */
+  const unsigned char* data() const { return file.data(); }
+  std::size_t size() const { return file.size(); }
+
+  /** The number of bytes at the end of every record that do not belong to
+   *  the attributes of the point data format.
+   */
+  int numExtraBytes() const;
+
+  int classification(const std::uint64_t i) const;
+  int returnNumber(const std::uint64_t i) const;
+  void coordinates(
+    const std::uint64_t i, double& x, double& y, double& z
+  ) const;
+
+  bool isKept(const std::uint64_t i, const LasPointFilter& filter) const;
+
+private:
+
+  MappedFile file;
+  LasHeader lasHeader;
+  const unsigned char* points;
+};
+
+#endif  // define LAS_FILE_H
@@ -0,0 +1,339 @@
+#include "mappedColumns.h"
+
+#include "lasFile.h"
+#include "pointColumns.h"
+
+#include <Rcpp.h>
+#include <R_ext/Altrep.h>
+#include <algorithm>  // for std::min
+#include <climits>    // for INT_MAX
+#include <cstdint>
+#include <cstring>    // for std::memcpy
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+/** The values of an ALTREP vector in a mapped column file. */
+struct MappedVector {
+  std::shared_ptr<ColumnFile> file;
+  unsigned char* data;
+  R_xlen_t length;
+};
+
+R_altrep_class_t mappedRealClass;
+R_altrep_class_t mappedIntegerClass;
+
+MappedVector* getMappedVector(SEXP vector) {
+  return static_cast<MappedVector*>(R_ExternalPtrAddr(R_altrep_data1(vector)));
+}
+
+void finalizeMappedVector(SEXP pointer) {
+  delete static_cast<MappedVector*>(R_ExternalPtrAddr(pointer));
+  R_ClearExternalPtr(pointer);
+}
+
+R_xlen_t mappedLength(SEXP vector) {
+  return getMappedVector(vector)->length;
+}
+
+Rboolean mappedInspect(
+    SEXP vector, int, int, int, void (*)(SEXP, int, int, int)
+) {
+  MappedVector* mapped{ getMappedVector(vector) };
+  Rprintf(
+    " mapped column of %s (%.0f values)\n", mapped->file->path().c_str(),
+    static_cast<double>(mapped->length)
+  );
+  return TRUE;
+}
+
+// Rcpp always asks for a writeable pointer. The vectors are marked as not
+// mutable, so R duplicates them before it modifies them, which matters for
+// created files, whose values are mapped shared with the file.
+void* mappedDataptr(SEXP vector, Rboolean) {
+  return getMappedVector(vector)->data;
+}
+
+const void* mappedDataptrOrNull(SEXP vector) {
+  return getMappedVector(vector)->data;
+}
+
+template <typename T>
+T mappedElt(SEXP vector, R_xlen_t i) {
+  return reinterpret_cast<const T*>(getMappedVector(vector)->data)[i];
+}
+
+template <typename T>
+R_xlen_t mappedGetRegion(SEXP vector, R_xlen_t start, R_xlen_t size, T* buffer) {
+  MappedVector* mapped{ getMappedVector(vector) };
+  R_xlen_t numValues{ std::min(size, mapped->length - start) };
+  if (numValues > 0) {
+    std::memcpy(
+      buffer, mapped->data + start * sizeof(T), numValues * sizeof(T)
+    );
+  }
+  return numValues < 0 ? 0 : numValues;
+}
+
+std::shared_ptr<ColumnFile> openColumnFile(const std::string& file) {
+  return std::make_shared<ColumnFile>(file);
+}
+
+}  // namespace
+
+
+// [[Rcpp::init]]
+void registerMappedVectorClasses(DllInfo* dll){
+  mappedRealClass = R_make_altreal_class("mapped_real", "meanshiftr", dll);
+  R_set_altrep_Length_method(mappedRealClass, mappedLength);
+  R_set_altrep_Inspect_method(mappedRealClass, mappedInspect);
+  R_set_altvec_Dataptr_method(mappedRealClass, mappedDataptr);
+  R_set_altvec_Dataptr_or_null_method(mappedRealClass, mappedDataptrOrNull);
+  R_set_altreal_Elt_method(mappedRealClass, mappedElt<double>);
+  R_set_altreal_Get_region_method(mappedRealClass, mappedGetRegion<double>);
+
+  mappedIntegerClass = R_make_altinteger_class("mapped_integer", "meanshiftr", dll);
+  R_set_altrep_Length_method(mappedIntegerClass, mappedLength);
+  R_set_altrep_Inspect_method(mappedIntegerClass, mappedInspect);
+  R_set_altvec_Dataptr_method(mappedIntegerClass, mappedDataptr);
+  R_set_altvec_Dataptr_or_null_method(mappedIntegerClass, mappedDataptrOrNull);
+  R_set_altinteger_Elt_method(mappedIntegerClass, mappedElt<int>);
+  R_set_altinteger_Get_region_method(mappedIntegerClass, mappedGetRegion<int>);
+}
+
+
+SEXP createMappedVector(
+    const std::shared_ptr<ColumnFile>& file, const int firstColumn,
+    const int numColumns
+) {
+  const std::vector<ColumnInfo>& columns{ file->columns() };
+  ColumnType type{ columns[firstColumn].type };
+  for (int column{ firstColumn + 1 }; column < firstColumn + numColumns; column++) {
+    std::uint64_t expectedOffset{
+      columns[column - 1].offset + file->numRows() * sizeof(double)
+    };
+    if (type != ColumnType::real || columns[column].type != type
+        || columns[column].offset != expectedOffset) {
+      Rcpp::stop("Only consecutive columns of doubles can be combined.");
+    }
+  }
+
+  MappedVector* mapped{ new MappedVector{
+    file, file->columnData(firstColumn),
+    static_cast<R_xlen_t>(file->numRows() * numColumns)
+  } };
+  Rcpp::RObject pointer{ R_MakeExternalPtr(mapped, R_NilValue, R_NilValue) };
+  R_RegisterCFinalizerEx(pointer, finalizeMappedVector, TRUE);
+  Rcpp::RObject vector{ R_new_altrep(
+    type == ColumnType::real ? mappedRealClass : mappedIntegerClass, pointer,
+    R_NilValue
+  ) };
+  MARK_NOT_MUTABLE(vector);
+  return vector;
+}
+
+
+Rcpp::List createMappedDataFrame(const std::shared_ptr<ColumnFile>& file) {
+  const std::vector<ColumnInfo>& columns{ file->columns() };
+  int numColumns{ static_cast<int>(columns.size()) };
+  Rcpp::List result(numColumns);
+  Rcpp::CharacterVector names(numColumns);
+  for (int column{ 0 }; column < numColumns; column++) {
+    result[column] = createMappedVector(file, column);
+    names[column] = columns[column].name;
+  }
+  result.attr("names") = names;
+  return createColumnTable(result, static_cast<R_xlen_t>(file->numRows()));
+}
+
+
+//' Write columns to a column file
+//'
+//' Stores numeric and integer vectors of equal length in a binary column
+//' file, whose columns \code{readColumnFile} maps into memory again, so the
+//' mean shift functions can read point clouds that do not fit into memory.
+//'
+//' @param file Character scalar. Path of the column file, which is created
+//'   or overwritten.
+//' @param columns Named list or data.frame of numeric or integer vectors.
+//'   The names must have between 1 and 32 characters.
+//'
+//' @return The data.frame of \code{readColumnFile} for the new file.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List writeColumnFile(std::string file, Rcpp::List columns){
+  int numColumns{ static_cast<int>(columns.size()) };
+  SEXP names{ Rf_getAttrib(columns, R_NamesSymbol) };
+  if (numColumns == 0 || Rf_isNull(names)) {
+    Rcpp::stop("columns must be a named list of vectors.");
+  }
+  std::vector<std::string> columnNames{
+    Rcpp::as<std::vector<std::string> >(names)
+  };
+  std::vector<ColumnType> types;
+  R_xlen_t numRows{ Rf_xlength(columns[0]) };
+  for (int column{ 0 }; column < numColumns; column++) {
+    SEXP values{ columns[column] };
+    if (TYPEOF(values) != REALSXP && TYPEOF(values) != INTSXP) {
+      Rcpp::stop("All columns must be numeric or integer vectors.");
+    }
+    if (Rf_xlength(values) != numRows) {
+      Rcpp::stop("All columns must have the same length.");
+    }
+    types.push_back(TYPEOF(values) == REALSXP ? ColumnType::real : ColumnType::integer);
+  }
+
+  std::shared_ptr<ColumnFile> columnFile{ std::make_shared<ColumnFile>(
+    file, columnNames, types, static_cast<std::uint64_t>(numRows)
+  ) };
+  for (int column{ 0 }; column < numColumns; column++) {
+    SEXP values{ columns[column] };
+    if (numRows == 0) {
+      continue;
+    }
+    if (types[column] == ColumnType::real) {
+      std::memcpy(
+        columnFile->columnData(column), REAL(values), numRows * sizeof(double)
+      );
+    } else {
+      std::memcpy(
+        columnFile->columnData(column), INTEGER(values), numRows * sizeof(int)
+      );
+    }
+  }
+  columnFile->flush();
+  return createMappedDataFrame(columnFile);
+}
+
+
+//' Write the points of LAS files to a column file
+//'
+//' Decodes the coordinates of the points of uncompressed LAS files straight
+//' into the columns X, Y and Z of a column file, one record after the other,
+//' so point clouds that do not fit into memory can be converted as well.
+//'
+//' @param lasFiles Character vector. Paths of LAS files of version 1.2 to 1.4
+//'   with one of the point data formats 0 to 10.
+//' @param file Character scalar. Path of the column file, which is created
+//'   or overwritten.
+//' @param classifications NULL or an integer vector. If given, only points
+//'   with one of these classifications are written.
+//' @param returnNumbers NULL or an integer vector. If given, only points
+//'   with one of these return numbers are written.
+//'
+//' @return The data.frame of \code{readColumnFile} for the new file, with
+//'   the points of the files in the given order.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List writeLasColumnFile(
+    std::vector<std::string> lasFiles, std::string file,
+    Rcpp::Nullable<Rcpp::IntegerVector> classifications = R_NilValue,
+    Rcpp::Nullable<Rcpp::IntegerVector> returnNumbers = R_NilValue
+){
+  LasPointFilter filter;
+  if (classifications.isNotNull()) {
+    filter.classifications = Rcpp::as<std::vector<int> >(classifications);
+  }
+  if (returnNumbers.isNotNull()) {
+    filter.returnNumbers = Rcpp::as<std::vector<int> >(returnNumbers);
+  }
+
+  // Count the points first, since the columns of the file have fixed lengths
+  std::uint64_t numPoints{ 0 };
+  for (const std::string& lasFile : lasFiles) {
+    LasFile las{ lasFile };
+    for (std::uint64_t i{ 0 }; i < las.header().numPoints; i++) {
+      numPoints += las.isKept(i, filter) ? 1 : 0;
+    }
+  }
+
+  std::shared_ptr<ColumnFile> columnFile{ std::make_shared<ColumnFile>(
+    file, std::vector<std::string>{ "X", "Y", "Z" },
+    std::vector<ColumnType>(3, ColumnType::real), numPoints
+  ) };
+  double* pointsX{ reinterpret_cast<double*>(columnFile->columnData(0)) };
+  double* pointsY{ reinterpret_cast<double*>(columnFile->columnData(1)) };
+  double* pointsZ{ reinterpret_cast<double*>(columnFile->columnData(2)) };
+  std::uint64_t point{ 0 };
+  for (const std::string& lasFile : lasFiles) {
+    LasFile las{ lasFile };
+    for (std::uint64_t i{ 0 }; i < las.header().numPoints; i++) {
+      if (las.isKept(i, filter)) {
+        las.coordinates(i, pointsX[point], pointsY[point], pointsZ[point]);
+        point++;
+      }
+    }
+    Rcpp::checkUserInterrupt();
+  }
+  columnFile->flush();
+  return createMappedDataFrame(columnFile);
+}
+
+
+//' Read the columns of a column file
+//'
+//' Maps a file of \code{writeColumnFile} or \code{writeLasColumnFile} into
+//' memory and returns its columns as ALTREP vectors that R treats like
+//' ordinary numeric and integer vectors. The values are only read from disk
+//' when they are accessed and the operating system may page them out again,
+//' so the R heap stays small. The mean shift functions that take separate
+//' columns, like \code{meanShiftClassicImprovedColumns}, read them in place.
+//'
+//' @param file Character scalar. Path of the column file.
+//'
+//' @return A data.frame with the columns of the file, or a named list of
+//'   long vectors if the file has more than 2^31 - 1 rows, which a
+//'   data.frame cannot hold. Modifying a column never changes the file.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List readColumnFile(std::string file){
+  return createMappedDataFrame(openColumnFile(file));
+}
+
+
+//' Read consecutive columns of a column file as a matrix
+//'
+//' Like \code{readColumnFile}, but returns consecutive columns of doubles as
+//' one mapped matrix, which the mean shift functions that take a point cloud
+//' matrix read in place.
+//'
+//' @param file Character scalar. Path of the column file.
+//' @param columns Character vector. Names of consecutive columns of doubles,
+//'   in the order of the file.
+//'
+//' @return A numeric matrix with the given columns.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::NumericMatrix readColumnFileMatrix(
+    std::string file,
+    Rcpp::CharacterVector columns = Rcpp::CharacterVector::create("X", "Y", "Z")
+){
+  std::shared_ptr<ColumnFile> columnFile{ openColumnFile(file) };
+  std::vector<std::string> names{ Rcpp::as<std::vector<std::string> >(columns) };
+  int firstColumn{ names.empty() ? -1 : columnFile->findColumn(names[0]) };
+  for (std::size_t column{ 0 }; column < names.size(); column++) {
+    if (firstColumn < 0
+        || columnFile->findColumn(names[column])
+           != firstColumn + static_cast<int>(column)) {
+      Rcpp::stop("The columns must be consecutive columns of the file.");
+    }
+  }
+
+  if (columnFile->numRows() > INT_MAX) {
+    Rcpp::stop("R matrices cannot have more than 2^31 - 1 rows.");
+  }
+  int numColumns{ static_cast<int>(names.size()) };
+  Rcpp::RObject matrix{ createMappedVector(columnFile, firstColumn, numColumns) };
+  matrix.attr("dim") = Rcpp::IntegerVector::create(
+    static_cast<int>(columnFile->numRows()), numColumns
+  );
+  matrix.attr("dimnames") = Rcpp::List::create(R_NilValue, columns);
+  return Rcpp::NumericMatrix(matrix);
+}
@@ -0,0 +1,29 @@
+#ifndef MAPPED_COLUMNS_H
+#define MAPPED_COLUMNS_H
+
+#include "columnFile.h"
+
+#include <Rcpp.h>
+#include <memory>
+
+
+/** Returns \p numColumns consecutive columns of \p file, starting with
+ *  \p firstColumn, as one ALTREP vector whose values are the mapped values
+ *  of the file, so they are neither copied into memory nor onto the R heap.
+ *  The vector keeps the file mapped for as long as it lives.
+ *
+ *  Several columns can only be combined if they hold doubles, since those
+ *  are stored back to back, e.g. for the matrix of a point cloud.
+ */
+SEXP createMappedVector(
+  const std::shared_ptr<ColumnFile>& file, const int firstColumn,
+  const int numColumns = 1
+);
+
+
+/** Returns all columns of \p file as a data.frame of mapped vectors, or as
+ *  a named list if the file has more rows than a data.frame can hold.
+ */
+Rcpp::List createMappedDataFrame(const std::shared_ptr<ColumnFile>& file);
+
+#endif  // define MAPPED_COLUMNS_H
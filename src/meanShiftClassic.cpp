@@ -1,54 +1,38 @@
 #include <Rcpp.h>
 #include <cmath>
 #include "LittleFunctionsCollection.h"
+#include "pointColumns.h"
+#include "seedSet.h"
 using namespace Rcpp;
 
 
-//' Mean shift clustering
-//'
-//' Adaptive mean shift clustering to delineate tree crowns from lidar point
-//' clouds.
-//'
-//' @param pointCloud Point cloud data in a three-column matrix where the
-//'   columns represent X, Y and Z coordinates and each row represents one
-//'   point.
-//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
-//'   to tree height. Determines kernel diameter based on the height of its
-//'   center.
-//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
-//'   height. Determines kernel height based on the height of its center.
-//' @param maxNumCentroidsPerMode Integer scalar. Maximum number of
-//'   iterations, i.e. steps that the kernel can move for each point. If no mode
-//'   is found after \code{maxNumCentroidsPerMode} iterations, the centroid
-//'   that was calculated last is treated as the mode.
-//'
-//' @return A data.frame with the coordinates in \code{pointCloud} and three
-//'   additional columns with the coordinates of the calculated modes.
-//'
-//' @export
-// [[Rcpp::export]]
-DataFrame meanShiftClassic(
-    NumericMatrix pointCloud,
+namespace {
+
+// Calculates the modes of the seeds among the points
+List findClassicModes(
+    const PointColumns& points,
     double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
-    int maxNumCentroidsPerMode = 200
+    int maxNumCentroidsPerMode, Nullable<LogicalVector> isSeed,
+    const ModesOptions& options
 ){
-  // Create three vectors that all have the length of the incoming point cloud.
+  // Create three vectors that all have the length of the seed set.
   // These vectors will store the coordinates of the calculated modes.
-  int nrows = pointCloud.nrow();
+  R_xlen_t nrows = points.numPoints;
+  std::vector<R_xlen_t> seedRows = selectSeedRows(isSeed, nrows);
+  R_xlen_t numSeeds = seedRows.size();
 
-  NumericVector modesX(nrows);
-  NumericVector modesY(nrows);
-  NumericVector modesZ(nrows);
+  ModeVectors modes{ numSeeds, options };
 
-  // Process one point after the other.
-  for(int i = 0; i < nrows; i++){
+  // Process one seed after the other.
+  for(R_xlen_t seed = 0; seed < numSeeds; seed++){
+    R_xlen_t i = seedRows[seed];
 
     // Initialize variables to store the mean coordinates of all neighbors with
     // the actual coordinates of the current point from where the kernel starts
     // moving.
-    double centroidX = (double) pointCloud(i, 0);
-    double centroidY = (double) pointCloud(i, 1);
-    double centroidZ = (double) pointCloud(i, 2);
+    double centroidX = points.pointsX[i];
+    double centroidY = points.pointsY[i];
+    double centroidZ = points.pointsZ[i];
 
     // Declare variables for storing the centroid of the previous iteration.
     double oldX = -100.0;
@@ -88,11 +72,11 @@ DataFrame meanShiftClassic(
        oldZ = centroidZ;
 
       // Loop through all points to identify the neighbors of the current point
-      for(int j = 0; j < nrows; j++) {
+      for(R_xlen_t j = 0; j < nrows; j++) {
 
-        double pointX = (double) pointCloud(j, 0);
-        double pointY = (double) pointCloud(j, 1);
-        double pointZ = (double) pointCloud(j, 2);
+        double pointX = points.pointsX[j];
+        double pointY = points.pointsY[j];
+        double pointZ = points.pointsZ[j];
 
         if (InCylinder(
           pointX, pointY, pointZ,
@@ -132,20 +116,113 @@ DataFrame meanShiftClassic(
       && numIterations < maxNumCentroidsPerMode
     );
 
-    // Store the found position as the mode position for the current point
-    modesX[i] = centroidX;
-    modesY[i] = centroidY;
-    modesZ[i] = centroidZ;
+    // Store the found position as the mode position for the current seed
+    modes.modesX[seed] = centroidX;
+    modes.modesY[seed] = centroidY;
+    modes.modesZ[seed] = centroidZ;
   }
 
-  // Return the result as a data.frame with XYZ-coordinates of all points and
-  // their corresponding modes
-  return DataFrame::create(
-    _("X") = pointCloud(_, 0),
-    _("Y") = pointCloud(_, 1),
-    _("Z") = pointCloud(_, 2),
-    _("modeX") = modesX,
-    _("modeY") = modesY,
-    _("modeZ") = modesZ
+  // Return the result as a data.frame with XYZ-coordinates of all seeds and
+  // their corresponding modes, or in the requested lean form
+  return modes.createDataFrame(points, seedRows);
+}
+
+}  // namespace
+
+
+//' Mean shift clustering
+//'
+//' Adaptive mean shift clustering to delineate tree crowns from lidar point
+//' clouds.
+//'
+//' @param pointCloud Point cloud data in a three-column matrix where the
+//'   columns represent X, Y and Z coordinates and each row represents one
+//'   point.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param maxNumCentroidsPerMode Integer scalar. Maximum number of
+//'   iterations, i.e. steps that the kernel can move for each point. If no mode
+//'   is found after \code{maxNumCentroidsPerMode} iterations, the centroid
+//'   that was calculated last is treated as the mode.
+//' @param isSeed Logical vector with one element per point or NULL. If
+//'   given, only the modes of the points where it is TRUE are calculated,
+//'   while all points still act as neighbors. NULL calculates the modes of
+//'   all points.
+//' @param output Character scalar. "full" returns the coordinates of the
+//'   seeds and their modes, "modes" only the columns modeX, modeY and modeZ,
+//'   and "indexed" only the integer column modeIndex, which points into the
+//'   table of unique modes in the attribute "modes".
+//' @param modeTolerance Numeric scalar. If \code{output} is "indexed", modes
+//'   within this distance of each other share one row of the mode table.
+//' @param outputFile Character scalar. If not empty, the result is stored in
+//'   a column file at this path, which is created or overwritten, and its
+//'   columns are returned as mapped vectors like those of
+//'   \code{readColumnFile}. Except for "indexed", the modes are written to
+//'   the file as they are found, so they never occupy the R heap.
+//'
+//' @return A data.frame with the coordinates of the seed points in
+//'   \code{pointCloud} and three additional columns with the coordinates of
+//'   the calculated modes, or one of the lean forms selected by
+//'   \code{output}.
+//'
+//' @export
+// [[Rcpp::export]]
+List meanShiftClassic(
+    NumericMatrix pointCloud,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int maxNumCentroidsPerMode = 200,
+    Nullable<LogicalVector> isSeed = R_NilValue,
+    std::string output = "full", double modeTolerance = 0.01,
+    std::string outputFile = ""
+){
+  return findClassicModes(
+    getPointColumns(pointCloud), crownDiameter2TreeHeight,
+    crownHeight2TreeHeight, maxNumCentroidsPerMode, isSeed,
+    selectModesOptions(output, modeTolerance, outputFile)
+  );
+}
+
+
+//' Mean shift clustering of point coordinates in separate columns
+//'
+//' Like \code{meanShiftClassic}, but takes the coordinates as three
+//' vectors, e.g. the columns of a data.frame, a data.table or the data of a
+//' lidR LAS object. Numeric vectors are read in place, so the coordinates are
+//' not copied into a matrix first.
+//'
+//' @param pointsX,pointsY,pointsZ Numeric vectors with the X-, Y- and
+//'   Z-coordinates of the points.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param maxNumCentroidsPerMode Integer scalar. Maximum number of
+//'   iterations, i.e. steps that the kernel can move for each point.
+//' @param isSeed Logical vector with one element per point or NULL. If
+//'   given, only the modes of the points where it is TRUE are calculated.
+//' @param output,modeTolerance,outputFile The form and destination of the
+//'   result, as in
+//'   \code{meanShiftClassic}.
+//'
+//' @return The data.frame of \code{meanShiftClassic}.
+//'
+//' @export
+// [[Rcpp::export]]
+List meanShiftClassicColumns(
+    NumericVector pointsX, NumericVector pointsY, NumericVector pointsZ,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int maxNumCentroidsPerMode = 200,
+    Nullable<LogicalVector> isSeed = R_NilValue,
+    std::string output = "full", double modeTolerance = 0.01,
+    std::string outputFile = ""
+){
+  return findClassicModes(
+    getPointColumns(pointsX, pointsY, pointsZ), crownDiameter2TreeHeight,
+    crownHeight2TreeHeight, maxNumCentroidsPerMode, isSeed,
+    selectModesOptions(output, modeTolerance, outputFile)
   );
 }
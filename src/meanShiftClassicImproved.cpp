@@ -1,7 +1,97 @@
-#include "littleFunctionsImproved.h"
+#include "cylinderKernel.h"
+#include "heightBandedGridIndex.h"
+#include "pointCloudBuilder.h"
+#include "pointColumns.h"
+#include "seedSet.h"
 
 #include <Rcpp.h>
-#include <cmath>
+#include <climits>  // for INT_MAX
+#include <cstdint>
+#include <string>
+
+
+namespace {
+
+// Calculates the modes of the seeds among the indexed points
+template <typename Index>
+Rcpp::List findImprovedModes(
+    const PointColumns& points, const BasicHeightBandedGridIndex<Index>& index,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int maxNumCentroidsPerMode, int maxNumNeighbors,
+    Rcpp::Nullable<Rcpp::LogicalVector> isSeed,
+    const ModesOptions& options
+){
+  // Create three vectors that all have the length of the seed set.
+  // These vectors will store the coordinates of the calculated modes.
+  Index nrows{ static_cast<Index>(points.numPoints) };
+  std::vector<Index> seedRows{ selectSeedRows(isSeed, nrows) };
+  R_xlen_t numSeeds{ static_cast<R_xlen_t>(seedRows.size()) };
+
+  ModeVectors modes{ numSeeds, options };
+
+  // Count how often the number of neighbors was capped
+  double numKernelQueries{ 0 };
+  double numCappedKernelQueries{ 0 };
+
+  // Process one seed after the other.
+  for(R_xlen_t seed{ 0 }; seed < numSeeds; seed++){
+    Index i{ seedRows[seed] };
+
+    // Move the kernel from the seed until it stops moving
+    Mode mode{ findMode(
+      index, points.pointsX[i], points.pointsY[i], points.pointsZ[i],
+      crownDiameter2TreeHeight, crownHeight2TreeHeight,
+      maxNumCentroidsPerMode, maxNumNeighbors
+    ) };
+    numKernelQueries += mode.numIterations;
+    numCappedKernelQueries += mode.numCappedIterations;
+
+    // Store the found position as the mode position for the current seed
+    modes.modesX[seed] = mode.x;
+    modes.modesY[seed] = mode.y;
+    modes.modesZ[seed] = mode.z;
+  }
+
+  // Return the result as a data.frame with XYZ-coordinates of all seeds and
+  // their corresponding modes, or in the requested lean form
+  Rcpp::List result{ modes.createDataFrame(points, seedRows) };
+  result.attr("numKernelQueries") = numKernelQueries;
+  result.attr("numCappedKernelQueries") = numCappedKernelQueries;
+  return result;
+}
+
+// Indexes the points with 32-bit positions unless there are too many of them,
+// since the smaller index needs half the memory
+Rcpp::List findImprovedModes(
+    const PointColumns& points,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int maxNumCentroidsPerMode, int maxNumNeighbors,
+    Rcpp::Nullable<Rcpp::LogicalVector> isSeed,
+    const ModesOptions& options
+){
+  // Index the points so that the neighbors of a kernel can be looked up
+  // without looping through the whole point cloud
+  if (points.numPoints <= INT_MAX) {
+    HeightBandedGridIndex index{
+      points.pointsX, points.pointsY, points.pointsZ,
+      static_cast<std::int32_t>(points.numPoints), crownDiameter2TreeHeight
+    };
+    return findImprovedModes(
+      points, index, crownDiameter2TreeHeight, crownHeight2TreeHeight,
+      maxNumCentroidsPerMode, maxNumNeighbors, isSeed, options
+    );
+  }
+  LargeHeightBandedGridIndex index{
+    points.pointsX, points.pointsY, points.pointsZ,
+    static_cast<std::int64_t>(points.numPoints), crownDiameter2TreeHeight
+  };
+  return findImprovedModes(
+    points, index, crownDiameter2TreeHeight, crownHeight2TreeHeight,
+    maxNumCentroidsPerMode, maxNumNeighbors, isSeed, options
+  );
+}
+
+}  // namespace
 
 
 //' Mean shift clustering
@@ -21,124 +111,180 @@
 //'   iterations, i.e. steps that the kernel can move for each point. If no mode
 //'   is found after \code{maxNumCentroidsPerMode} iterations, the centroid
 //'   that was calculated last is treated as the mode.
+//' @param maxNumNeighbors Integer scalar. If positive, kernels with more
+//'   neighbors than this only use a deterministic subsample of
+//'   about \code{maxNumNeighbors} of them, which bounds the cost of an
+//'   iteration in dense emergent crowns. 0 uses all neighbors.
+//' @param isSeed Logical vector with one element per point or NULL. If
+//'   given, only the modes of the points where it is TRUE are calculated,
+//'   while all points still act as neighbors. NULL calculates the modes of
+//'   all points.
+//' @param output Character scalar. "full" returns the coordinates of the
+//'   seeds and their modes, "modes" only the columns modeX, modeY and modeZ,
+//'   and "indexed" only the integer column modeIndex, which points into the
+//'   table of unique modes in the attribute "modes".
+//' @param modeTolerance Numeric scalar. If \code{output} is "indexed", modes
+//'   within this distance of each other share one row of the mode table.
+//' @param outputFile Character scalar. If not empty, the result is stored in
+//'   a column file at this path, which is created or overwritten, and its
+//'   columns are returned as mapped vectors like those of
+//'   \code{readColumnFile}. Except for "indexed", the modes are written to
+//'   the file as they are found, so they never occupy the R heap.
+//'
+//' @return A data.frame with the coordinates of the seed points in
+//'   \code{pointCloud} and three additional columns with the coordinates of
+//'   the calculated modes, or one of the lean forms selected by
+//'   \code{output}. The
+//'   attributes \code{numKernelQueries} and \code{numCappedKernelQueries}
+//'   hold the total number of kernel evaluations and the number of those that
+//'   were subsampled.
 //'
-//' @return A data.frame with the coordinates in \code{pointCloud} and three
-//'   additional columns with the coordinates of the calculated modes.
+//' @details The neighbors of each kernel are looked up in a spatial index
+//'   with one horizontal grid per height band, whose cell size matches the
+//'   largest kernel radius in that band. Only the points in the grid cells
+//'   around the kernel and within its vertical extent are examined.
+//'
+//'   The subsample for \code{maxNumNeighbors} takes every k-th candidate of
+//'   the candidates of all grid cells, visited cell by cell and sorted by
+//'   height within each cell, so it is stratified horizontally and
+//'   vertically. Every cell keeps its share of the sample up to one
+//'   candidate, so dense cells do not dominate the centroid. The number of
+//'   neighbors is estimated from the number of candidates in the grid cells
+//'   and the share of the kernel's circle in the area of these cells.
 //'
 //' @export
 // [[Rcpp::export]]
-Rcpp::DataFrame meanShiftClassicImproved(
+Rcpp::List meanShiftClassicImproved(
     Rcpp::NumericMatrix pointCloud,
     double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
-    int maxNumCentroidsPerMode = 200
+    int maxNumCentroidsPerMode = 200,
+    int maxNumNeighbors = 0,
+    Rcpp::Nullable<Rcpp::LogicalVector> isSeed = R_NilValue,
+    std::string output = "full", double modeTolerance = 0.01,
+    std::string outputFile = ""
 ){
-  // Create three vectors that all have the length of the incoming point cloud.
-  // These vectors will store the coordinates of the calculated modes.
-  int nrows{ pointCloud.nrow() };
-
-  Rcpp::NumericVector modesX(nrows);
-  Rcpp::NumericVector modesY(nrows);
-  Rcpp::NumericVector modesZ(nrows);
-
-  // Process one point after the other.
-  for(int i{ 0 }; i < nrows; i++){
-
-    // Get the current point's coordinates
-    double centroidX{ pointCloud(i, 0) };
-    double centroidY{ pointCloud(i, 1) };
-    double centroidZ{ pointCloud(i, 2) };
-
-    // Declare variables for storing the centroid of the previous iteration
-    double oldX;
-    double oldY;
-    double oldZ;
-
-    // Keep iterating while neither the mode nor the maximum number of
-    // iterations are reached
-    int numIterations{ 0 };
-
-    do {
-      // Increase the iteration counter
-      numIterations += 1;
-
-      // Initialize helper variables for the calculation of kernel centroids
-      double sumX{ 0 };
-      double sumY{ 0 };
-      double sumZ{ 0 };
-      double sumWeights{ 0 };
-
-      // Remember the centroid of the previous iteration.
-      oldX = centroidX;
-      oldY = centroidY;
-      oldZ = centroidZ;
-
-      // Calculate cylinder dimensions based on point height
-      double cylinderRadius = crownDiameter2TreeHeight * centroidZ * 0.5;
-      double cylinderHeight = crownHeight2TreeHeight * centroidZ * 0.75;
-      double cylinderMiddleZ = centroidZ + cylinderHeight * 1.0/6.0;
-
-      // Loop through all points to identify the neighbors of the current point
-      for(int j{ 0 }; j < nrows; j++) {
-
-        double neighborX{ pointCloud(j, 0) };
-        double neighborY{ pointCloud(j, 1) };
-        double neighborZ{ pointCloud(j, 2) };
-
-        if (
-          intersectsCylinder(
-            neighborX, neighborY, neighborZ,
-            cylinderRadius, cylinderHeight,
-            centroidX, centroidY, cylinderMiddleZ
-          )
-        ) {
-          // Calculate the centroid by multiplying all coodinates by their
-          // weights, depending on their relative position within the cylinder,
-          // summing up the products and dividing by the sum of all weights
-          double verticalweight{ calculateVerticalWeight(
-            neighborZ, cylinderMiddleZ, cylinderHeight
-          ) };
-          double horizontalweight{ calculateHorizontalWeight(
-              neighborX, neighborY, cylinderRadius, centroidX, centroidY
-          ) };
-          double weight{ verticalweight * horizontalweight };
-
-          sumX += weight * neighborX;
-          sumY += weight * neighborY;
-          sumZ += weight * neighborZ;
-          sumWeights += weight;
-        }
-      }
-
-      centroidX = sumX / sumWeights;
-      centroidY = sumY / sumWeights;
-      centroidZ = sumZ / sumWeights;
-
-      // If the new position is very close to the previous position (kernel
-      // stopped moving), or if the maximum number of iterations is reached, stop
-      // the iterations.
-    } while (
-      std::sqrt(
-          std::pow(centroidX - oldX, 2.0)
-        + std::pow(centroidY - oldY, 2.0)
-        + std::pow(centroidZ - oldZ, 2.0)
-      ) > 0.01
-      && numIterations < maxNumCentroidsPerMode
-    );
+  return findImprovedModes(
+    getPointColumns(pointCloud), crownDiameter2TreeHeight,
+    crownHeight2TreeHeight, maxNumCentroidsPerMode, maxNumNeighbors, isSeed,
+    selectModesOptions(output, modeTolerance, outputFile)
+  );
+}
+
 
-    // Store the found position as the mode position for the current point
-    modesX[i] = centroidX;
-    modesY[i] = centroidY;
-    modesZ[i] = centroidZ;
+//' Mean shift clustering of point coordinates in separate columns
+//'
+//' Like \code{meanShiftClassicImproved}, but takes the coordinates as three
+//' vectors, e.g. the columns of a data.frame, a data.table or the data of a
+//' lidR LAS object. Numeric vectors are read in place, so the coordinates are
+//' not copied into a matrix first.
+//'
+//' @param pointsX,pointsY,pointsZ Numeric vectors with the X-, Y- and
+//'   Z-coordinates of the points.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param maxNumCentroidsPerMode Integer scalar. Maximum number of
+//'   iterations, i.e. steps that the kernel can move for each point.
+//' @param maxNumNeighbors Integer scalar. If positive, kernels with more
+//'   neighbors than this only use a deterministic subsample of
+//'   them.
+//' @param isSeed Logical vector with one element per point or NULL. If
+//'   given, only the modes of the points where it is TRUE are calculated.
+//' @param output,modeTolerance,outputFile The form and destination of the
+//'   result, as in
+//'   \code{meanShiftClassicImproved}.
+//'
+//' @return The data.frame of \code{meanShiftClassicImproved}.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List meanShiftClassicImprovedColumns(
+    Rcpp::NumericVector pointsX, Rcpp::NumericVector pointsY,
+    Rcpp::NumericVector pointsZ,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int maxNumCentroidsPerMode = 200,
+    int maxNumNeighbors = 0,
+    Rcpp::Nullable<Rcpp::LogicalVector> isSeed = R_NilValue,
+    std::string output = "full", double modeTolerance = 0.01,
+    std::string outputFile = ""
+){
+  return findImprovedModes(
+    getPointColumns(pointsX, pointsY, pointsZ), crownDiameter2TreeHeight,
+    crownHeight2TreeHeight, maxNumCentroidsPerMode, maxNumNeighbors, isSeed,
+    selectModesOptions(output, modeTolerance, outputFile)
+  );
+}
+
+
+//' Mean shift clustering of the points of a point cloud builder
+//'
+//' Like \code{meanShiftClassicImproved}, but takes the points of a
+//' finalized point cloud builder. If the builder was finalized with the same
+//' \code{crownDiameter2TreeHeight}, its index is used instead of indexing
+//' the points again, so several runs with different parameters share it.
+//'
+//' @param builder External pointer of \code{createPointCloudBuilder}, which
+//'   has been finalized.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param maxNumCentroidsPerMode Integer scalar. Maximum number of
+//'   iterations, i.e. steps that the kernel can move for each point.
+//' @param maxNumNeighbors Integer scalar. If positive, kernels with more
+//'   neighbors than this only use a deterministic subsample of
+//'   them.
+//' @param isSeed Logical vector with one element per point or NULL. If
+//'   given, only the modes of the points where it is TRUE are calculated.
+//' @param output,modeTolerance,outputFile The form and destination of the
+//'   result, as in
+//'   \code{meanShiftClassicImproved}.
+//'
+//' @return The data.frame of \code{meanShiftClassicImproved}.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List meanShiftClassicImprovedBuilder(
+    SEXP builder,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int maxNumCentroidsPerMode = 200,
+    int maxNumNeighbors = 0,
+    Rcpp::Nullable<Rcpp::LogicalVector> isSeed = R_NilValue,
+    std::string output = "full", double modeTolerance = 0.01,
+    std::string outputFile = ""
+){
+  Rcpp::XPtr<PointCloudBuilder> pointCloud{ builder };
+  if (!pointCloud->isFinalized()) {
+    Rcpp::stop("The point cloud builder has not been finalized.");
   }
+  PointColumns points{
+    pointCloud->columnData(0), pointCloud->columnData(1),
+    pointCloud->columnData(2), static_cast<R_xlen_t>(pointCloud->numPoints())
+  };
+  ModesOptions options{ selectModesOptions(output, modeTolerance, outputFile) };
 
-  // Return the result as a data.frame with XYZ-coordinates of all points and
-  // their corresponding modes
-  return Rcpp::DataFrame::create(
-    Rcpp::Named("X") = pointCloud(Rcpp::_, 0),
-    Rcpp::Named("Y") = pointCloud(Rcpp::_, 1),
-    Rcpp::Named("Z") = pointCloud(Rcpp::_, 2),
-    Rcpp::Named("modeX") = modesX,
-    Rcpp::Named("modeY") = modesY,
-    Rcpp::Named("modeZ") = modesZ
+  bool hasIndex{
+    pointCloud->indexCrownDiameter2TreeHeight() == crownDiameter2TreeHeight
+  };
+  if (hasIndex && pointCloud->index() != nullptr) {
+    return findImprovedModes(
+      points, *pointCloud->index(), crownDiameter2TreeHeight,
+      crownHeight2TreeHeight, maxNumCentroidsPerMode, maxNumNeighbors, isSeed,
+      options
+    );
+  }
+  if (hasIndex && pointCloud->largeIndex() != nullptr) {
+    return findImprovedModes(
+      points, *pointCloud->largeIndex(), crownDiameter2TreeHeight,
+      crownHeight2TreeHeight, maxNumCentroidsPerMode, maxNumNeighbors, isSeed,
+      options
+    );
+  }
+  return findImprovedModes(
+    points, crownDiameter2TreeHeight, crownHeight2TreeHeight,
+    maxNumCentroidsPerMode, maxNumNeighbors, isSeed, options
   );
 }
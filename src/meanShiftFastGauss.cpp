@@ -0,0 +1,170 @@
+#include "kernelSummationTree.h"
+#include "seedSet.h"
+
+#include <Rcpp.h>
+#include <cmath>
+#include <string>
+
+
+//' Mean shift clustering with approximated kernel sums
+//'
+//' Adaptive mean shift clustering to delineate tree crowns from lidar point
+//' clouds. Uses the same kernel as \code{meanShiftClassicImproved} but
+//' approximates the kernel sums with a guaranteed error bound, which pays off
+//' for very dense point clouds.
+//'
+//' @param pointCloud Point cloud data in a three-column matrix where the
+//'   columns represent X, Y and Z coordinates and each row represents one
+//'   point.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param maxNumCentroidsPerMode Integer scalar. Maximum number of
+//'   iterations, i.e. steps that the kernel can move for each point. If no mode
+//'   is found after \code{maxNumCentroidsPerMode} iterations, the centroid
+//'   that was calculated last is treated as the mode.
+//' @param absoluteTolerance Numeric scalar. Maximum absolute error of the
+//'   kernel weight of every single point. Kernel weights range from 0 to 1.
+//'   With a tolerance of 0 the results equal those of
+//'   \code{meanShiftClassicImproved} up to rounding errors.
+//' @param isSeed Logical vector with one element per point or NULL. If
+//'   given, only the modes of the points where it is TRUE are calculated,
+//'   while all points still act as neighbors. NULL calculates the modes of
+//'   all points.
+//' @param output Character scalar. "full" returns the coordinates of the
+//'   seeds and their modes, "modes" only the columns modeX, modeY and modeZ,
+//'   and "indexed" only the integer column modeIndex, which points into the
+//'   table of unique modes in the attribute "modes".
+//' @param modeTolerance Numeric scalar. If \code{output} is "indexed", modes
+//'   within this distance of each other share one row of the mode table.
+//' @param outputFile Character scalar. If not empty, the result is stored in
+//'   a column file at this path, which is created or overwritten, and its
+//'   columns are returned as mapped vectors like those of
+//'   \code{readColumnFile}. Except for "indexed", the modes are written to
+//'   the file as they are found, so they never occupy the R heap.
+//'
+//' @return A data.frame with the coordinates of the seed points in
+//'   \code{pointCloud} and three additional columns with the coordinates of
+//'   the calculated modes, or one of the lean forms selected by
+//'   \code{output}. The attribute \code{numExpandedNodes} holds the number
+//'   of tree nodes whose sums were approximated, over all kernel evaluations.
+//'
+//' @details The points are split into horizontal slabs of one meter
+//'   thickness and the points of every slab are organized in a kd-tree. Since
+//'   the vertical epanechnikov weight is a polynomial of the height, the
+//'   contribution of a tree node that lies completely inside the kernel can
+//'   be calculated from the node's moments, using a first order expansion of
+//'   the horizontal gaussian weight around the node center. Nodes are only
+//'   summed this way if the error bound of the expansion does not exceed
+//'   \code{absoluteTolerance}. Every centroid therefore deviates from the
+//'   exact one by at most \code{absoluteTolerance * sum(d) / sum(w)}, where
+//'   \code{d} are the distances of the points in the kernel to the
+//'   approximated centroid and \code{w} their exact weights.
+//'   \code{benchmark_fast_gauss} compares run time and modes with those of
+//'   \code{meanShiftClassicImproved}.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame meanShiftFastGauss(
+    Rcpp::NumericMatrix pointCloud,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int maxNumCentroidsPerMode = 200,
+    double absoluteTolerance = 0.001,
+    Rcpp::Nullable<Rcpp::LogicalVector> isSeed = R_NilValue,
+    std::string output = "full", double modeTolerance = 0.01,
+    std::string outputFile = ""
+){
+  ModesOptions options{
+    selectModesOptions(output, modeTolerance, outputFile)
+  };
+  if (absoluteTolerance < 0.0) {
+    Rcpp::stop("absoluteTolerance must not be negative.");
+  }
+
+  // Create three vectors that all have the length of the seed set.
+  // These vectors will store the coordinates of the calculated modes.
+  int nrows{ pointCloud.nrow() };
+  std::vector<int> seedRows{ selectSeedRows(isSeed, nrows) };
+  int numSeeds{ static_cast<int>(seedRows.size()) };
+
+  ModeVectors modes{ numSeeds, options };
+
+  // Count how often the sums of a node were approximated
+  double numExpandedNodes{ 0 };
+
+  // Organize the points in trees that allow approximating the kernel sums
+  const double* pointsX{ pointCloud.begin() };
+  KernelSummationTree tree{
+    pointsX, pointsX + nrows, pointsX + 2 * nrows, nrows
+  };
+
+  // Process one seed after the other.
+  for(int seed{ 0 }; seed < numSeeds; seed++){
+
+    // Get the current seed's coordinates
+    int i{ seedRows[seed] };
+    double centroidX{ pointCloud(i, 0) };
+    double centroidY{ pointCloud(i, 1) };
+    double centroidZ{ pointCloud(i, 2) };
+
+    // Declare variables for storing the centroid of the previous iteration
+    double oldX;
+    double oldY;
+    double oldZ;
+
+    // Keep iterating while neither the mode nor the maximum number of
+    // iterations are reached
+    int numIterations{ 0 };
+
+    do {
+      // Increase the iteration counter
+      numIterations += 1;
+
+      // Remember the centroid of the previous iteration.
+      oldX = centroidX;
+      oldY = centroidY;
+      oldZ = centroidZ;
+
+      // Calculate cylinder dimensions based on point height
+      double cylinderRadius = crownDiameter2TreeHeight * centroidZ * 0.5;
+      double cylinderHeight = crownHeight2TreeHeight * centroidZ * 0.75;
+      double cylinderMiddleZ = centroidZ + cylinderHeight * 1.0/6.0;
+
+      // Sum the weighted coordinates of all points within the cylinder
+      KernelSums sums{ tree.sumCylinderKernel(
+        centroidX, centroidY, cylinderMiddleZ,
+        cylinderRadius, cylinderHeight,
+        absoluteTolerance
+      ) };
+      numExpandedNodes += sums.numExpandedNodes;
+
+      centroidX = sums.sumX / sums.sumWeights;
+      centroidY = sums.sumY / sums.sumWeights;
+      centroidZ = sums.sumZ / sums.sumWeights;
+
+      // If the new position is very close to the previous position (kernel
+      // stopped moving), or if the maximum number of iterations is reached, stop
+      // the iterations.
+    } while (
+      std::sqrt(
+          std::pow(centroidX - oldX, 2.0)
+        + std::pow(centroidY - oldY, 2.0)
+        + std::pow(centroidZ - oldZ, 2.0)
+      ) > 0.01
+      && numIterations < maxNumCentroidsPerMode
+    );
+
+    // Store the found position as the mode position for the current seed
+    modes.modesX[seed] = centroidX;
+    modes.modesY[seed] = centroidY;
+    modes.modesZ[seed] = centroidZ;
+  }
+
+  // Return the result as a data.frame with XYZ-coordinates of all seeds and
+  // their corresponding modes, or in the requested lean form
+  Rcpp::DataFrame result{ modes.createDataFrame(pointCloud, seedRows) };
+  result.attr("numExpandedNodes") = numExpandedNodes;
+  return result;
+}
@@ -0,0 +1,194 @@
+#include "modeClustering.h"
+
+#include <algorithm>  // for std::sort, std::equal_range
+#include <cmath>      // for std::floor, std::isfinite
+#include <cstddef>
+#include <cstdint>    // for std::int32_t, std::int64_t
+#include <vector>
+
+
+namespace {
+
+// Number of bits per axis in the key of a grid cell
+const int CELL_KEY_BITS{ 21 };
+
+/** Fixed radius neighbor search over the modes. */
+template <typename Index>
+class ModeGrid {
+public:
+
+  ModeGrid(
+    const double* modesX, const double* modesY, const double* modesZ,
+    const Index numModes, const double cellSize
+  ) : modesX{ modesX }, modesY{ modesY }, modesZ{ modesZ },
+      cellSize{ cellSize }, minX{ 0.0 }, minY{ 0.0 }, minZ{ 0.0 } {
+    bool isEmpty{ true };
+    for (Index i{ 0 }; i < numModes; i++) {
+      if (!isFinite(i)) {
+        continue;
+      }
+      if (isEmpty || modesX[i] < minX) minX = modesX[i];
+      if (isEmpty || modesY[i] < minY) minY = modesY[i];
+      if (isEmpty || modesZ[i] < minZ) minZ = modesZ[i];
+      isEmpty = false;
+    }
+
+    // Sort the modes by cell. Modes with non-finite coordinates have no
+    // neighbors and are left out.
+    for (Index i{ 0 }; i < numModes; i++) {
+      if (isFinite(i)) {
+        sortedModes.push_back(i);
+      }
+    }
+    cellKeys.resize(numModes);
+    for (Index i : sortedModes) {
+      cellKeys[i] = cellKey(
+        cellCoordinate(modesX[i], minX), cellCoordinate(modesY[i], minY),
+        cellCoordinate(modesZ[i], minZ)
+      );
+    }
+    std::sort(
+      sortedModes.begin(), sortedModes.end(),
+      [this](const Index a, const Index b) { return cellKeys[a] < cellKeys[b]; }
+    );
+    sortedKeys.resize(sortedModes.size());
+    for (std::size_t k{ 0 }; k < sortedModes.size(); k++) {
+      sortedKeys[k] = cellKeys[sortedModes[k]];
+    }
+  }
+
+  bool isFinite(const Index i) const {
+    return std::isfinite(modesX[i]) && std::isfinite(modesY[i])
+      && std::isfinite(modesZ[i]);
+  }
+
+  // Collects all modes within the distance cellSize of mode i, including i
+  void findNeighbors(const Index i, std::vector<Index>& neighbors) const {
+    neighbors.clear();
+    if (!isFinite(i)) {
+      neighbors.push_back(i);
+      return;
+    }
+    long long cellX{ cellCoordinate(modesX[i], minX) };
+    long long cellY{ cellCoordinate(modesY[i], minY) };
+    long long cellZ{ cellCoordinate(modesZ[i], minZ) };
+    double squaredRadius{ cellSize * cellSize };
+
+    for (long long z{ cellZ - 1 }; z <= cellZ + 1; z++) {
+      for (long long y{ cellY - 1 }; y <= cellY + 1; y++) {
+        for (long long x{ cellX - 1 }; x <= cellX + 1; x++) {
+          if (x < 0 || y < 0 || z < 0) {
+            continue;
+          }
+          auto range = std::equal_range(
+            sortedKeys.begin(), sortedKeys.end(), cellKey(x, y, z)
+          );
+          for (auto key = range.first; key != range.second; ++key) {
+            Index j{ sortedModes[key - sortedKeys.begin()] };
+            double dx{ modesX[j] - modesX[i] };
+            double dy{ modesY[j] - modesY[i] };
+            double dz{ modesZ[j] - modesZ[i] };
+            if (dx * dx + dy * dy + dz * dz <= squaredRadius) {
+              neighbors.push_back(j);
+            }
+          }
+        }
+      }
+    }
+  }
+
+private:
+
+  long long cellCoordinate(const double coordinate, const double min) const {
+    return static_cast<long long>(std::floor((coordinate - min) / cellSize));
+  }
+
+  // Packs the cell coordinates into one key. Cells beyond the range of the
+  // key wrap around, which only adds candidates that fail the distance test.
+  static std::int64_t cellKey(
+      const long long cellX, const long long cellY, const long long cellZ
+  ) {
+    const long long mask{ (1LL << CELL_KEY_BITS) - 1 };
+    return ((cellX & mask) << (2 * CELL_KEY_BITS))
+      | ((cellY & mask) << CELL_KEY_BITS)
+      | (cellZ & mask);
+  }
+
+  const double* modesX;
+  const double* modesY;
+  const double* modesZ;
+  double cellSize;
+  double minX;
+  double minY;
+  double minZ;
+
+  std::vector<std::int64_t> cellKeys;
+  std::vector<Index> sortedModes;
+  std::vector<std::int64_t> sortedKeys;
+};
+
+}  // namespace
+
+
+template <typename Index>
+std::vector<Index> clusterModes(
+    const double* modesX, const double* modesY, const double* modesZ,
+    const Index numModes, const double eps, const int minPts
+) {
+  std::vector<Index> clusterIds(numModes, 0);
+  if (numModes == 0) {
+    return clusterIds;
+  }
+
+  ModeGrid<Index> grid{ modesX, modesY, modesZ, numModes, eps };
+
+  std::vector<bool> isVisited(numModes, false);
+  std::vector<Index> neighbors;
+  std::vector<Index> pendingModes;
+  Index numClusters{ 0 };
+
+  for (Index i{ 0 }; i < numModes; i++) {
+    if (isVisited[i]) {
+      continue;
+    }
+
+    // Modes that are not core modes are noise until a cluster reaches them
+    grid.findNeighbors(i, neighbors);
+    if (neighbors.size() < static_cast<std::size_t>(minPts)) {
+      continue;
+    }
+
+    // Start a new cluster and expand it from every core mode it reaches
+    numClusters += 1;
+    pendingModes = neighbors;
+    while (!pendingModes.empty()) {
+      Index j{ pendingModes.back() };
+      pendingModes.pop_back();
+      if (isVisited[j]) {
+        continue;
+      }
+      isVisited[j] = true;
+      clusterIds[j] = numClusters;
+
+      grid.findNeighbors(j, neighbors);
+      if (neighbors.size() >= static_cast<std::size_t>(minPts)) {
+        for (Index neighbor : neighbors) {
+          if (!isVisited[neighbor]) {
+            pendingModes.push_back(neighbor);
+          }
+        }
+      }
+    }
+  }
+
+  return clusterIds;
+}
+
+template std::vector<std::int32_t> clusterModes(
+  const double* modesX, const double* modesY, const double* modesZ,
+  const std::int32_t numModes, const double eps, const int minPts
+);
+template std::vector<std::int64_t> clusterModes(
+  const double* modesX, const double* modesY, const double* modesZ,
+  const std::int64_t numModes, const double eps, const int minPts
+);
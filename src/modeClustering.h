@@ -0,0 +1,26 @@
+#ifndef MODE_CLUSTERING_H
+#define MODE_CLUSTERING_H
+
+#include <cstdint>
+#include <vector>
+
+
+/** Clusters the modes with DBSCAN and returns the cluster ID of every mode.
+ *
+ *  The clusters are defined like those of dbscan::dbscan with the default
+ *  settings: a mode is a core mode if at least \p minPts modes, including
+ *  itself, lie within the distance \p eps. The clusters are numbered from 1
+ *  in the order of their first core mode, border modes belong to the first
+ *  cluster that reaches them, and 0 marks noise. The neighbors are looked up
+ *  in a grid with a cell size of \p eps.
+ *
+ *  \p Index is the type of the mode positions and cluster IDs. It is
+ *  instantiated for std::int32_t and, for 2^31 or more modes, std::int64_t.
+ */
+template <typename Index>
+std::vector<Index> clusterModes(
+  const double* modesX, const double* modesY, const double* modesZ,
+  const Index numModes, const double eps, const int minPts
+);
+
+#endif  // define MODE_CLUSTERING_H
@@ -0,0 +1,84 @@
+#include "modeTable.h"
+
+#include <climits>        // for INT_MAX
+#include <cmath>          // for std::floor, std::isfinite
+#include <stdexcept>
+#include <unordered_map>  // for std::unordered_map
+
+
+ModeTable createModeTable(
+    const double* modesX, const double* modesY, const double* modesZ,
+    const std::int64_t numModes, const double tolerance
+) {
+  ModeTable table;
+  table.modeIndices.resize(numModes);
+  std::unordered_map<std::int64_t, std::vector<int>> cells;
+  double squaredTolerance{ tolerance * tolerance };
+  // Identical modes share a cell of any size
+  double cellSize{ tolerance > 0 ? tolerance : 1.0 };
+  int searchRadius{ tolerance > 0 ? 1 : 0 };
+
+  for (std::int64_t mode{ 0 }; mode < numModes; mode++) {
+    double modeX{ modesX[mode] };
+    double modeY{ modesY[mode] };
+    double modeZ{ modesZ[mode] };
+    bool isFinite{
+      std::isfinite(modeX) && std::isfinite(modeY) && std::isfinite(modeZ)
+    };
+
+    std::int64_t cellX{ 0 };
+    std::int64_t cellY{ 0 };
+    std::int64_t cellZ{ 0 };
+    int target{ -1 };
+    if (isFinite) {
+      cellX = static_cast<std::int64_t>(std::floor(modeX / cellSize));
+      cellY = static_cast<std::int64_t>(std::floor(modeY / cellSize));
+      cellZ = static_cast<std::int64_t>(std::floor(modeZ / cellSize));
+
+      // Look for the earliest unique mode in the surrounding cells, so that
+      // the result does not depend on the order in which they are searched
+      for (int dx{ -searchRadius }; dx <= searchRadius; dx++) {
+        for (int dy{ -searchRadius }; dy <= searchRadius; dy++) {
+          for (int dz{ -searchRadius }; dz <= searchRadius; dz++) {
+            auto cell = cells.find(cellKey(cellX + dx, cellY + dy, cellZ + dz));
+            if (cell == cells.end()) {
+              continue;
+            }
+            // The unique modes of a cell are in order of creation
+            for (int candidate : cell->second) {
+              if (target >= 0 && candidate >= target) {
+                break;
+              }
+              double distX{ table.modesX[candidate] - modeX };
+              double distY{ table.modesY[candidate] - modeY };
+              double distZ{ table.modesZ[candidate] - modeZ };
+              if (distX * distX + distY * distY + distZ * distZ
+                  <= squaredTolerance) {
+                target = candidate;
+                break;
+              }
+            }
+          }
+        }
+      }
+    }
+
+    if (target < 0) {
+      if (table.modesX.size() == INT_MAX) {
+        throw std::runtime_error("There are too many unique modes to index.");
+      }
+      target = static_cast<int>(table.modesX.size());
+      table.modesX.push_back(modeX);
+      table.modesY.push_back(modeY);
+      table.modesZ.push_back(modeZ);
+      table.numSeeds.push_back(0);
+      if (isFinite) {
+        cells[cellKey(cellX, cellY, cellZ)].push_back(target);
+      }
+    }
+    table.numSeeds[target]++;
+    table.modeIndices[mode] = target;
+  }
+
+  return table;
+}
@@ -0,0 +1,48 @@
+#ifndef MODE_TABLE_H
+#define MODE_TABLE_H
+
+#include <cstdint>
+#include <vector>
+
+
+/** The modes of a set of seeds in compact form: the unique modes and, for
+ *  every seed, the position of its mode in the table.
+ */
+struct ModeTable {
+  std::vector<double> modesX;
+  std::vector<double> modesY;
+  std::vector<double> modesZ;
+  // Number of seeds that share each unique mode
+  std::vector<std::int64_t> numSeeds;
+  std::vector<std::int32_t> modeIndices;
+};
+
+
+/** Hashes the integer coordinates of a grid cell into a single key.
+ *  Collisions only cost time if the callers compare the exact positions.
+ */
+inline std::int64_t cellKey(
+    const std::int64_t cellX, const std::int64_t cellY, const std::int64_t cellZ
+) {
+  return (cellX * 73856093) ^ (cellY * 19349663) ^ (cellZ * 83492791);
+}
+
+
+/** Merges the modes of \p numModes seeds that lie within \p tolerance of
+ *  each other into a table of unique modes.
+ *
+ *  Every mode joins the earliest created unique mode within \p tolerance,
+ *  looked up in a grid with a cell size of \p tolerance, and the unique
+ *  modes keep the position of their first member, so no mode moves by more
+ *  than \p tolerance. A tolerance of 0 only merges identical modes. Non-finite
+ *  modes are never merged.
+ *
+ *  The number of modes may exceed the range of int, but the table holds at
+ *  most INT_MAX unique modes and throws std::runtime_error beyond that.
+ */
+ModeTable createModeTable(
+  const double* modesX, const double* modesY, const double* modesZ,
+  const std::int64_t numModes, const double tolerance
+);
+
+#endif  // define MODE_TABLE_H
@@ -0,0 +1,73 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <algorithm>  // for std::max, std::min
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+/** The number of threads to use for a requested number of threads.
+ *
+ *  Non-positive requests mean "all available cores".
+ */
+inline int resolveNumThreads(const int numThreads) {
+  if (numThreads > 0) {
+    return numThreads;
+  }
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+
+/** Calls \p body(i) for every i in [\p begin, \p end) on \p numThreads
+ *  threads.
+ *
+ *  The indices are handed out in chunks of \p chunkSize from a shared atomic
+ *  counter, so threads that finish their chunks early pick up more work.
+ *  \p body must be safe to call concurrently for different indices and must
+ *  neither throw nor call the R API. The indices are 64-bit, so loops over
+ *  point clouds with 2^31 or more points work as well.
+ */
+template <typename Body>
+void parallelFor(
+    const std::int64_t begin, const std::int64_t end, const int numThreads,
+    Body body, const int chunkSize = 64
+) {
+  int numWorkers{ static_cast<int>(std::min<std::int64_t>(
+    resolveNumThreads(numThreads), (end - begin + chunkSize - 1) / chunkSize
+  )) };
+
+  if (numWorkers <= 1) {
+    for (std::int64_t i{ begin }; i < end; i++) {
+      body(i);
+    }
+    return;
+  }
+
+  std::atomic<std::int64_t> nextChunk{ begin };
+  auto work = [&]() {
+    while (true) {
+      std::int64_t chunkBegin{ nextChunk.fetch_add(chunkSize) };
+      if (chunkBegin >= end) {
+        return;
+      }
+      std::int64_t chunkEnd{ std::min(end, chunkBegin + chunkSize) };
+      for (std::int64_t i{ chunkBegin }; i < chunkEnd; i++) {
+        body(i);
+      }
+    }
+  };
+
+  // The calling thread works as well
+  std::vector<std::thread> workers;
+  for (int worker{ 1 }; worker < numWorkers; worker++) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+#endif  // define PARALLEL_FOR_H
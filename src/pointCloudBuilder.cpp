@@ -0,0 +1,131 @@
+#include "pointCloudBuilder.h"
+
+#include <algorithm>  // for std::max, std::find
+#include <climits>    // for INT_MAX
+#include <cstdint>
+#include <cstring>    // for std::memcpy, std::memmove
+#include <stdexcept>
+
+
+namespace {
+
+// The capacity of the first allocation, so that small chunks do not cause
+// a reallocation each
+const std::size_t MIN_CAPACITY{ 1024 };
+
+}  // namespace
+
+
+PointCloudBuilder::PointCloudBuilder(
+    const std::vector<std::string>& attributeNames, const bool withWeights,
+    const std::size_t capacity
+) : names{ "X", "Y", "Z" }, withWeights{ withWeights }, size{ 0 },
+    columnCapacity{ 0 }, finalized{ false }, indexCrownDiameter{ 0.0 } {
+  if (withWeights) {
+    names.push_back("weight");
+  }
+  for (const std::string& name : attributeNames) {
+    if (name.empty() || std::find(names.begin(), names.end(), name) != names.end()) {
+      throw std::runtime_error(
+        "The attribute names must be unique and differ from X, Y, Z and weight."
+      );
+    }
+    names.push_back(name);
+  }
+  reserve(capacity);
+}
+
+
+void PointCloudBuilder::append(
+    const std::vector<const double*>& chunkColumns,
+    const std::size_t numChunkPoints
+) {
+  if (chunkColumns.size() != names.size()) {
+    throw std::runtime_error("The chunk must have every column of the point cloud.");
+  }
+  std::vector<double*> columns{ appendUninitialized(numChunkPoints) };
+  if (numChunkPoints == 0) {
+    return;
+  }
+  for (std::size_t column{ 0 }; column < names.size(); column++) {
+    std::memcpy(
+      columns[column], chunkColumns[column], numChunkPoints * sizeof(double)
+    );
+  }
+}
+
+
+std::vector<double*> PointCloudBuilder::appendUninitialized(
+    const std::size_t numChunkPoints
+) {
+  if (finalized) {
+    throw std::runtime_error(
+      "No points can be appended to a finalized point cloud."
+    );
+  }
+
+  if (size + numChunkPoints > columnCapacity) {
+    reserve(std::max(
+      size + numChunkPoints, std::max(2 * columnCapacity, MIN_CAPACITY)
+    ));
+  }
+  std::vector<double*> columns(names.size());
+  for (std::size_t column{ 0 }; column < names.size(); column++) {
+    columns[column] = values.data() + column * columnCapacity + size;
+  }
+  size += numChunkPoints;
+  return columns;
+}
+
+
+void PointCloudBuilder::finalize(const double crownDiameter2TreeHeight) {
+  if (!finalized) {
+    // Every column moves towards the front, so moving them in order never
+    // overwrites a column that is still to be moved
+    for (std::size_t column{ 1 }; size > 0 && column < names.size(); column++) {
+      std::memmove(
+        values.data() + column * size, values.data() + column * columnCapacity,
+        size * sizeof(double)
+      );
+    }
+    columnCapacity = size;
+    finalized = true;
+  }
+
+  if (crownDiameter2TreeHeight <= 0.0
+      || crownDiameter2TreeHeight == indexCrownDiameter) {
+    return;
+  }
+  smallIndex.reset();
+  bigIndex.reset();
+  if (size <= INT_MAX) {
+    smallIndex.reset(new HeightBandedGridIndex{
+      columnData(0), columnData(1), columnData(2),
+      static_cast<std::int32_t>(size), crownDiameter2TreeHeight
+    });
+  } else {
+    bigIndex.reset(new LargeHeightBandedGridIndex{
+      columnData(0), columnData(1), columnData(2),
+      static_cast<std::int64_t>(size), crownDiameter2TreeHeight
+    });
+  }
+  indexCrownDiameter = crownDiameter2TreeHeight;
+}
+
+
+void PointCloudBuilder::reserve(const std::size_t newCapacity) {
+  if (newCapacity <= columnCapacity) {
+    return;
+  }
+  std::vector<double> newValues(newCapacity * names.size());
+  for (std::size_t column{ 0 }; column < names.size(); column++) {
+    if (size > 0) {
+      std::memcpy(
+        newValues.data() + column * newCapacity,
+        values.data() + column * columnCapacity, size * sizeof(double)
+      );
+    }
+  }
+  values.swap(newValues);
+  columnCapacity = newCapacity;
+}
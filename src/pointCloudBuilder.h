@@ -0,0 +1,98 @@
+#ifndef POINT_CLOUD_BUILDER_H
+#define POINT_CLOUD_BUILDER_H
+
+#include "heightBandedGridIndex.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/** Collects a point cloud from chunks of points, e.g. from a decoder or a
+ *  database that delivers a few thousand points at a time.
+ *
+ *  The columns X, Y, Z, optionally weight, and the attributes are kept in
+ *  one buffer of doubles, where every column has room for capacity() points.
+ *  When a chunk does not fit, the capacity at least doubles, so appending n
+ *  points copies every point O(1) times on average.
+ *
+ *  finalize moves the columns together in place, so that they are stored
+ *  back to back like the columns of a matrix, and optionally builds the
+ *  spatial index of the improved mean shift. Afterwards no more points can
+ *  be appended. Errors throw std::runtime_error.
+ */
+class PointCloudBuilder {
+public:
+
+  /** Starts an empty point cloud with the columns X, Y, Z, weight if
+   *  \p withWeights, and \p attributeNames, in this order, and room for
+   *  \p capacity points.
+   */
+  PointCloudBuilder(
+    const std::vector<std::string>& attributeNames, const bool withWeights,
+    const std::size_t capacity = 0
+  );
+
+  /** Appends \p numChunkPoints points, whose values are given by one
+   *  pointer per column, in the order of columnNames().
+   */
+  void append(
+    const std::vector<const double*>& chunkColumns,
+    const std::size_t numChunkPoints
+  );
+
+  /** Appends \p numChunkPoints points with undefined values and returns one
+   *  pointer per column, in the order of columnNames(), to the values of the
+   *  new points, so that decoders can write them in place. The pointers are
+   *  valid until the next call of append, appendUninitialized or finalize.
+   */
+  std::vector<double*> appendUninitialized(const std::size_t numChunkPoints);
+
+  /** Stores the columns back to back and, if \p crownDiameter2TreeHeight is
+   *  positive, indexes the points for kernels of this ratio of crown
+   *  diameter to tree height. The index has 32-bit positions unless there
+   *  are more than INT_MAX points.
+   */
+  void finalize(const double crownDiameter2TreeHeight = 0.0);
+
+  const std::vector<std::string>& columnNames() const { return names; }
+  int numColumns() const { return static_cast<int>(names.size()); }
+  std::size_t numPoints() const { return size; }
+  std::size_t capacity() const { return columnCapacity; }
+  bool isFinalized() const { return finalized; }
+  bool hasWeights() const { return withWeights; }
+
+  /** The values of the column at position \p column of columnNames(). */
+  const double* columnData(const int column) const {
+    return values.data() + column * columnCapacity;
+  }
+
+  /** The index of finalize, or null if it was not built or has the other
+   *  type.
+   */
+  const HeightBandedGridIndex* index() const { return smallIndex.get(); }
+  const LargeHeightBandedGridIndex* largeIndex() const {
+    return bigIndex.get();
+  }
+  double indexCrownDiameter2TreeHeight() const {
+    return indexCrownDiameter;
+  }
+
+private:
+
+  /** Moves the columns into a buffer with room for \p newCapacity points. */
+  void reserve(const std::size_t newCapacity);
+
+  std::vector<std::string> names;
+  bool withWeights;
+  std::vector<double> values;
+  std::size_t size;
+  std::size_t columnCapacity;
+  bool finalized;
+  std::unique_ptr<HeightBandedGridIndex> smallIndex;
+  std::unique_ptr<LargeHeightBandedGridIndex> bigIndex;
+  double indexCrownDiameter;
+};
+
+#endif  // define POINT_CLOUD_BUILDER_H
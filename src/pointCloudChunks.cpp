@@ -0,0 +1,291 @@
+#include "pointCloudBuilder.h"
+#include "pointColumns.h"
+
+#include <Rcpp.h>
+#include <R_ext/Altrep.h>
+#include <algorithm>  // for std::min
+#include <climits>    // for INT_MAX
+#include <cstring>    // for std::memcpy
+#include <string>
+#include <vector>
+
+
+namespace {
+
+/** The values of an ALTREP vector in the buffer of a finalized builder. */
+struct BuilderVector {
+  const double* data;
+  R_xlen_t length;
+};
+
+R_altrep_class_t builderRealClass;
+
+BuilderVector* getBuilderVector(SEXP vector) {
+  return static_cast<BuilderVector*>(R_ExternalPtrAddr(R_altrep_data1(vector)));
+}
+
+void finalizeBuilderVector(SEXP pointer) {
+  delete static_cast<BuilderVector*>(R_ExternalPtrAddr(pointer));
+  R_ClearExternalPtr(pointer);
+}
+
+R_xlen_t builderLength(SEXP vector) {
+  return getBuilderVector(vector)->length;
+}
+
+Rboolean builderInspect(
+    SEXP vector, int, int, int, void (*)(SEXP, int, int, int)
+) {
+  Rprintf(
+    " column of a point cloud builder (%.0f values)\n",
+    static_cast<double>(getBuilderVector(vector)->length)
+  );
+  return TRUE;
+}
+
+// Rcpp always asks for a writeable pointer. The vectors are marked as not
+// mutable, so R duplicates them before it modifies them.
+void* builderDataptr(SEXP vector, Rboolean) {
+  return const_cast<double*>(getBuilderVector(vector)->data);
+}
+
+const void* builderDataptrOrNull(SEXP vector) {
+  return getBuilderVector(vector)->data;
+}
+
+double builderElt(SEXP vector, R_xlen_t i) {
+  return getBuilderVector(vector)->data[i];
+}
+
+R_xlen_t builderGetRegion(
+    SEXP vector, R_xlen_t start, R_xlen_t size, double* buffer
+) {
+  BuilderVector* values{ getBuilderVector(vector) };
+  R_xlen_t numValues{ std::min(size, values->length - start) };
+  if (numValues > 0) {
+    std::memcpy(buffer, values->data + start, numValues * sizeof(double));
+  }
+  return numValues < 0 ? 0 : numValues;
+}
+
+PointCloudBuilder& getFinalizedBuilder(SEXP builder) {
+  Rcpp::XPtr<PointCloudBuilder> pointCloud{ builder };
+  if (!pointCloud->isFinalized()) {
+    Rcpp::stop("The point cloud builder has not been finalized.");
+  }
+  return *pointCloud;
+}
+
+// Returns numColumns columns of the finalized builder, starting with
+// firstColumn, as one vector. The external pointer of the vector protects
+// the builder, so the buffer lives as long as the vector.
+SEXP createBuilderVector(
+    SEXP builder, const PointCloudBuilder& pointCloud, const int firstColumn,
+    const int numColumns
+) {
+  BuilderVector* values{ new BuilderVector{
+    pointCloud.columnData(firstColumn),
+    static_cast<R_xlen_t>(pointCloud.numPoints() * numColumns)
+  } };
+  Rcpp::RObject pointer{ R_MakeExternalPtr(values, R_NilValue, builder) };
+  R_RegisterCFinalizerEx(pointer, finalizeBuilderVector, TRUE);
+  Rcpp::RObject vector{ R_new_altrep(builderRealClass, pointer, R_NilValue) };
+  MARK_NOT_MUTABLE(vector);
+  return vector;
+}
+
+// Returns all columns of the finalized builder as vectors
+Rcpp::List createBuilderColumns(SEXP builder) {
+  const PointCloudBuilder& pointCloud{ getFinalizedBuilder(builder) };
+  int numColumns{ pointCloud.numColumns() };
+  Rcpp::List result(numColumns);
+  for (int column{ 0 }; column < numColumns; column++) {
+    result[column] = createBuilderVector(builder, pointCloud, column, 1);
+  }
+  result.attr("names") = Rcpp::wrap(pointCloud.columnNames());
+  return createColumnTable(
+    result, static_cast<R_xlen_t>(pointCloud.numPoints())
+  );
+}
+
+}  // namespace
+
+
+// [[Rcpp::init]]
+void registerBuilderVectorClass(DllInfo* dll){
+  builderRealClass = R_make_altreal_class("builder_real", "meanshiftr", dll);
+  R_set_altrep_Length_method(builderRealClass, builderLength);
+  R_set_altrep_Inspect_method(builderRealClass, builderInspect);
+  R_set_altvec_Dataptr_method(builderRealClass, builderDataptr);
+  R_set_altvec_Dataptr_or_null_method(builderRealClass, builderDataptrOrNull);
+  R_set_altreal_Elt_method(builderRealClass, builderElt);
+  R_set_altreal_Get_region_method(builderRealClass, builderGetRegion);
+}
+
+
+//' Start a point cloud from chunks of points
+//'
+//' Creates a builder that collects the points of a point cloud from chunks,
+//' e.g. from a decoder, a database or message files, so the chunks do not
+//' have to be bound into one matrix in R. The columns are stored in native
+//' buffers whose capacity at least doubles whenever a chunk does not fit.
+//'
+//' @param attributes Character vector. Names of additional numeric columns
+//'   that every chunk provides, e.g. "Intensity".
+//' @param withWeights Logical scalar. Whether every chunk provides a weight
+//'   per point, which is stored in the column "weight".
+//' @param capacity Numeric scalar. Number of points to make room for
+//'   initially. If the final number of points is known, no buffer is ever
+//'   reallocated.
+//'
+//' @return An external pointer of class "PointCloudBuilder", for
+//'   \code{appendPointChunk} and \code{finalizePointCloudBuilder}.
+//'
+//' @export
+// [[Rcpp::export]]
+SEXP createPointCloudBuilder(
+    Rcpp::CharacterVector attributes = Rcpp::CharacterVector::create(),
+    bool withWeights = false, double capacity = 0
+){
+  if (!(capacity >= 0)) {
+    Rcpp::stop("capacity must not be negative.");
+  }
+  Rcpp::XPtr<PointCloudBuilder> builder(
+    new PointCloudBuilder(
+      Rcpp::as<std::vector<std::string> >(attributes), withWeights,
+      static_cast<std::size_t>(capacity)
+    ),
+    true
+  );
+  builder.attr("class") = "PointCloudBuilder";
+  return builder;
+}
+
+
+//' Append a chunk of points to a point cloud builder
+//'
+//' @param builder External pointer of \code{createPointCloudBuilder}.
+//' @param X,Y,Z Numeric vectors with the coordinates of the points of the
+//'   chunk.
+//' @param weights NULL or a numeric vector with the weight of every point.
+//'   Required if and only if the builder has weights.
+//' @param attributes NULL or a named list, e.g. a data.frame, with a numeric
+//'   vector for every attribute of the builder. Other elements are ignored.
+//'
+//' @return NULL, invisibly.
+//'
+//' @export
+// [[Rcpp::export]]
+void appendPointChunk(
+    SEXP builder, Rcpp::NumericVector X, Rcpp::NumericVector Y,
+    Rcpp::NumericVector Z,
+    Rcpp::Nullable<Rcpp::NumericVector> weights = R_NilValue,
+    Rcpp::Nullable<Rcpp::List> attributes = R_NilValue
+){
+  Rcpp::XPtr<PointCloudBuilder> pointCloud{ builder };
+  PointColumns points{ getPointColumns(X, Y, Z) };
+
+  // Keep the converted chunk columns alive until they are appended
+  std::vector<Rcpp::NumericVector> columns{ X, Y, Z };
+  if (pointCloud->hasWeights() != weights.isNotNull()) {
+    Rcpp::stop(pointCloud->hasWeights()
+      ? "The builder needs the weights of the points."
+      : "The builder was created without weights.");
+  }
+  if (weights.isNotNull()) {
+    columns.push_back(Rcpp::NumericVector(weights));
+  }
+  const std::vector<std::string>& names{ pointCloud->columnNames() };
+  if (columns.size() < names.size()) {
+    if (attributes.isNull()) {
+      Rcpp::stop("The builder needs the attributes of the points.");
+    }
+    Rcpp::List chunkAttributes(attributes);
+    for (std::size_t column{ columns.size() }; column < names.size(); column++) {
+      if (!chunkAttributes.containsElementNamed(names[column].c_str())) {
+        Rcpp::stop("The attribute " + names[column] + " is missing.");
+      }
+      SEXP values{ chunkAttributes[names[column]] };
+      columns.push_back(Rcpp::NumericVector(values));
+    }
+  }
+
+  std::vector<const double*> chunkColumns;
+  for (const Rcpp::NumericVector& column : columns) {
+    if (column.size() != points.numPoints) {
+      Rcpp::stop("All columns of the chunk must have the same length.");
+    }
+    chunkColumns.push_back(column.begin());
+  }
+  pointCloud->append(chunkColumns, static_cast<std::size_t>(points.numPoints));
+}
+
+
+//' Finalize a point cloud builder
+//'
+//' Stores the columns of the builder back to back, so the coordinates can
+//' be used as a matrix without copying them, and optionally indexes the
+//' points for \code{meanShiftClassicImprovedBuilder}. Afterwards no more
+//' chunks can be appended. Finalizing again only rebuilds the index.
+//'
+//' @param builder External pointer of \code{createPointCloudBuilder}.
+//' @param crownDiameter2TreeHeight Numeric scalar. If positive, the points
+//'   are indexed for kernels with this ratio of crown diameter to tree
+//'   height.
+//'
+//' @return The columns of \code{pointCloudBuilderColumns}.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List finalizePointCloudBuilder(
+    SEXP builder, double crownDiameter2TreeHeight = 0
+){
+  Rcpp::XPtr<PointCloudBuilder> pointCloud{ builder };
+  pointCloud->finalize(crownDiameter2TreeHeight);
+  return createBuilderColumns(builder);
+}
+
+
+//' Get the columns of a finalized point cloud builder
+//'
+//' @param builder External pointer of \code{createPointCloudBuilder}, which
+//'   has been finalized.
+//'
+//' @return A data.frame with the columns X, Y, Z, weight if the builder has
+//'   weights, and the attributes, or a named list of long vectors if there
+//'   are more than 2^31 - 1 points. The vectors are views of the buffers of
+//'   the builder, so they are not copied onto the R heap, and they keep the
+//'   builder alive. Modifying a vector copies it.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List pointCloudBuilderColumns(SEXP builder){
+  return createBuilderColumns(builder);
+}
+
+
+//' Get the coordinates of a finalized point cloud builder as a matrix
+//'
+//' @param builder External pointer of \code{createPointCloudBuilder}, which
+//'   has been finalized.
+//'
+//' @return A matrix with the columns X, Y and Z, for the mean shift
+//'   functions that take a matrix. It is a view of the buffer of the
+//'   builder like the columns of \code{pointCloudBuilderColumns}.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::NumericMatrix pointCloudBuilderMatrix(SEXP builder){
+  const PointCloudBuilder& pointCloud{ getFinalizedBuilder(builder) };
+  if (pointCloud.numPoints() > INT_MAX) {
+    Rcpp::stop("R matrices cannot have more than 2^31 - 1 rows.");
+  }
+  Rcpp::RObject matrix{ createBuilderVector(builder, pointCloud, 0, 3) };
+  matrix.attr("dim") = Rcpp::IntegerVector::create(
+    static_cast<int>(pointCloud.numPoints()), 3
+  );
+  matrix.attr("dimnames") = Rcpp::List::create(
+    R_NilValue, Rcpp::CharacterVector::create("X", "Y", "Z")
+  );
+  return Rcpp::NumericMatrix(matrix);
+}
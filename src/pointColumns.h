@@ -0,0 +1,65 @@
+#ifndef POINT_COLUMNS_H
+#define POINT_COLUMNS_H
+
+#include <Rcpp.h>
+#include <climits>  // for INT_MAX
+
+
+/** The coordinates of a point cloud as three columns that are read in
+ *  place, either from the columns of a matrix or from three vectors, such as
+ *  the columns of a data.frame. The memory belongs to the R objects, which
+ *  must outlive the view. Vectors can be long vectors with 2^31 or more
+ *  elements.
+ */
+struct PointColumns {
+  const double* pointsX;
+  const double* pointsY;
+  const double* pointsZ;
+  R_xlen_t numPoints;
+};
+
+
+/** The first three columns of \p pointCloud. */
+inline PointColumns getPointColumns(const Rcpp::NumericMatrix& pointCloud) {
+  if (pointCloud.ncol() < 3) {
+    Rcpp::stop("pointCloud must have the columns X, Y and Z.");
+  }
+  R_xlen_t numPoints{ pointCloud.nrow() };
+  const double* pointsX{ pointCloud.begin() };
+  return PointColumns{
+    pointsX, pointsX + numPoints, pointsX + 2 * numPoints, numPoints
+  };
+}
+
+
+/** Three vectors of the same length. Vectors of doubles are not copied,
+ *  since Rcpp wraps them without converting them.
+ */
+inline PointColumns getPointColumns(
+    const Rcpp::NumericVector& pointsX, const Rcpp::NumericVector& pointsY,
+    const Rcpp::NumericVector& pointsZ
+) {
+  if (pointsY.size() != pointsX.size() || pointsZ.size() != pointsX.size()) {
+    Rcpp::stop("pointsX, pointsY and pointsZ must have the same length.");
+  }
+  return PointColumns{
+    pointsX.begin(), pointsY.begin(), pointsZ.begin(), pointsX.size()
+  };
+}
+
+
+/** Turns the named \p columns with \p numRows elements each into a
+ *  data.frame. Since the row names of a data.frame are integers, columns
+ *  with more than INT_MAX elements stay a named list.
+ */
+inline Rcpp::List createColumnTable(Rcpp::List columns, const R_xlen_t numRows) {
+  if (numRows <= INT_MAX) {
+    columns.attr("row.names") = Rcpp::IntegerVector::create(
+      NA_INTEGER, -static_cast<int>(numRows)
+    );
+    columns.attr("class") = "data.frame";
+  }
+  return columns;
+}
+
+#endif  // define POINT_COLUMNS_H
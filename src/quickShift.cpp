@@ -0,0 +1,155 @@
+#include "cylinderKernel.h"
+#include "heightBandedGridIndex.h"
+#include "seedSet.h"
+
+#include <Rcpp.h>
+#include <string>
+#include <vector>
+
+
+//' Quick shift clustering
+//'
+//' Delineates tree crowns from lidar point clouds with quick shift, a
+//' non-iterative alternative to the adaptive mean shift that uses the same
+//' cylinder kernel as \code{meanShiftClassicImproved}.
+//'
+//' @param pointCloud Point cloud data in a three-column matrix where the
+//'   columns represent X, Y and Z coordinates and each row represents one
+//'   point.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param isSeed Logical vector with one element per point or NULL. If
+//'   given, only the modes of the points where it is TRUE are calculated,
+//'   while all points still act as neighbors. NULL calculates the modes of
+//'   all points.
+//' @param output Character scalar. "full" returns the coordinates of the
+//'   seeds and their modes, "modes" only the columns modeX, modeY and modeZ,
+//'   and "indexed" only the integer column modeIndex, which points into the
+//'   table of unique modes in the attribute "modes".
+//' @param modeTolerance Numeric scalar. If \code{output} is "indexed", modes
+//'   within this distance of each other share one row of the mode table.
+//' @param outputFile Character scalar. If not empty, the result is stored in
+//'   a column file at this path, which is created or overwritten, and its
+//'   columns are returned as mapped vectors like those of
+//'   \code{readColumnFile}. Except for "indexed", the modes are written to
+//'   the file as they are found, so they never occupy the R heap.
+//'
+//' @return A data.frame with the coordinates of the seed points in
+//'   \code{pointCloud} and three additional columns with the coordinates of
+//'   the calculated modes, or one of the lean forms selected by
+//'   \code{output}.
+//'
+//' @details First, the kernel density of every point is estimated by summing
+//'   the kernel weights of all points within the kernel centered on it. Then
+//'   every point is linked to the nearest point within its kernel that has a
+//'   higher density (ties are broken by row number). The links form a forest
+//'   and the root of each tree is the mode of all points in the tree. Every
+//'   point costs two neighborhood passes, instead of one pass per iteration
+//'   of the mean shift. With \code{isSeed}, densities and links are only
+//'   calculated for the points that are reached from the seeds.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame quickShift(
+    Rcpp::NumericMatrix pointCloud,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    Rcpp::Nullable<Rcpp::LogicalVector> isSeed = R_NilValue,
+    std::string output = "full", double modeTolerance = 0.01,
+    std::string outputFile = ""
+){
+  ModesOptions options{
+    selectModesOptions(output, modeTolerance, outputFile)
+  };
+  int nrows{ pointCloud.nrow() };
+  std::vector<int> seedRows{ selectSeedRows(isSeed, nrows) };
+  int numSeeds{ static_cast<int>(seedRows.size()) };
+
+  const double* pointsX{ pointCloud.begin() };
+  const double* pointsY{ pointsX + nrows };
+  const double* pointsZ{ pointsY + nrows };
+  HeightBandedGridIndex index{
+    pointsX, pointsY, pointsZ, nrows, crownDiameter2TreeHeight
+  };
+
+  // Estimate the kernel density at a point on first use. Densities are never
+  // negative, so -1 marks the ones that are not known yet.
+  std::vector<double> densities(nrows, -1.0);
+  auto density = [&](int i) {
+    if (densities[i] < 0.0) {
+      double sumWeights{ 0.0 };
+      forEachWeightedNeighbor(
+        index, pointsX[i], pointsY[i], pointsZ[i],
+        crownDiameter2TreeHeight, crownHeight2TreeHeight,
+        [&sumWeights](double, double, double, int, double weight) {
+          sumWeights += weight;
+        }
+      );
+      densities[i] = sumWeights;
+    }
+    return densities[i];
+  };
+
+  // Link a point to its nearest neighbor with a higher density. -1 marks the
+  // points that are not linked yet.
+  auto isDenser = [&density](int a, int b) {
+    double densityA{ density(a) };
+    double densityB{ density(b) };
+    return densityA > densityB || (densityA == densityB && a > b);
+  };
+  std::vector<int> parents(nrows, -1);
+  auto link = [&](int i) {
+    parents[i] = i;
+    double smallestSquaredDistance{ 0.0 };
+    forEachWeightedNeighbor(
+      index, pointsX[i], pointsY[i], pointsZ[i],
+      crownDiameter2TreeHeight, crownHeight2TreeHeight,
+      [&](double neighborX, double neighborY, double neighborZ, int j, double) {
+        if (!isDenser(j, i)) {
+          return;
+        }
+        double dx{ neighborX - pointsX[i] };
+        double dy{ neighborY - pointsY[i] };
+        double dz{ neighborZ - pointsZ[i] };
+        double squaredDistance{ dx * dx + dy * dy + dz * dz };
+        if (parents[i] == i || squaredDistance < smallestSquaredDistance) {
+          parents[i] = j;
+          smallestSquaredDistance = squaredDistance;
+        }
+      }
+    );
+  };
+
+  // Follow the links from every seed to its root. Since densities strictly
+  // increase along the links there are no cycles. Compressing the paths on
+  // the way makes every link be followed only once.
+  ModeVectors modes{ numSeeds, options };
+  std::vector<int> path;
+  for (int seed{ 0 }; seed < numSeeds; seed++) {
+    int root{ seedRows[seed] };
+    while (true) {
+      if (parents[root] < 0) {
+        link(root);
+      }
+      if (parents[root] == root) {
+        break;
+      }
+      path.push_back(root);
+      root = parents[root];
+    }
+    for (int node : path) {
+      parents[node] = root;
+    }
+    path.clear();
+
+    modes.modesX[seed] = pointsX[root];
+    modes.modesY[seed] = pointsY[root];
+    modes.modesZ[seed] = pointsZ[root];
+  }
+
+  // Return the result as a data.frame with XYZ-coordinates of all seeds and
+  // their corresponding modes, or in the requested lean form
+  return modes.createDataFrame(pointCloud, seedRows);
+}
@@ -0,0 +1,225 @@
+#include "lasFile.h"
+#include "parallelFor.h"
+#include "pointCloudBuilder.h"
+
+#include <Rcpp.h>
+#include <algorithm>  // for std::min
+#include <cmath>      // for std::isnan
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+// Number of point records that one thread filters or decodes at a time
+const std::uint64_t RECORDS_PER_CHUNK{ 65536 };
+
+LasPointFilter createFilter(
+    Rcpp::Nullable<Rcpp::IntegerVector> classifications,
+    Rcpp::Nullable<Rcpp::IntegerVector> returnNumbers,
+    Rcpp::Nullable<Rcpp::NumericVector> bbox, const double minHeight
+) {
+  LasPointFilter filter;
+  if (classifications.isNotNull()) {
+    filter.classifications = Rcpp::as<std::vector<int> >(classifications);
+  }
+  if (returnNumbers.isNotNull()) {
+    filter.returnNumbers = Rcpp::as<std::vector<int> >(returnNumbers);
+  }
+  if (bbox.isNotNull()) {
+    Rcpp::NumericVector bounds{ bbox };
+    if (bounds.size() != 4) {
+      Rcpp::stop("bbox must have the elements xmin, ymin, xmax and ymax.");
+    }
+    filter.minX = bounds[0];
+    filter.minY = bounds[1];
+    filter.maxX = bounds[2];
+    filter.maxY = bounds[3];
+  }
+  if (!std::isnan(minHeight)) {
+    filter.minZ = minHeight;
+  }
+  return filter;
+}
+
+// Counts the kept points of every chunk of records, so that every chunk
+// knows where its points go. Returns the offset of the first point of every
+// chunk and, as last element, the number of kept points.
+std::vector<std::uint64_t> countKeptPoints(
+    const LasFile& las, const LasPointFilter& filter, const int numThreads
+) {
+  std::uint64_t numRecords{ las.header().numPoints };
+  int numChunks{ static_cast<int>(
+    (numRecords + RECORDS_PER_CHUNK - 1) / RECORDS_PER_CHUNK
+  ) };
+  std::vector<std::uint64_t> chunkOffsets(numChunks + 1, 0);
+  parallelFor(0, numChunks, numThreads, [&](int chunk) {
+    std::uint64_t first{ chunk * RECORDS_PER_CHUNK };
+    std::uint64_t last{ std::min(numRecords, first + RECORDS_PER_CHUNK) };
+    std::uint64_t numKept{ 0 };
+    for (std::uint64_t i{ first }; i < last; i++) {
+      if (las.isKept(i, filter)) {
+        numKept++;
+      }
+    }
+    chunkOffsets[chunk + 1] = numKept;
+  }, 1);
+  for (int chunk{ 0 }; chunk < numChunks; chunk++) {
+    chunkOffsets[chunk + 1] += chunkOffsets[chunk];
+  }
+  return chunkOffsets;
+}
+
+// Decodes the kept points straight into the columns x, y and z and stores
+// the position of every point among the points of the file, starting at 1
+void decodeKeptPoints(
+    const LasFile& las, const LasPointFilter& filter,
+    const std::vector<std::uint64_t>& chunkOffsets,
+    double* x, double* y, double* z, double* indices, const int numThreads
+) {
+  std::uint64_t numRecords{ las.header().numPoints };
+  int numChunks{ static_cast<int>(chunkOffsets.size()) - 1 };
+  parallelFor(0, numChunks, numThreads, [&](int chunk) {
+    std::uint64_t first{ chunk * RECORDS_PER_CHUNK };
+    std::uint64_t last{ std::min(numRecords, first + RECORDS_PER_CHUNK) };
+    std::uint64_t row{ chunkOffsets[chunk] };
+    for (std::uint64_t i{ first }; i < last; i++) {
+      if (las.isKept(i, filter)) {
+        las.coordinates(i, x[row], y[row], z[row]);
+        indices[row] = static_cast<double>(i + 1);
+        row++;
+      }
+    }
+  }, 1);
+}
+
+}  // namespace
+
+
+//' Read the points of a LAS file
+//'
+//' Reads the coordinates of the points of an uncompressed LAS file of
+//' version 1.2 to 1.4 with one of the point data formats 0 to 10. The file
+//' is memory-mapped and the scaled integer coordinates are decoded directly
+//' into the matrix that the mean shift functions take, so neither the whole
+//' file nor a table of all attributes is copied into memory.
+//'
+//' @param file Character scalar. Path of the LAS file.
+//' @param classifications NULL or an integer vector. If given, only points
+//'   with one of these classifications are read.
+//' @param returnNumbers NULL or an integer vector. If given, only points
+//'   with one of these return numbers are read.
+//' @param bbox NULL or a numeric vector with the elements xmin, ymin, xmax
+//'   and ymax. If given, only points inside this rectangle are read.
+//' @param minHeight Numeric scalar. If not NA, points with a lower
+//'   Z-coordinate are not read, like the \code{minHeight} of the mean shift
+//'   functions for height-normalized point clouds.
+//' @param numThreads Integer scalar. Number of threads that decode points.
+//'   Non-positive values use all available cores.
+//'
+//' @return A numeric matrix with the columns X, Y and Z and one row per
+//'   point that passes all filters, in the order of the file. The attribute
+//'   \code{pointIndices} holds the position of every row among the points of
+//'   the file, starting at 1.
+//'
+//' @details Points are filtered while they are decoded, so points that are
+//'   not read cost neither memory nor coordinate conversions. The mean shift
+//'   functions copy the matrix into their spatial index on every call;
+//'   \code{readLasPointsBuilder} decodes the points into a builder whose
+//'   index is built once instead.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::NumericMatrix readLasPoints(
+    std::string file,
+    Rcpp::Nullable<Rcpp::IntegerVector> classifications = R_NilValue,
+    Rcpp::Nullable<Rcpp::IntegerVector> returnNumbers = R_NilValue,
+    Rcpp::Nullable<Rcpp::NumericVector> bbox = R_NilValue,
+    double minHeight = NA_REAL, int numThreads = 0
+){
+  LasFile las{ file };
+  LasPointFilter filter{
+    createFilter(classifications, returnNumbers, bbox, minHeight)
+  };
+  std::vector<std::uint64_t> chunkOffsets{
+    countKeptPoints(las, filter, numThreads)
+  };
+
+  std::uint64_t numPoints{ chunkOffsets.back() };
+  if (numPoints > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+    Rcpp::stop(
+      "The LAS file has too many points for one matrix. "
+      "writeLasColumnFile can hold them in a column file instead."
+    );
+  }
+  Rcpp::NumericMatrix pointCloud(static_cast<int>(numPoints), 3);
+  Rcpp::NumericVector pointIndices(static_cast<R_xlen_t>(numPoints));
+  double* x{ pointCloud.begin() };
+  double* y{ x + numPoints };
+  double* z{ y + numPoints };
+  double* indices{ pointIndices.begin() };
+
+  decodeKeptPoints(las, filter, chunkOffsets, x, y, z, indices, numThreads);
+
+  Rcpp::colnames(pointCloud) = Rcpp::CharacterVector::create("X", "Y", "Z");
+  pointCloud.attr("pointIndices") = pointIndices;
+  return pointCloud;
+}
+
+
+//' Read the points of a LAS file into a point cloud builder
+//'
+//' Like \code{readLasPoints}, but decodes the coordinates straight into the
+//' native buffers of a point cloud builder, which is finalized and
+//' optionally indexed for \code{meanShiftClassicImprovedBuilder}. The mean
+//' shift functions then read the points in place and the index is built
+//' once for all of them, instead of once per call on a copy of a matrix.
+//'
+//' @param file Character scalar. Path of the LAS file.
+//' @param classifications,returnNumbers,bbox,minHeight The filters of
+//'   \code{readLasPoints}.
+//' @param crownDiameter2TreeHeight Numeric scalar. If positive, the points
+//'   are indexed for kernels with this ratio of crown diameter to tree
+//'   height, as in \code{finalizePointCloudBuilder}.
+//' @param numThreads Integer scalar. Number of threads that decode points.
+//'   Non-positive values use all available cores.
+//'
+//' @return A finalized point cloud builder with the columns X, Y, Z and
+//'   pointIndex, which holds the position of every point among the points of
+//'   the file, starting at 1. Unlike the matrix of \code{readLasPoints}, it
+//'   may hold more than 2^31 - 1 points.
+//'
+//' @export
+// [[Rcpp::export]]
+SEXP readLasPointsBuilder(
+    std::string file,
+    Rcpp::Nullable<Rcpp::IntegerVector> classifications = R_NilValue,
+    Rcpp::Nullable<Rcpp::IntegerVector> returnNumbers = R_NilValue,
+    Rcpp::Nullable<Rcpp::NumericVector> bbox = R_NilValue,
+    double minHeight = NA_REAL, double crownDiameter2TreeHeight = 0,
+    int numThreads = 0
+){
+  LasFile las{ file };
+  LasPointFilter filter{
+    createFilter(classifications, returnNumbers, bbox, minHeight)
+  };
+  std::vector<std::uint64_t> chunkOffsets{
+    countKeptPoints(las, filter, numThreads)
+  };
+
+  std::size_t numPoints{ static_cast<std::size_t>(chunkOffsets.back()) };
+  Rcpp::XPtr<PointCloudBuilder> builder(
+    new PointCloudBuilder({ "pointIndex" }, false, numPoints), true
+  );
+  std::vector<double*> columns{ builder->appendUninitialized(numPoints) };
+  decodeKeptPoints(
+    las, filter, chunkOffsets, columns[0], columns[1], columns[2], columns[3],
+    numThreads
+  );
+
+  builder->finalize(crownDiameter2TreeHeight);
+  builder.attr("class") = "PointCloudBuilder";
+  return builder;
+}
@@ -0,0 +1,309 @@
+#ifndef SEED_SET_H
+#define SEED_SET_H
+
+#include "columnFile.h"
+#include "mappedColumns.h"
+#include "modeTable.h"
+#include "pointColumns.h"
+
+#include <Rcpp.h>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/** Returns the rows of the points whose modes are to be calculated.
+ *
+ *  All rows if \p isSeed is NULL, otherwise the rows where \p isSeed is TRUE.
+ *  Missing values count as FALSE. The rows have the type of \p numPoints,
+ *  so point clouds that fit into an R matrix keep 32-bit rows and only long
+ *  vectors of coordinates need R_xlen_t.
+ */
+template <typename Index>
+std::vector<Index> selectSeedRows(
+    const Rcpp::Nullable<Rcpp::LogicalVector>& isSeed, const Index numPoints
+) {
+  std::vector<Index> seedRows;
+  if (isSeed.isNull()) {
+    seedRows.resize(numPoints);
+    for (Index i{ 0 }; i < numPoints; i++) {
+      seedRows[i] = i;
+    }
+    return seedRows;
+  }
+
+  Rcpp::LogicalVector seedMask(isSeed.get());
+  if (seedMask.size() != numPoints) {
+    Rcpp::stop("isSeed must have one element per point.");
+  }
+  for (Index i{ 0 }; i < numPoints; i++) {
+    if (seedMask[i] == TRUE) {
+      seedRows.push_back(i);
+    }
+  }
+  return seedRows;
+}
+
+
+/** The forms in which the mean shift functions return the modes. */
+enum class ModesOutput {
+  // The coordinates of the seeds and their modes
+  full,
+  // Only the coordinates of the modes
+  modes,
+  // The index of the mode of every seed in a table of unique modes
+  indexed
+};
+
+
+/** Parses the \p output argument of the mean shift functions. */
+inline ModesOutput selectModesOutput(const std::string& output) {
+  if (output == "full") {
+    return ModesOutput::full;
+  }
+  if (output == "modes") {
+    return ModesOutput::modes;
+  }
+  if (output == "indexed") {
+    return ModesOutput::indexed;
+  }
+  Rcpp::stop("output must be \"full\", \"modes\" or \"indexed\".");
+}
+
+
+/** The form and destination of the result of the mean shift functions. */
+struct ModesOptions {
+  ModesOutput output;
+  // Distance within which modes share a row of the table of unique modes
+  double modeTolerance;
+  // Path of the column file that receives the result, or empty
+  std::string outputFile;
+};
+
+
+/** Parses the \p output, \p modeTolerance and \p outputFile arguments of
+ *  the mean shift functions.
+ */
+inline ModesOptions selectModesOptions(
+    const std::string& output, const double modeTolerance,
+    const std::string& outputFile
+) {
+  if (!(modeTolerance >= 0.0)) {
+    Rcpp::stop("modeTolerance must not be negative.");
+  }
+  return ModesOptions{ selectModesOutput(output), modeTolerance, outputFile };
+}
+
+
+/** Merges the modes into a table of unique modes and stores the 1-based
+ *  position of the unique mode of every seed in \p modeIndices.
+ */
+inline Rcpp::DataFrame createModeTableDataFrame(
+    const Rcpp::NumericVector& modesX, const Rcpp::NumericVector& modesY,
+    const Rcpp::NumericVector& modesZ, const double modeTolerance,
+    int* modeIndices
+) {
+  ModeTable table;
+  try {
+    table = createModeTable(
+      modesX.begin(), modesY.begin(), modesZ.begin(), modesX.size(),
+      modeTolerance
+    );
+  } catch (const std::exception& error) {
+    Rcpp::stop(error.what());
+  }
+  for (std::size_t seed{ 0 }; seed < table.modeIndices.size(); seed++) {
+    modeIndices[seed] = table.modeIndices[seed] + 1;
+  }
+  return Rcpp::DataFrame::create(
+    Rcpp::Named("modeX") = Rcpp::wrap(table.modesX),
+    Rcpp::Named("modeY") = Rcpp::wrap(table.modesY),
+    Rcpp::Named("modeZ") = Rcpp::wrap(table.modesZ),
+    Rcpp::Named("numSeeds") = Rcpp::NumericVector(
+      table.numSeeds.begin(), table.numSeeds.end()
+    )
+  );
+}
+
+
+/** Creates the data.frame that the mean shift functions return from the
+ *  coordinates of the seeds and their modes.
+ *
+ *  With ModesOutput::indexed, the data.frame only has the 1-based integer
+ *  column modeIndex, and its attribute "modes" holds the unique modes, which
+ *  merge the modes within \p modeTolerance of each other. With more than
+ *  INT_MAX seeds, the columns are returned as a named list instead.
+ */
+template <typename Index>
+Rcpp::List createModesDataFrame(
+    const PointColumns& points, const std::vector<Index>& seedRows,
+    const Rcpp::NumericVector& modesX, const Rcpp::NumericVector& modesY,
+    const Rcpp::NumericVector& modesZ,
+    const ModesOutput output = ModesOutput::full,
+    const double modeTolerance = 0.0
+) {
+  R_xlen_t numSeeds{ modesX.size() };
+  if (output == ModesOutput::modes) {
+    return createColumnTable(Rcpp::List::create(
+      Rcpp::Named("modeX") = modesX,
+      Rcpp::Named("modeY") = modesY,
+      Rcpp::Named("modeZ") = modesZ
+    ), numSeeds);
+  }
+
+  if (output == ModesOutput::indexed) {
+    Rcpp::IntegerVector modeIndices(numSeeds);
+    Rcpp::DataFrame modeTable{ createModeTableDataFrame(
+      modesX, modesY, modesZ, modeTolerance, modeIndices.begin()
+    ) };
+    Rcpp::List result{ createColumnTable(Rcpp::List::create(
+      Rcpp::Named("modeIndex") = modeIndices
+    ), numSeeds) };
+    result.attr("modes") = modeTable;
+    return result;
+  }
+
+  Rcpp::NumericVector seedsX(numSeeds);
+  Rcpp::NumericVector seedsY(numSeeds);
+  Rcpp::NumericVector seedsZ(numSeeds);
+  for (R_xlen_t seed{ 0 }; seed < numSeeds; seed++) {
+    seedsX[seed] = points.pointsX[seedRows[seed]];
+    seedsY[seed] = points.pointsY[seedRows[seed]];
+    seedsZ[seed] = points.pointsZ[seedRows[seed]];
+  }
+
+  return createColumnTable(Rcpp::List::create(
+    Rcpp::Named("X") = seedsX,
+    Rcpp::Named("Y") = seedsY,
+    Rcpp::Named("Z") = seedsZ,
+    Rcpp::Named("modeX") = modesX,
+    Rcpp::Named("modeY") = modesY,
+    Rcpp::Named("modeZ") = modesZ
+  ), numSeeds);
+}
+
+
+template <typename Index>
+Rcpp::List createModesDataFrame(
+    const Rcpp::NumericMatrix& pointCloud, const std::vector<Index>& seedRows,
+    const Rcpp::NumericVector& modesX, const Rcpp::NumericVector& modesY,
+    const Rcpp::NumericVector& modesZ,
+    const ModesOutput output = ModesOutput::full,
+    const double modeTolerance = 0.0
+) {
+  return createModesDataFrame(
+    getPointColumns(pointCloud), seedRows, modesX, modesY, modesZ, output,
+    modeTolerance
+  );
+}
+
+
+/** The vectors that receive the modes of the seeds, and the data.frame that
+ *  the mean shift functions create from them.
+ *
+ *  If the options name an output file, the result is a column file that is
+ *  returned as mapped vectors. For the full output and ModesOutput::modes,
+ *  the mode vectors are then columns of that file, so the modes go to disk
+ *  as they are found instead of onto the R heap. The modes of
+ *  ModesOutput::indexed stay in memory until they are merged into the table
+ *  of unique modes, which is never written to the file.
+ */
+class ModeVectors {
+public:
+
+  ModeVectors(const R_xlen_t numSeeds, const ModesOptions& options)
+    : options(options) {
+    if (options.outputFile.empty()) {
+      modesX = Rcpp::NumericVector(numSeeds);
+      modesY = Rcpp::NumericVector(numSeeds);
+      modesZ = Rcpp::NumericVector(numSeeds);
+      return;
+    }
+
+    std::vector<std::string> names;
+    if (options.output == ModesOutput::full) {
+      names = { "X", "Y", "Z", "modeX", "modeY", "modeZ" };
+    } else if (options.output == ModesOutput::modes) {
+      names = { "modeX", "modeY", "modeZ" };
+    } else {
+      names = { "modeIndex" };
+    }
+    std::vector<ColumnType> types(
+      names.size(),
+      options.output == ModesOutput::indexed ? ColumnType::integer : ColumnType::real
+    );
+    file = std::make_shared<ColumnFile>(
+      options.outputFile, names, types, static_cast<std::uint64_t>(numSeeds)
+    );
+
+    if (options.output == ModesOutput::indexed) {
+      modesX = Rcpp::NumericVector(numSeeds);
+      modesY = Rcpp::NumericVector(numSeeds);
+      modesZ = Rcpp::NumericVector(numSeeds);
+    } else {
+      int firstMode{ file->findColumn("modeX") };
+      modesX = createMappedVector(file, firstMode);
+      modesY = createMappedVector(file, firstMode + 1);
+      modesZ = createMappedVector(file, firstMode + 2);
+    }
+  }
+
+  Rcpp::NumericVector modesX;
+  Rcpp::NumericVector modesY;
+  Rcpp::NumericVector modesZ;
+
+  /** The data.frame of the seeds in \p seedRows of \p points, after all
+   *  modes were stored.
+   */
+  template <typename Index>
+  Rcpp::List createDataFrame(
+      const PointColumns& points, const std::vector<Index>& seedRows
+  ) const {
+    if (!file) {
+      return createModesDataFrame(
+        points, seedRows, modesX, modesY, modesZ, options.output,
+        options.modeTolerance
+      );
+    }
+
+    Rcpp::DataFrame modeTable;
+    if (options.output == ModesOutput::full) {
+      double* seedsX{ reinterpret_cast<double*>(file->columnData(0)) };
+      double* seedsY{ reinterpret_cast<double*>(file->columnData(1)) };
+      double* seedsZ{ reinterpret_cast<double*>(file->columnData(2)) };
+      for (std::size_t seed{ 0 }; seed < seedRows.size(); seed++) {
+        seedsX[seed] = points.pointsX[seedRows[seed]];
+        seedsY[seed] = points.pointsY[seedRows[seed]];
+        seedsZ[seed] = points.pointsZ[seedRows[seed]];
+      }
+    } else if (options.output == ModesOutput::indexed) {
+      modeTable = createModeTableDataFrame(
+        modesX, modesY, modesZ, options.modeTolerance,
+        reinterpret_cast<int*>(file->columnData(0))
+      );
+    }
+    file->flush();
+
+    Rcpp::List result{ createMappedDataFrame(file) };
+    if (options.output == ModesOutput::indexed) {
+      result.attr("modes") = modeTable;
+    }
+    return result;
+  }
+
+  template <typename Index>
+  Rcpp::List createDataFrame(
+      const Rcpp::NumericMatrix& pointCloud, const std::vector<Index>& seedRows
+  ) const {
+    return createDataFrame(getPointColumns(pointCloud), seedRows);
+  }
+
+private:
+
+  ModesOptions options;
+  std::shared_ptr<ColumnFile> file;
+};
+
+#endif  // define SEED_SET_H
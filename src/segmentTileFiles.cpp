@@ -0,0 +1,111 @@
+#include "tilePipeline.h"
+#include "tileSegmentation.h"
+#include "tileTables.h"
+
+#include <Rcpp.h>
+#include <string>
+#include <vector>
+
+
+//' Tree crown segmentation of tile files with overlapping input and output
+//'
+//' Segments buffered tiles that are stored in CSV files, e.g. the tiles of
+//' \code{split_point_cloud_buffered} written by \code{data.table::fwrite},
+//' and writes the points that every tile keeps to a CSV file. Reader,
+//' segmenter and writer threads work at the same time and pass the tiles on
+//' through queues of limited length, so the cores keep segmenting while
+//' files are read and written and the memory stays bounded.
+//'
+//' @param inputFiles Character vector with the paths of the tile files. They
+//'   need the columns X, Y, Z and Buffer, and can have the columns sBPC_llX,
+//'   sBPC_llY and sBPC_Width of \code{split_point_cloud_quadtree}.
+//' @param outputFiles Character vector with one output path per tile file.
+//'   The files get the columns X, Y, Z, modeX, modeY, modeZ and crown_id.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param minNumNeighborsPerCore Integer scalar. The minimum number of
+//'   neighbors that a mode needs to have in order to be considered as a core
+//'   mode by DBSCAN.
+//' @param neighborhoodRadius Numeric scalar. The radius of the neighborhood of
+//'   a mode in DBSCAN.
+//' @param maxNumCentroidsPerMode Integer scalar. Maximum number of
+//'   iterations, i.e. steps that the kernel can move for each point.
+//' @param maxNumNeighbors Integer scalar. If positive, kernels with more
+//'   neighbors than this only use a deterministic subsample of them.
+//' @param minHeight Numeric scalar. Points below this height are ignored.
+//' @param bufferWidth Numeric scalar. Width of the buffer around the core
+//'   area of the tiles in meters.
+//' @param seedBufferWidth Numeric scalar. Width of the part of the buffer
+//'   whose points get their own modes. Negative values use the largest crown
+//'   radius of every tile, capped at \code{bufferWidth}.
+//' @param numReaders Integer scalar. Number of threads that read files.
+//' @param numSegmenters Integer scalar. Number of threads that segment tiles.
+//'   Non-positive values use all available cores.
+//' @param numWriters Integer scalar. Number of threads that write files.
+//' @param queueCapacity Integer scalar. Number of tiles that may wait between
+//'   reading and segmenting and between segmenting and writing.
+//'
+//' @return A data.frame with one row per stage ("read", "segment" and
+//'   "write") and the columns \code{numThreads}, \code{numTiles},
+//'   \code{busySeconds} (time the threads of the stage worked, summed over
+//'   the threads) and \code{utilization} (the busy time divided by the total
+//'   time of all threads of the stage). A stage with a utilization near 1
+//'   limits the throughput. The attribute \code{seconds} holds the total
+//'   time and the attribute \code{numCrowns} the number of crowns.
+//'
+//' @details The crown IDs are unique over all output files, but which tile
+//'   gets which IDs depends on the order in which the tiles are written.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame segmentTileFiles(
+    Rcpp::CharacterVector inputFiles, Rcpp::CharacterVector outputFiles,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int minNumNeighborsPerCore, double neighborhoodRadius,
+    int maxNumCentroidsPerMode = 200, int maxNumNeighbors = 0,
+    double minHeight = 2, double bufferWidth = 10, double seedBufferWidth = -1,
+    int numReaders = 1, int numSegmenters = 0, int numWriters = 1,
+    int queueCapacity = 4
+){
+  if (inputFiles.size() != outputFiles.size()) {
+    Rcpp::stop("inputFiles and outputFiles must have the same length.");
+  }
+  if (neighborhoodRadius <= 0.0) {
+    Rcpp::stop("neighborhoodRadius must be positive.");
+  }
+
+  TileSegmentationParameters parameters;
+  parameters.crownDiameter2TreeHeight = crownDiameter2TreeHeight;
+  parameters.crownHeight2TreeHeight = crownHeight2TreeHeight;
+  parameters.maxNumCentroidsPerMode = maxNumCentroidsPerMode;
+  parameters.maxNumNeighbors = maxNumNeighbors;
+  parameters.minNumNeighborsPerCore = minNumNeighborsPerCore;
+  parameters.neighborhoodRadius = neighborhoodRadius;
+  parameters.minHeight = minHeight;
+  parameters.bufferWidth = bufferWidth;
+  parameters.seedBufferWidth = seedBufferWidth;
+
+  TilePipelineSettings settings;
+  settings.numReaders = numReaders;
+  settings.numSegmenters = numSegmenters;
+  settings.numWriters = numWriters;
+  settings.queueCapacity = queueCapacity;
+
+  std::vector<std::string> inputPaths{
+    Rcpp::as<std::vector<std::string> >(inputFiles)
+  };
+  std::vector<std::string> outputPaths{
+    Rcpp::as<std::vector<std::string> >(outputFiles)
+  };
+  TilePipelineStatistics statistics{
+    runTilePipeline(inputPaths, outputPaths, parameters, settings)
+  };
+  if (!statistics.errors.empty()) {
+    Rcpp::stop(statistics.errors.front());
+  }
+
+  return createPipelineStageTable(statistics);
+}
@@ -0,0 +1,113 @@
+#include "tileTables.h"
+#include "tileScheduler.h"
+#include "tileSegmentation.h"
+
+#include <Rcpp.h>
+#include <vector>
+
+
+//' Tree crown segmentation of buffered tiles on a thread pool
+//'
+//' Segments all tiles of \code{split_point_cloud_buffered} in one call. The
+//' tiles are processed by threads of the R process, which take the next
+//' unprocessed tile from a shared atomic counter, so neither R processes nor
+//' serialized copies of the tiles are needed. Once all tiles have been
+//' taken, idle threads help with the seeds of the tiles that are still
+//' running, so a few large tiles do not determine the run time. Every tile is
+//' processed like in \code{segment_tree_crowns_parallel} with the "improved"
+//' version.
+//'
+//' @param tiles List of data.frames with the columns X, Y, Z and Buffer. If
+//'   they have the columns sBPC_llX, sBPC_llY and sBPC_Width, e.g. from
+//'   \code{split_point_cloud_quadtree}, these define the core area of every
+//'   tile.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param minNumNeighborsPerCore Integer scalar. The minimum number of
+//'   neighbors that a mode needs to have in order to be considered as a core
+//'   mode by DBSCAN.
+//' @param neighborhoodRadius Numeric scalar. The radius of the neighborhood of
+//'   a mode in DBSCAN.
+//' @param maxNumCentroidsPerMode Integer scalar. Maximum number of
+//'   iterations, i.e. steps that the kernel can move for each point.
+//' @param maxNumNeighbors Integer scalar. If positive, kernels with more
+//'   neighbors than this only use a deterministic subsample of them.
+//' @param minHeight Numeric scalar. Points below this height are ignored.
+//' @param bufferWidth Numeric scalar. Width of the buffer around the core
+//'   area of the tiles in meters.
+//' @param seedBufferWidth Numeric scalar. Width of the part of the buffer
+//'   whose points get their own modes. Negative values use the largest crown
+//'   radius of every tile, capped at \code{bufferWidth}.
+//' @param numThreads Integer scalar. Number of threads. Non-positive values
+//'   use all available cores.
+//' @param seedChunkSize Integer scalar. Number of seeds that a thread takes
+//'   from a tile at once. Non-positive values process every tile on a single
+//'   thread.
+//' @param tileOrder NULL or a permutation of the tile numbers (1-based) in
+//'   which the tiles are started, e.g. by decreasing predicted cost. Does not
+//'   change the result.
+//'
+//' @return A data.frame with the columns X, Y, Z, modeX, modeY, modeZ and
+//'   crown_id of the points that the tiles keep. Crown IDs are consecutive
+//'   over all tiles and the points without a crown come last, with crown ID
+//'   0. The attribute \code{tileSeconds} holds the time that the threads
+//'   spent on every tile.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame segmentTilesBatch(
+    Rcpp::List tiles,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int minNumNeighborsPerCore, double neighborhoodRadius,
+    int maxNumCentroidsPerMode = 200, int maxNumNeighbors = 0,
+    double minHeight = 2, double bufferWidth = 10, double seedBufferWidth = -1,
+    int numThreads = 0, int seedChunkSize = 64,
+    Rcpp::Nullable<Rcpp::IntegerVector> tileOrder = R_NilValue
+){
+  if (neighborhoodRadius <= 0.0) {
+    Rcpp::stop("neighborhoodRadius must be positive.");
+  }
+
+  TileSegmentationParameters parameters;
+  parameters.crownDiameter2TreeHeight = crownDiameter2TreeHeight;
+  parameters.crownHeight2TreeHeight = crownHeight2TreeHeight;
+  parameters.maxNumCentroidsPerMode = maxNumCentroidsPerMode;
+  parameters.maxNumNeighbors = maxNumNeighbors;
+  parameters.minNumNeighborsPerCore = minNumNeighborsPerCore;
+  parameters.neighborhoodRadius = neighborhoodRadius;
+  parameters.minHeight = minHeight;
+  parameters.bufferWidth = bufferWidth;
+  parameters.seedBufferWidth = seedBufferWidth;
+
+  // Get the columns of all tiles while the R API may still be used
+  std::vector<Rcpp::NumericVector> columns;
+  std::vector<TilePoints> tilePoints{ getTilePoints(tiles, columns) };
+  int numTiles{ static_cast<int>(tilePoints.size()) };
+
+  // Convert the tile order to 0-based tile positions
+  std::vector<int> order;
+  if (tileOrder.isNotNull()) {
+    Rcpp::IntegerVector tileNumbers(tileOrder);
+    std::vector<bool> isInOrder(numTiles, false);
+    for (int tileNumber : tileNumbers) {
+      if (tileNumber < 1 || tileNumber > numTiles || isInOrder[tileNumber - 1]) {
+        Rcpp::stop("tileOrder must be a permutation of the tile numbers.");
+      }
+      isInOrder[tileNumber - 1] = true;
+      order.push_back(tileNumber - 1);
+    }
+    if (static_cast<int>(order.size()) != numTiles) {
+      Rcpp::stop("tileOrder must be a permutation of the tile numbers.");
+    }
+  }
+
+  // Segment the tiles on the thread pool
+  std::vector<TileResult> results{
+    segmentTiles(tilePoints, parameters, numThreads, seedChunkSize, order)
+  };
+
+  return createTileResultTable(results);
+}
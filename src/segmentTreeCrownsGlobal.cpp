@@ -0,0 +1,236 @@
+#include "cylinderKernel.h"
+#include "heightBandedGridIndex.h"
+#include "modeClustering.h"
+#include "parallelFor.h"
+#include "pointColumns.h"
+
+#include <Rcpp.h>
+#include <chrono>
+#include <climits>  // for INT_MAX
+#include <cstdint>
+#include <vector>
+
+
+namespace {
+
+double secondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start
+  ).count();
+}
+
+// The crown IDs of the 64-bit index may exceed the range of R integers
+SEXP wrapCrownIds(const std::vector<std::int32_t>& crownIds) {
+  return Rcpp::wrap(crownIds);
+}
+
+SEXP wrapCrownIds(const std::vector<std::int64_t>& crownIds) {
+  return Rcpp::NumericVector(crownIds.begin(), crownIds.end());
+}
+
+// Segments the points with an index of positions of type Index. columnX,
+// columnY and columnZ become the coordinate columns of the result, so
+// columns that are read in place are not copied.
+template <typename Index>
+Rcpp::List segmentGlobally(
+    const PointColumns& points, SEXP columnX, SEXP columnY, SEXP columnZ,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int minNumNeighborsPerCore, double neighborhoodRadius,
+    int maxNumCentroidsPerMode, int maxNumNeighbors, int numThreads
+){
+  if (neighborhoodRadius <= 0.0) {
+    Rcpp::stop("neighborhoodRadius must be positive.");
+  }
+
+  Index nrows{ static_cast<Index>(points.numPoints) };
+  auto start = std::chrono::steady_clock::now();
+
+  // Index all points once
+  BasicHeightBandedGridIndex<Index> index{
+    points.pointsX, points.pointsY, points.pointsZ, nrows,
+    crownDiameter2TreeHeight
+  };
+  double indexSeconds{ secondsSince(start) };
+
+  // Move the kernels of all points in parallel. The trajectories only read
+  // the index, so they need no synchronization.
+  auto modesStart = std::chrono::steady_clock::now();
+  Rcpp::NumericVector modesX(points.numPoints);
+  Rcpp::NumericVector modesY(points.numPoints);
+  Rcpp::NumericVector modesZ(points.numPoints);
+  double* modeX{ modesX.begin() };
+  double* modeY{ modesY.begin() };
+  double* modeZ{ modesZ.begin() };
+  parallelFor(0, nrows, numThreads, [&](std::int64_t i) {
+    Mode mode{ findMode(
+      index, points.pointsX[i], points.pointsY[i], points.pointsZ[i],
+      crownDiameter2TreeHeight, crownHeight2TreeHeight,
+      maxNumCentroidsPerMode, maxNumNeighbors
+    ) };
+    modeX[i] = mode.x;
+    modeY[i] = mode.y;
+    modeZ[i] = mode.z;
+  });
+  double modesSeconds{ secondsSince(modesStart) };
+
+  // Cluster all modes at once
+  auto clusteringStart = std::chrono::steady_clock::now();
+  std::vector<Index> crownIds{ clusterModes(
+    modeX, modeY, modeZ, nrows,
+    neighborhoodRadius, minNumNeighborsPerCore + 1
+  ) };
+  double clusteringSeconds{ secondsSince(clusteringStart) };
+  double totalSeconds{ secondsSince(start) };
+
+  Rcpp::List result{ Rcpp::List::create(
+    Rcpp::Named("X") = columnX,
+    Rcpp::Named("Y") = columnY,
+    Rcpp::Named("Z") = columnZ,
+    Rcpp::Named("modeX") = modesX,
+    Rcpp::Named("modeY") = modesY,
+    Rcpp::Named("modeZ") = modesZ,
+    Rcpp::Named("crown_id") = wrapCrownIds(crownIds)
+  ) };
+  result = createColumnTable(result, points.numPoints);
+  result.attr("seconds") = Rcpp::NumericVector::create(
+    Rcpp::Named("index") = indexSeconds,
+    Rcpp::Named("modes") = modesSeconds,
+    Rcpp::Named("clustering") = clusteringSeconds
+  );
+  result.attr("pointsPerSecond") =
+    totalSeconds > 0.0 ? points.numPoints / totalSeconds : R_PosInf;
+  return result;
+}
+
+// Uses the 32-bit index unless there are too many points, since it needs
+// half the memory
+Rcpp::List segmentGlobally(
+    const PointColumns& points, SEXP columnX, SEXP columnY, SEXP columnZ,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int minNumNeighborsPerCore, double neighborhoodRadius,
+    int maxNumCentroidsPerMode, int maxNumNeighbors, int numThreads
+){
+  if (points.numPoints <= INT_MAX) {
+    return segmentGlobally<std::int32_t>(
+      points, columnX, columnY, columnZ, crownDiameter2TreeHeight,
+      crownHeight2TreeHeight, minNumNeighborsPerCore, neighborhoodRadius,
+      maxNumCentroidsPerMode, maxNumNeighbors, numThreads
+    );
+  }
+  return segmentGlobally<std::int64_t>(
+    points, columnX, columnY, columnZ, crownDiameter2TreeHeight,
+    crownHeight2TreeHeight, minNumNeighborsPerCore, neighborhoodRadius,
+    maxNumCentroidsPerMode, maxNumNeighbors, numThreads
+  );
+}
+
+}  // namespace
+
+
+//' Tree crown segmentation with one index over the whole point cloud
+//'
+//' Runs the adaptive mean shift of \code{meanShiftClassicImproved} for all
+//' points of a point cloud that fits into memory, clusters the modes with
+//' DBSCAN and returns the crown ID of every point. The point cloud is not
+//' split into tiles, so there are no buffers, no duplicated points and no
+//' crowns that need to be stitched together.
+//'
+//' @param pointCloud Point cloud data in a three-column matrix where the
+//'   columns represent X, Y and Z coordinates and each row represents one
+//'   point.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param minNumNeighborsPerCore Integer scalar. The minimum number of
+//'   neighbors that a mode needs to have in order to be considered as a core
+//'   mode by DBSCAN.
+//' @param neighborhoodRadius Numeric scalar. The radius of the neighborhood of
+//'   a mode in DBSCAN.
+//' @param maxNumCentroidsPerMode Integer scalar. Maximum number of
+//'   iterations, i.e. steps that the kernel can move for each point.
+//' @param maxNumNeighbors Integer scalar. If positive, kernels with more
+//'   neighbors than this only use a deterministic subsample of them,
+//'   as in \code{meanShiftClassicImproved}.
+//' @param numThreads Integer scalar. Number of threads that calculate the
+//'   modes. Non-positive values use all available cores.
+//'
+//' @return A data.frame with the coordinates in \code{pointCloud}, the
+//'   coordinates of the calculated modes and the column \code{crown_id}, which
+//'   is 0 for points whose modes are not part of any cluster. The attribute
+//'   \code{seconds} holds the run times of building the index, calculating
+//'   the modes and clustering them. The attribute \code{pointsPerSecond}
+//'   holds the number of points that were processed per second in total.
+//'
+//' @details The clusters are the same as those of \code{dbscan::dbscan} with
+//'   \code{eps = neighborhoodRadius} and
+//'   \code{minPts = minNumNeighborsPerCore + 1}.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List segmentTreeCrownsGlobal(
+    Rcpp::NumericMatrix pointCloud,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int minNumNeighborsPerCore, double neighborhoodRadius,
+    int maxNumCentroidsPerMode = 200, int maxNumNeighbors = 0,
+    int numThreads = 0
+){
+  return segmentGlobally(
+    getPointColumns(pointCloud), pointCloud(Rcpp::_, 0),
+    pointCloud(Rcpp::_, 1), pointCloud(Rcpp::_, 2),
+    crownDiameter2TreeHeight, crownHeight2TreeHeight, minNumNeighborsPerCore,
+    neighborhoodRadius, maxNumCentroidsPerMode, maxNumNeighbors, numThreads
+  );
+}
+
+
+//' Tree crown segmentation with one index over point coordinates in
+//' separate columns
+//'
+//' Like \code{segmentTreeCrownsGlobal}, but takes the coordinates as three
+//' vectors, e.g. the columns of a data.frame, a data.table or a column file.
+//' Numeric vectors are read in place and returned as the coordinate columns
+//' of the result, so the point cloud is never copied. Long vectors with
+//' 2^31 or more points are indexed with 64-bit positions.
+//'
+//' @param pointsX,pointsY,pointsZ Numeric vectors with the X-, Y- and
+//'   Z-coordinates of the points.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param minNumNeighborsPerCore Integer scalar. The minimum number of
+//'   neighbors that a mode needs to have in order to be considered as a core
+//'   mode by DBSCAN.
+//' @param neighborhoodRadius Numeric scalar. The radius of the neighborhood of
+//'   a mode in DBSCAN.
+//' @param maxNumCentroidsPerMode Integer scalar. Maximum number of
+//'   iterations, i.e. steps that the kernel can move for each point.
+//' @param maxNumNeighbors Integer scalar. If positive, kernels with more
+//'   neighbors than this only use a deterministic subsample of them.
+//' @param numThreads Integer scalar. Number of threads that calculate the
+//'   modes. Non-positive values use all available cores.
+//'
+//' @return The data.frame of \code{segmentTreeCrownsGlobal}, or a named list
+//'   of long vectors if there are more than 2^31 - 1 points. Then
+//'   \code{crown_id} is numeric, since the IDs may exceed the range of R
+//'   integers.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List segmentTreeCrownsGlobalColumns(
+    Rcpp::NumericVector pointsX, Rcpp::NumericVector pointsY,
+    Rcpp::NumericVector pointsZ,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int minNumNeighborsPerCore, double neighborhoodRadius,
+    int maxNumCentroidsPerMode = 200, int maxNumNeighbors = 0,
+    int numThreads = 0
+){
+  return segmentGlobally(
+    getPointColumns(pointsX, pointsY, pointsZ), pointsX, pointsY, pointsZ,
+    crownDiameter2TreeHeight, crownHeight2TreeHeight, minNumNeighborsPerCore,
+    neighborhoodRadius, maxNumCentroidsPerMode, maxNumNeighbors, numThreads
+  );
+}
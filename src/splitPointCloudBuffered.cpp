@@ -0,0 +1,196 @@
+#include "bufferedTiling.h"
+
+#include <Rcpp.h>
+
+
+namespace {
+
+// Converts a tiling to the list of splitPointCloudBufferedIndices
+Rcpp::List wrapTiling(const BufferedTiling& tiling) {
+  int numTiles{ tiling.numTiles() };
+
+  Rcpp::IntegerVector numCorePoints(numTiles);
+  Rcpp::IntegerVector numBufferPoints(numTiles);
+  Rcpp::List pointIndices(numTiles);
+  for (int tile{ 0 }; tile < numTiles; tile++) {
+    int first{ tiling.tileStarts[tile] };
+    int last{ tiling.tileStarts[tile + 1] };
+    numCorePoints[tile] = tiling.numCorePoints[tile];
+    numBufferPoints[tile] = last - first - tiling.numCorePoints[tile];
+
+    // Convert to R's one-based row numbers
+    Rcpp::IntegerVector rows(last - first);
+    for (int k{ first }; k < last; k++) {
+      rows[k - first] = tiling.pointIndices[k] + 1;
+    }
+    pointIndices[tile] = rows;
+  }
+
+  Rcpp::DataFrame tiles{ Rcpp::DataFrame::create(
+    Rcpp::Named("sBPC_SpatID") = Rcpp::wrap(tiling.tileIds),
+    Rcpp::Named("sBPC_llX") = Rcpp::wrap(tiling.tileLowerLeftX),
+    Rcpp::Named("sBPC_llY") = Rcpp::wrap(tiling.tileLowerLeftY),
+    Rcpp::Named("sBPC_Width") = Rcpp::wrap(tiling.tileCoreWidths),
+    Rcpp::Named("bufferWidth") = Rcpp::wrap(tiling.tileBufferWidths),
+    Rcpp::Named("numCorePoints") = numCorePoints,
+    Rcpp::Named("numBufferPoints") = numBufferPoints
+  ) };
+
+  return Rcpp::List::create(
+    Rcpp::Named("tiles") = tiles,
+    Rcpp::Named("pointIndices") = pointIndices
+  );
+}
+
+
+// Gets the heights if they are given
+const double* getHeights(
+    const Rcpp::Nullable<Rcpp::NumericVector>& pointsZ,
+    Rcpp::NumericVector& pointHeights, const R_xlen_t numPoints
+) {
+  if (pointsZ.isNull()) {
+    return nullptr;
+  }
+  pointHeights = Rcpp::NumericVector(pointsZ.get());
+  if (pointHeights.size() != numPoints) {
+    Rcpp::stop("pointsZ must have the same length as pointsX.");
+  }
+  return pointHeights.begin();
+}
+
+}  // namespace
+
+
+//' Split a point cloud into buffered tiles without copying it
+//'
+//' Calculates which rows of a point cloud belong to the core area and to the
+//' buffer of every tile, in the way of \code{split_point_cloud_buffered}.
+//'
+//' @param pointsX Numeric vector with the X-coordinates of the points.
+//' @param pointsY Numeric vector with the Y-coordinates of the points.
+//' @param coreWidth Numeric scalar. Side length of the core area of the tiles
+//'   in meters.
+//' @param bufferWidth Numeric scalar. Width of the buffer around the core
+//'   area in meters. The largest buffer width if the buffers are adapted to
+//'   the heights in the tiles.
+//' @param pointsZ Numeric vector with the Z-coordinates of the points or
+//'   NULL. If given together with a positive
+//'   \code{crownDiameter2TreeHeight}, the buffer of every tile is adapted to
+//'   the heights of its core points and of a buffer of full width.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height, used to derive the buffer widths from the heights.
+//'
+//' @return A list with the elements \code{tiles} and \code{pointIndices}.
+//'   \code{tiles} is a data.frame with one row per tile that contains at
+//'   least one point. Its columns are the plot index of the tile
+//'   (\code{sBPC_SpatID}), the lower left corner and the side length of its
+//'   core area (\code{sBPC_llX}, \code{sBPC_llY}, \code{sBPC_Width}), its
+//'   buffer width
+//'   (\code{bufferWidth}) and its numbers of core and buffer points
+//'   (\code{numCorePoints}, \code{numBufferPoints}).
+//'   \code{pointIndices} is a list with one integer vector of row numbers per
+//'   tile. Each vector holds the core points of the tile, followed by its
+//'   buffer points.
+//'
+//' @details The plot indices are numbered like those of
+//'   \code{calculate_plot_index} with the minimum coordinates rounded down to
+//'   a multiple of \code{coreWidth}. The split takes two passes over the
+//'   points and the memory for one row number per point and tile. Rows with
+//'   missing coordinates are left out.
+//'
+//'   The kernels of the core points reach at most the largest kernel radius,
+//'   \code{crownDiameter2TreeHeight * max(Z) / 2}, beyond the core area.
+//'   Since the kernels move into the buffer, where the trees can be taller,
+//'   \code{max(Z)} is taken over the core points and the points within
+//'   \code{bufferWidth} of the core area. With \code{pointsZ}, that is the
+//'   buffer width of a tile, capped at \code{bufferWidth}. Tiles with low
+//'   vegetation and low neighbors then get narrow buffers.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List splitPointCloudBufferedIndices(
+    Rcpp::NumericVector pointsX, Rcpp::NumericVector pointsY,
+    double coreWidth, double bufferWidth,
+    Rcpp::Nullable<Rcpp::NumericVector> pointsZ = R_NilValue,
+    double crownDiameter2TreeHeight = 0
+){
+  if (pointsX.size() != pointsY.size()) {
+    Rcpp::stop("pointsX and pointsY must have the same length.");
+  }
+  if (!(coreWidth > 0.0)) {
+    Rcpp::stop("coreWidth must be positive.");
+  }
+
+  // Only derive the buffer widths from the heights if they are given
+  Rcpp::NumericVector pointHeights;
+  const double* heights{ getHeights(pointsZ, pointHeights, pointsX.size()) };
+
+  BufferedTiling tiling{ splitIntoBufferedTiles(
+    pointsX.begin(), pointsY.begin(), static_cast<int>(pointsX.size()),
+    coreWidth, bufferWidth, heights, crownDiameter2TreeHeight
+  ) };
+  return wrapTiling(tiling);
+}
+
+
+//' Split a point cloud into quadtree tiles of bounded size
+//'
+//' Calculates which rows of a point cloud belong to the core area and to the
+//' buffer of every leaf of a quadtree. Dense areas are divided into smaller
+//' tiles than sparse areas, so that the tiles hold similar numbers of points.
+//'
+//' @param pointsX Numeric vector with the X-coordinates of the points.
+//' @param pointsY Numeric vector with the Y-coordinates of the points.
+//' @param maxNumPointsPerTile Integer scalar. Tiles with more core points
+//'   than this are divided into four, unless they would become smaller than
+//'   \code{minCoreWidth}.
+//' @param minCoreWidth Numeric scalar. The smallest side length of the core
+//'   area of the tiles in meters. All side lengths are this times a power of
+//'   two.
+//' @param bufferWidth Numeric scalar. Width of the buffer around the core
+//'   area in meters. The largest buffer width if the buffers are adapted to
+//'   the heights in the tiles.
+//' @param pointsZ Numeric vector with the Z-coordinates of the points or
+//'   NULL. If given together with a positive
+//'   \code{crownDiameter2TreeHeight}, the buffer of every tile is adapted to
+//'   the heights of its core points and of a buffer of full width.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height, used to derive the buffer widths from the heights.
+//'
+//' @return A list like the one of \code{splitPointCloudBufferedIndices}. The
+//'   tiles are numbered consecutively in \code{sBPC_SpatID}.
+//'
+//' @details The buffer of a tile holds all points outside its core area
+//'   that are at most its buffer width away from it in X and in Y, no matter
+//'   how many smaller or larger tiles they belong to.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List splitPointCloudQuadtreeIndices(
+    Rcpp::NumericVector pointsX, Rcpp::NumericVector pointsY,
+    int maxNumPointsPerTile, double minCoreWidth, double bufferWidth,
+    Rcpp::Nullable<Rcpp::NumericVector> pointsZ = R_NilValue,
+    double crownDiameter2TreeHeight = 0
+){
+  if (pointsX.size() != pointsY.size()) {
+    Rcpp::stop("pointsX and pointsY must have the same length.");
+  }
+  if (!(minCoreWidth > 0.0)) {
+    Rcpp::stop("minCoreWidth must be positive.");
+  }
+  if (maxNumPointsPerTile < 1) {
+    Rcpp::stop("maxNumPointsPerTile must be positive.");
+  }
+
+  // Only derive the buffer widths from the heights if they are given
+  Rcpp::NumericVector pointHeights;
+  const double* heights{ getHeights(pointsZ, pointHeights, pointsX.size()) };
+
+  BufferedTiling tiling{ splitIntoQuadtreeTiles(
+    pointsX.begin(), pointsY.begin(), static_cast<int>(pointsX.size()),
+    maxNumPointsPerTile, minCoreWidth, bufferWidth,
+    heights, crownDiameter2TreeHeight
+  ) };
+
+  return wrapTiling(tiling);
+}
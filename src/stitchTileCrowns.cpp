@@ -0,0 +1,62 @@
+#include "crownStitching.h"
+
+#include <Rcpp.h>
+#include <vector>
+
+
+//' Stitch the crowns of buffered tiles together
+//'
+//' Merges the crowns that were found in neighboring tiles of
+//' \code{split_point_cloud_buffered} into global crowns, instead of keeping
+//' only the crowns whose center lies in the core area of a tile.
+//'
+//' @param tiles Integer vector with the tile of every row.
+//' @param pointIds Integer vector that identifies the same point in
+//'   different tiles, e.g. the column \code{sBPC_PointID} of
+//'   \code{split_point_cloud_buffered}.
+//' @param crownIds Integer vector with the crown of every row within its
+//'   tile, 0 for rows that are not part of a crown.
+//' @param isBuffer Logical vector that tells whether a row is a buffer point
+//'   of its tile.
+//' @param modesX,modesY,modesZ Numeric vectors with the coordinates of the
+//'   mode of every row.
+//' @param modeTolerance Numeric scalar. Crowns are only merged if the mean
+//'   positions of their modes are at most this far apart.
+//' @param minNumSharedPoints Integer scalar. Crowns are only merged if they
+//'   share at least this many points.
+//'
+//' @return Integer vector with the global crown ID of every row, 0 for rows
+//'   that are not part of a crown.
+//'
+//' @details Crowns are merged with a union-find structure, so a crown that
+//'   extends over several tiles gets one ID. Core rows that are not part of a
+//'   crown in their own tile get the crown of the same point in the buffer of
+//'   a neighboring tile, if there is one.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::IntegerVector stitchTileCrowns(
+    Rcpp::IntegerVector tiles, Rcpp::IntegerVector pointIds,
+    Rcpp::IntegerVector crownIds, Rcpp::LogicalVector isBuffer,
+    Rcpp::NumericVector modesX, Rcpp::NumericVector modesY,
+    Rcpp::NumericVector modesZ,
+    double modeTolerance, int minNumSharedPoints = 1
+){
+  R_xlen_t numRows{ tiles.size() };
+  if (pointIds.size() != numRows || crownIds.size() != numRows
+      || isBuffer.size() != numRows || modesX.size() != numRows
+      || modesY.size() != numRows || modesZ.size() != numRows) {
+    Rcpp::stop("All vectors must have the same length.");
+  }
+
+  TileCrowns tileCrowns;
+  tileCrowns.tiles.assign(tiles.begin(), tiles.end());
+  tileCrowns.pointIds.assign(pointIds.begin(), pointIds.end());
+  tileCrowns.crownIds.assign(crownIds.begin(), crownIds.end());
+  tileCrowns.isBuffer.assign(isBuffer.begin(), isBuffer.end());
+  tileCrowns.modesX.assign(modesX.begin(), modesX.end());
+  tileCrowns.modesY.assign(modesY.begin(), modesY.end());
+  tileCrowns.modesZ.assign(modesZ.begin(), modesZ.end());
+
+  return Rcpp::wrap(stitchCrowns(tileCrowns, modeTolerance, minNumSharedPoints));
+}
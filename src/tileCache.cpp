@@ -0,0 +1,240 @@
+#include "tileCache.h"
+
+#include "binaryIo.h"
+#include "heightBandedGridIndex.h"
+
+#include <algorithm>  // for std::min_element
+#include <cmath>      // for std::isfinite, std::llround
+#include <cstdint>
+#include <cstring>    // for std::memcmp
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+const char MAGIC[4]{ 'M', 'S', 'T', 'C' };
+const std::uint32_t FORMAT_VERSION{ 1 };
+const std::size_t HEADER_SIZE{ 112 };
+
+// Appends an unsigned integer in 7-bit groups, the lowest group first, with
+// the highest bit of every byte telling whether another byte follows
+void appendVarint(std::vector<unsigned char>& bytes, std::uint64_t value) {
+  while (value >= 0x80) {
+    bytes.push_back(static_cast<unsigned char>(value | 0x80));
+    value >>= 7;
+  }
+  bytes.push_back(static_cast<unsigned char>(value));
+}
+
+// Reads a variable-length integer. Returns false if the bytes end within it.
+bool readVarint(const unsigned char* bytes, const std::size_t numBytes,
+                std::size_t& offset, std::uint64_t& value) {
+  value = 0;
+  for (int shift{ 0 }; shift < 64 && offset < numBytes; shift += 7) {
+    unsigned char byte{ bytes[offset++] };
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Maps small negative and positive differences to small unsigned integers
+std::uint64_t zigzagEncode(const std::int64_t value) {
+  return (static_cast<std::uint64_t>(value) << 1)
+    ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t zigzagDecode(const std::uint64_t value) {
+  return static_cast<std::int64_t>(value >> 1)
+    ^ -static_cast<std::int64_t>(value & 1);
+}
+
+}  // namespace
+
+
+bool writeTileCache(
+    const std::string& path, const TilePoints& tilePoints,
+    const double quantization, const double crownDiameter2TreeHeight,
+    const double minHeight, std::string& error
+) {
+  int numPoints{ tilePoints.numPoints };
+  if (!(quantization > 0.0)) {
+    error = "The quantization must be positive.";
+    return false;
+  }
+
+  // Quantize the coordinates relative to their minimum and keep the values
+  // that decoding will produce, so that the index matches them exactly
+  const double* columns[3]{
+    tilePoints.pointsX, tilePoints.pointsY, tilePoints.pointsZ
+  };
+  double origins[3]{ 0.0, 0.0, 0.0 };
+  std::vector<double> decoded[3];
+  std::vector<unsigned char> coordinateBytes;
+  for (int column{ 0 }; column < 3; column++) {
+    const double* values{ columns[column] };
+    if (numPoints > 0) {
+      origins[column] = *std::min_element(values, values + numPoints);
+    }
+    decoded[column].resize(numPoints);
+    std::int64_t previous{ 0 };
+    for (int i{ 0 }; i < numPoints; i++) {
+      double steps{ (values[i] - origins[column]) / quantization };
+      if (!std::isfinite(steps)
+          || steps > std::numeric_limits<std::int32_t>::max()) {
+        error = "The coordinates of " + path + " are not finite or too far "
+          "apart for the quantization.";
+        return false;
+      }
+      std::int64_t quantized{ std::llround(steps) };
+      appendVarint(coordinateBytes, zigzagEncode(quantized - previous));
+      previous = quantized;
+      decoded[column][i] = quantized * quantization + origins[column];
+    }
+  }
+
+  std::vector<unsigned char> bufferBytes((numPoints + 7) / 8, 0);
+  for (int i{ 0 }; i < numPoints; i++) {
+    if (tilePoints.buffer[i] != 0.0) {
+      bufferBytes[i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+    }
+  }
+
+  // Index the points that the segmentation keeps, in the same way
+  std::vector<unsigned char> indexBytes;
+  if (crownDiameter2TreeHeight > 0.0) {
+    std::vector<double> indexedX;
+    std::vector<double> indexedY;
+    std::vector<double> indexedZ;
+    for (int i{ 0 }; i < numPoints; i++) {
+      if (decoded[2][i] >= minHeight) {
+        indexedX.push_back(decoded[0][i]);
+        indexedY.push_back(decoded[1][i]);
+        indexedZ.push_back(decoded[2][i]);
+      }
+    }
+    HeightBandedGridIndex index{
+      indexedX.data(), indexedY.data(), indexedZ.data(),
+      static_cast<int>(indexedZ.size()), crownDiameter2TreeHeight
+    };
+    index.serialize(indexBytes);
+  }
+
+  std::vector<unsigned char> header(HEADER_SIZE, 0);
+  std::memcpy(header.data(), MAGIC, 4);
+  writeValue<std::uint32_t>(header, 4, FORMAT_VERSION);
+  writeValue<std::int32_t>(header, 8, numPoints);
+  header[12] = tilePoints.hasCoreExtent ? 1 : 0;
+  if (tilePoints.hasCoreExtent) {
+    writeValue<double>(header, 16, tilePoints.coreLowerLeftX);
+    writeValue<double>(header, 24, tilePoints.coreLowerLeftY);
+    writeValue<double>(header, 32, tilePoints.coreWidth);
+  }
+  writeValue<double>(header, 40, quantization);
+  writeValue<double>(header, 48, origins[0]);
+  writeValue<double>(header, 56, origins[1]);
+  writeValue<double>(header, 64, origins[2]);
+  writeValue<double>(header, 72, indexBytes.empty() ? 0.0 : crownDiameter2TreeHeight);
+  writeValue<double>(header, 80, minHeight);
+  writeValue<std::uint64_t>(header, 88, coordinateBytes.size());
+  writeValue<std::uint64_t>(header, 96, bufferBytes.size());
+  writeValue<std::uint64_t>(header, 104, indexBytes.size());
+
+  std::ofstream file{ path, std::ios::binary };
+  for (const std::vector<unsigned char>* part :
+         { &header, &coordinateBytes, &bufferBytes, &indexBytes }) {
+    file.write(reinterpret_cast<const char*>(part->data()), part->size());
+  }
+  if (!file) {
+    error = "Cannot write the tile cache file " + path + ".";
+    return false;
+  }
+  return true;
+}
+
+
+TileCacheFile::TileCacheFile(const std::string& path)
+  : file(path), path(path), pointCount(0) {
+  const unsigned char* bytes{ file.data() };
+  if (file.size() < HEADER_SIZE || std::memcmp(bytes, MAGIC, 4) != 0) {
+    throw std::runtime_error(path + " is not a tile cache file.");
+  }
+  if (readValue<std::uint32_t>(bytes, 4) != FORMAT_VERSION) {
+    throw std::runtime_error(path + " has an unknown tile cache version.");
+  }
+  pointCount = readValue<std::int32_t>(bytes, 8);
+  std::uint64_t numBytes{ HEADER_SIZE };
+  for (std::size_t offset : { 88, 96, 104 }) {
+    numBytes += readValue<std::uint64_t>(bytes, offset);
+  }
+  if (pointCount < 0 || numBytes != file.size()
+      || readValue<std::uint64_t>(bytes, 96) != (pointCount + 7ULL) / 8) {
+    throw std::runtime_error(path + " is a damaged tile cache file.");
+  }
+  indexCrownDiameter = readValue<double>(bytes, 72);
+  indexHeight = readValue<double>(bytes, 80);
+}
+
+
+bool TileCacheFile::decode(TileColumns& columns, std::string& error) const {
+  const unsigned char* bytes{ file.data() };
+  double quantization{ readValue<double>(bytes, 40) };
+  std::size_t numCoordinateBytes{ static_cast<std::size_t>(
+    readValue<std::uint64_t>(bytes, 88)
+  ) };
+  const unsigned char* coordinateBytes{ bytes + HEADER_SIZE };
+
+  std::vector<double>* targets[3]{
+    &columns.pointsX, &columns.pointsY, &columns.pointsZ
+  };
+  std::size_t offset{ 0 };
+  for (int column{ 0 }; column < 3; column++) {
+    double origin{ readValue<double>(bytes, 48 + 8 * column) };
+    std::vector<double>& values{ *targets[column] };
+    values.resize(pointCount);
+    std::int64_t quantized{ 0 };
+    for (int i{ 0 }; i < pointCount; i++) {
+      std::uint64_t difference;
+      if (!readVarint(coordinateBytes, numCoordinateBytes, offset, difference)) {
+        error = path + " has damaged coordinates.";
+        return false;
+      }
+      quantized += zigzagDecode(difference);
+      values[i] = quantized * quantization + origin;
+    }
+  }
+  if (offset != numCoordinateBytes) {
+    error = path + " has damaged coordinates.";
+    return false;
+  }
+
+  const unsigned char* bufferBytes{ coordinateBytes + numCoordinateBytes };
+  columns.buffer.resize(pointCount);
+  for (int i{ 0 }; i < pointCount; i++) {
+    columns.buffer[i] = (bufferBytes[i / 8] >> (i % 8)) & 1 ? 1.0 : 0.0;
+  }
+
+  columns.hasCoreExtent = bytes[12] != 0;
+  columns.coreLowerLeftX = readValue<double>(bytes, 16);
+  columns.coreLowerLeftY = readValue<double>(bytes, 24);
+  columns.coreWidth = readValue<double>(bytes, 32);
+  return true;
+}
+
+
+TilePoints TileCacheFile::points(const TileColumns& columns) const {
+  TilePoints tilePoints{ columns.points() };
+  const unsigned char* bytes{ file.data() };
+  std::uint64_t numIndexBytes{ readValue<std::uint64_t>(bytes, 104) };
+  if (numIndexBytes > 0) {
+    tilePoints.serializedIndex = bytes + file.size() - numIndexBytes;
+    tilePoints.serializedIndexSize = static_cast<std::size_t>(numIndexBytes);
+  }
+  return tilePoints;
+}
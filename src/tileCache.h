@@ -0,0 +1,73 @@
+#ifndef TILE_CACHE_H
+#define TILE_CACHE_H
+
+#include "lasFile.h"
+#include "tileFiles.h"
+#include "tileSegmentation.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/** Writes a buffered tile to a binary tile cache file.
+ *
+ *  The file holds a header, the coordinates quantized to int32 multiples of
+ *  \p quantization relative to the smallest coordinates of the tile, every
+ *  column stored as zigzag-encoded differences between consecutive points in
+ *  variable-length integers, the Buffer flags as bits and, if
+ *  \p crownDiameter2TreeHeight is positive, the serialized spatial index of
+ *  the points at or above \p minHeight. The coordinates that are read back
+ *  differ from the original ones by at most half of \p quantization.
+ *
+ *  Returns false and sets \p error if the tile cannot be quantized or the
+ *  file cannot be written. Does not call the R API.
+ */
+bool writeTileCache(
+  const std::string& path, const TilePoints& tilePoints,
+  const double quantization, const double crownDiameter2TreeHeight,
+  const double minHeight, std::string& error
+);
+
+
+/** A memory-mapped tile cache file.
+ *
+ *  The constructor only checks the header, so opening a cache costs no more
+ *  than mapping it. The spatial index stays in the mapping and is restored
+ *  from there without sorting. Throws std::runtime_error if the file is not
+ *  a tile cache.
+ */
+class TileCacheFile {
+public:
+
+  explicit TileCacheFile(const std::string& path);
+
+  int numPoints() const { return pointCount; }
+
+  /** Decodes the points of the tile. Returns false and sets \p error if the
+   *  coordinates or flags are damaged. Does not call the R API.
+   */
+  bool decode(TileColumns& columns, std::string& error) const;
+
+  /** The view of \p columns that BufferedTileSegmentation expects, with the
+   *  serialized index of the cache.
+   */
+  TilePoints points(const TileColumns& columns) const;
+
+  /** The parameters that the serialized index was built with. Its
+   *  crownDiameter2TreeHeight is 0 without index.
+   */
+  double indexCrownDiameter2TreeHeight() const { return indexCrownDiameter; }
+  double indexMinHeight() const { return indexHeight; }
+
+private:
+
+  MappedFile file;
+  std::string path;
+  int pointCount;
+  double indexCrownDiameter;
+  double indexHeight;
+};
+
+#endif  // define TILE_CACHE_H
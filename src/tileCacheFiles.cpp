@@ -0,0 +1,356 @@
+#include "heightBandedGridIndex.h"
+#include "parallelFor.h"
+#include "tileCache.h"
+#include "tileFiles.h"
+#include "tileScheduler.h"
+#include "tileTables.h"
+
+#include <Rcpp.h>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+double secondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start
+  ).count();
+}
+
+double fileSize(const std::string& path) {
+  std::ifstream file{ path, std::ios::binary | std::ios::ate };
+  return file ? static_cast<double>(file.tellg()) : NA_REAL;
+}
+
+// Prepares a tile for the segmentation like BufferedTileSegmentation does:
+// keeps the points at or above the minimum height and indexes them
+void indexTile(const TilePoints& tilePoints, const double crownDiameter2TreeHeight,
+               const double minHeight) {
+  std::vector<double> pointsX;
+  std::vector<double> pointsY;
+  std::vector<double> pointsZ;
+  for (int i{ 0 }; i < tilePoints.numPoints; i++) {
+    if (tilePoints.pointsZ[i] >= minHeight) {
+      pointsX.push_back(tilePoints.pointsX[i]);
+      pointsY.push_back(tilePoints.pointsY[i]);
+      pointsZ.push_back(tilePoints.pointsZ[i]);
+    }
+  }
+  int numPoints{ static_cast<int>(pointsZ.size()) };
+  if (tilePoints.serializedIndex != nullptr
+      && HeightBandedGridIndex::isSerializedFor(
+           tilePoints.serializedIndex, tilePoints.serializedIndexSize,
+           numPoints, crownDiameter2TreeHeight)) {
+    HeightBandedGridIndex index{
+      pointsX.data(), pointsY.data(), pointsZ.data(), numPoints,
+      tilePoints.serializedIndex
+    };
+    return;
+  }
+  HeightBandedGridIndex index{
+    pointsX.data(), pointsY.data(), pointsZ.data(), numPoints,
+    crownDiameter2TreeHeight
+  };
+}
+
+}  // namespace
+
+
+//' Write buffered tiles to binary tile cache files
+//'
+//' Converts the tiles of \code{split_point_cloud_buffered} or
+//' \code{split_point_cloud_quadtree} into compact binary files, so that
+//' repeated segmentations of the same tiles, e.g. while tuning parameters,
+//' neither parse nor split the point cloud again. Every file holds the
+//' coordinates as quantized integers, compressed as variable-length
+//' differences between consecutive points, the Buffer flags as bits and,
+//' optionally, the spatial index of the tile.
+//'
+//' @param tiles List of data.frames with the columns X, Y, Z and Buffer, and
+//'   optionally sBPC_llX, sBPC_llY and sBPC_Width.
+//' @param files Character vector with one output path per tile.
+//' @param crownDiameter2TreeHeight Numeric scalar. If positive, the spatial
+//'   index for this ratio of crown diameter to tree height is stored as well,
+//'   and segmentations with the same ratio and \code{minHeight} skip
+//'   building it.
+//' @param minHeight Numeric scalar. The minimum height of the points in the
+//'   stored spatial index.
+//' @param quantization Numeric scalar. The coordinates are rounded to
+//'   multiples of this value relative to the smallest coordinates of the
+//'   tile, e.g. 0.001 for millimeters.
+//' @param numThreads Integer scalar. Number of threads that write files.
+//'   Non-positive values use all available cores.
+//'
+//' @return A data.frame with the columns \code{file}, \code{numPoints} and
+//'   \code{numBytes} (the size of the file).
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame writeTileCacheFiles(
+    Rcpp::List tiles, Rcpp::CharacterVector files,
+    double crownDiameter2TreeHeight = 0, double minHeight = 2,
+    double quantization = 0.001, int numThreads = 0
+){
+  if (tiles.size() != files.size()) {
+    Rcpp::stop("tiles and files must have the same length.");
+  }
+  std::vector<Rcpp::NumericVector> columns;
+  std::vector<TilePoints> tilePoints{ getTilePoints(tiles, columns) };
+  std::vector<std::string> paths{ Rcpp::as<std::vector<std::string> >(files) };
+
+  int numTiles{ static_cast<int>(tilePoints.size()) };
+  std::vector<std::string> errors(numTiles);
+  parallelFor(0, numTiles, numThreads, [&](int tile) {
+    writeTileCache(
+      paths[tile], tilePoints[tile], quantization, crownDiameter2TreeHeight,
+      minHeight, errors[tile]
+    );
+  }, 1);
+  for (const std::string& error : errors) {
+    if (!error.empty()) {
+      Rcpp::stop(error);
+    }
+  }
+
+  Rcpp::IntegerVector numPoints(numTiles);
+  Rcpp::NumericVector numBytes(numTiles);
+  for (int tile{ 0 }; tile < numTiles; tile++) {
+    numPoints[tile] = tilePoints[tile].numPoints;
+    numBytes[tile] = fileSize(paths[tile]);
+  }
+  return Rcpp::DataFrame::create(
+    Rcpp::Named("file") = files,
+    Rcpp::Named("numPoints") = numPoints,
+    Rcpp::Named("numBytes") = numBytes,
+    Rcpp::Named("stringsAsFactors") = false
+  );
+}
+
+
+//' Read a tile cache file
+//'
+//' @param file Character scalar. Path of a file of
+//'   \code{writeTileCacheFiles}.
+//'
+//' @return A data.frame with the columns X, Y, Z and Buffer, and the columns
+//'   sBPC_llX, sBPC_llY and sBPC_Width if the tile had them.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame readTileCacheFile(std::string file){
+  TileCacheFile cache{ file };
+  TileColumns tileColumns;
+  std::string error;
+  if (!cache.decode(tileColumns, error)) {
+    Rcpp::stop(error);
+  }
+
+  Rcpp::NumericVector pointsX{ Rcpp::wrap(tileColumns.pointsX) };
+  Rcpp::NumericVector pointsY{ Rcpp::wrap(tileColumns.pointsY) };
+  Rcpp::NumericVector pointsZ{ Rcpp::wrap(tileColumns.pointsZ) };
+  Rcpp::NumericVector buffer{ Rcpp::wrap(tileColumns.buffer) };
+  if (!tileColumns.hasCoreExtent) {
+    return Rcpp::DataFrame::create(
+      Rcpp::Named("X") = pointsX,
+      Rcpp::Named("Y") = pointsY,
+      Rcpp::Named("Z") = pointsZ,
+      Rcpp::Named("Buffer") = buffer
+    );
+  }
+  int numPoints{ cache.numPoints() };
+  return Rcpp::DataFrame::create(
+    Rcpp::Named("X") = pointsX,
+    Rcpp::Named("Y") = pointsY,
+    Rcpp::Named("Z") = pointsZ,
+    Rcpp::Named("Buffer") = buffer,
+    Rcpp::Named("sBPC_llX") = Rcpp::NumericVector(numPoints, tileColumns.coreLowerLeftX),
+    Rcpp::Named("sBPC_llY") = Rcpp::NumericVector(numPoints, tileColumns.coreLowerLeftY),
+    Rcpp::Named("sBPC_Width") = Rcpp::NumericVector(numPoints, tileColumns.coreWidth)
+  );
+}
+
+
+//' Tree crown segmentation of tile cache files
+//'
+//' Segments the tiles in files of \code{writeTileCacheFiles} like
+//' \code{segmentTilesBatch}. The files are memory-mapped and decoded on the
+//' threads, and tiles whose file holds a spatial index for the same
+//' \code{crownDiameter2TreeHeight} and \code{minHeight} do not build it
+//' again.
+//'
+//' @param files Character vector with the paths of the tile cache files.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height. Determines kernel diameter based on the height of its
+//'   center.
+//' @param crownHeight2TreeHeight Numeric scalar. Ratio of crown height to tree
+//'   height. Determines kernel height based on the height of its center.
+//' @param minNumNeighborsPerCore Integer scalar. The minimum number of
+//'   neighbors that a mode needs to have in order to be considered as a core
+//'   mode by DBSCAN.
+//' @param neighborhoodRadius Numeric scalar. The radius of the neighborhood of
+//'   a mode in DBSCAN.
+//' @param maxNumCentroidsPerMode Integer scalar. Maximum number of
+//'   iterations, i.e. steps that the kernel can move for each point.
+//' @param maxNumNeighbors Integer scalar. If positive, kernels with more
+//'   neighbors than this only use a deterministic subsample of them.
+//' @param minHeight Numeric scalar. Points below this height are ignored.
+//' @param bufferWidth Numeric scalar. Width of the buffer around the core
+//'   area of the tiles in meters.
+//' @param seedBufferWidth Numeric scalar. Width of the part of the buffer
+//'   whose points get their own modes. Negative values use the largest crown
+//'   radius of every tile, capped at \code{bufferWidth}.
+//' @param numThreads Integer scalar. Number of threads. Non-positive values
+//'   use all available cores.
+//' @param seedChunkSize Integer scalar. Number of seeds that a thread takes
+//'   from a tile at once. Non-positive values process every tile on a single
+//'   thread.
+//'
+//' @return A data.frame like that of \code{segmentTilesBatch}. The attribute
+//'   \code{loadSeconds} holds the time it took to map and decode all files.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame segmentTileCacheFiles(
+    Rcpp::CharacterVector files,
+    double crownDiameter2TreeHeight, double crownHeight2TreeHeight,
+    int minNumNeighborsPerCore, double neighborhoodRadius,
+    int maxNumCentroidsPerMode = 200, int maxNumNeighbors = 0,
+    double minHeight = 2, double bufferWidth = 10, double seedBufferWidth = -1,
+    int numThreads = 0, int seedChunkSize = 64
+){
+  if (neighborhoodRadius <= 0.0) {
+    Rcpp::stop("neighborhoodRadius must be positive.");
+  }
+
+  TileSegmentationParameters parameters;
+  parameters.crownDiameter2TreeHeight = crownDiameter2TreeHeight;
+  parameters.crownHeight2TreeHeight = crownHeight2TreeHeight;
+  parameters.maxNumCentroidsPerMode = maxNumCentroidsPerMode;
+  parameters.maxNumNeighbors = maxNumNeighbors;
+  parameters.minNumNeighborsPerCore = minNumNeighborsPerCore;
+  parameters.neighborhoodRadius = neighborhoodRadius;
+  parameters.minHeight = minHeight;
+  parameters.bufferWidth = bufferWidth;
+  parameters.seedBufferWidth = seedBufferWidth;
+
+  // Map the files here, since opening them can throw, and decode them on the
+  // threads. The mappings stay open while the tiles use their indices.
+  std::chrono::steady_clock::time_point start{ std::chrono::steady_clock::now() };
+  std::vector<std::string> paths{ Rcpp::as<std::vector<std::string> >(files) };
+  int numTiles{ static_cast<int>(paths.size()) };
+  std::vector<std::unique_ptr<TileCacheFile> > caches;
+  for (const std::string& path : paths) {
+    caches.emplace_back(new TileCacheFile{ path });
+  }
+  std::vector<TileColumns> tileColumns(numTiles);
+  std::vector<std::string> errors(numTiles);
+  parallelFor(0, numTiles, numThreads, [&](int tile) {
+    caches[tile]->decode(tileColumns[tile], errors[tile]);
+  }, 1);
+  for (const std::string& error : errors) {
+    if (!error.empty()) {
+      Rcpp::stop(error);
+    }
+  }
+  std::vector<TilePoints> tilePoints;
+  for (int tile{ 0 }; tile < numTiles; tile++) {
+    tilePoints.push_back(caches[tile]->points(tileColumns[tile]));
+  }
+  double loadSeconds{ secondsSince(start) };
+
+  std::vector<TileResult> results{
+    segmentTiles(tilePoints, parameters, numThreads, seedChunkSize)
+  };
+
+  Rcpp::DataFrame result{ createTileResultTable(results) };
+  result.attr("loadSeconds") = loadSeconds;
+  return result;
+}
+
+
+//' Compare loading tile cache files with parsing tile CSV files
+//'
+//' Measures, for every tile, the time until its points are in memory and
+//' indexed for the segmentation, once from a CSV file as written by
+//' \code{data.table::fwrite} and once from the tile cache file of the same
+//' tile.
+//'
+//' @param cacheFiles Character vector with the paths of the tile cache files.
+//' @param csvFiles Character vector with the paths of the CSV files of the
+//'   same tiles.
+//' @param crownDiameter2TreeHeight Numeric scalar. Ratio of crown diameter
+//'   to tree height of the spatial index.
+//' @param minHeight Numeric scalar. Points below this height are not
+//'   indexed.
+//'
+//' @return A data.frame with one row per tile and the columns
+//'   \code{numPoints}, \code{csvBytes}, \code{cacheBytes},
+//'   \code{parseSeconds} (reading the CSV file and building the index),
+//'   \code{loadSeconds} (mapping and decoding the cache file and restoring or
+//'   building the index) and \code{speedup}.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame compareTileCacheLoad(
+    Rcpp::CharacterVector cacheFiles, Rcpp::CharacterVector csvFiles,
+    double crownDiameter2TreeHeight, double minHeight = 2
+){
+  if (cacheFiles.size() != csvFiles.size()) {
+    Rcpp::stop("cacheFiles and csvFiles must have the same length.");
+  }
+  std::vector<std::string> cachePaths{
+    Rcpp::as<std::vector<std::string> >(cacheFiles)
+  };
+  std::vector<std::string> csvPaths{
+    Rcpp::as<std::vector<std::string> >(csvFiles)
+  };
+  int numTiles{ static_cast<int>(cachePaths.size()) };
+  Rcpp::IntegerVector numPoints(numTiles);
+  Rcpp::NumericVector csvBytes(numTiles);
+  Rcpp::NumericVector cacheBytes(numTiles);
+  Rcpp::NumericVector parseSeconds(numTiles);
+  Rcpp::NumericVector loadSeconds(numTiles);
+  Rcpp::NumericVector speedup(numTiles);
+
+  for (int tile{ 0 }; tile < numTiles; tile++) {
+    const std::string& csvPath{ csvPaths[tile] };
+    const std::string& cachePath{ cachePaths[tile] };
+    std::string error;
+
+    std::chrono::steady_clock::time_point start{ std::chrono::steady_clock::now() };
+    TileColumns parsed;
+    if (!readTileCsv(csvPath, parsed, error)) {
+      Rcpp::stop(error);
+    }
+    indexTile(parsed.points(), crownDiameter2TreeHeight, minHeight);
+    parseSeconds[tile] = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    TileCacheFile cache{ cachePath };
+    TileColumns loaded;
+    if (!cache.decode(loaded, error)) {
+      Rcpp::stop(error);
+    }
+    indexTile(cache.points(loaded), crownDiameter2TreeHeight, minHeight);
+    loadSeconds[tile] = secondsSince(start);
+
+    numPoints[tile] = cache.numPoints();
+    csvBytes[tile] = fileSize(csvPath);
+    cacheBytes[tile] = fileSize(cachePath);
+    speedup[tile] = loadSeconds[tile] > 0.0
+      ? parseSeconds[tile] / loadSeconds[tile] : NA_REAL;
+  }
+
+  return Rcpp::DataFrame::create(
+    Rcpp::Named("numPoints") = numPoints,
+    Rcpp::Named("csvBytes") = csvBytes,
+    Rcpp::Named("cacheBytes") = cacheBytes,
+    Rcpp::Named("parseSeconds") = parseSeconds,
+    Rcpp::Named("loadSeconds") = loadSeconds,
+    Rcpp::Named("speedup") = speedup
+  );
+}
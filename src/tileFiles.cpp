@@ -0,0 +1,153 @@
+#include "tileFiles.h"
+
+#include <cstdio>
+#include <cstdlib>  // for std::strtod
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+// Splits a line of a CSV file at the commas and removes quotes around the
+// fields
+std::vector<std::string> splitCsvLine(const std::string& line) {
+  std::vector<std::string> fields;
+  std::string field;
+  std::istringstream stream{ line };
+  while (std::getline(stream, field, ',')) {
+    if (!field.empty() && field.back() == '\r') {
+      field.pop_back();
+    }
+    if (field.size() >= 2 && field.front() == '"' && field.back() == '"') {
+      field = field.substr(1, field.size() - 2);
+    }
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+// Returns the position of the column or -1 if the header does not have it
+int findColumn(const std::vector<std::string>& header, const std::string& name) {
+  for (std::size_t column{ 0 }; column < header.size(); column++) {
+    if (header[column] == name) {
+      return static_cast<int>(column);
+    }
+  }
+  return -1;
+}
+
+// Parses a number. Logical values count as 0 and 1, like in R.
+double parseValue(const std::string& field) {
+  if (field == "TRUE") {
+    return 1.0;
+  }
+  if (field == "FALSE") {
+    return 0.0;
+  }
+  char* end;
+  double value{ std::strtod(field.c_str(), &end) };
+  return end == field.c_str() ? std::numeric_limits<double>::quiet_NaN() : value;
+}
+
+}  // namespace
+
+
+TilePoints TileColumns::points() const {
+  TilePoints tilePoints;
+  tilePoints.pointsX = pointsX.data();
+  tilePoints.pointsY = pointsY.data();
+  tilePoints.pointsZ = pointsZ.data();
+  tilePoints.buffer = buffer.data();
+  tilePoints.numPoints = static_cast<int>(pointsX.size());
+  tilePoints.hasCoreExtent = hasCoreExtent;
+  tilePoints.coreLowerLeftX = coreLowerLeftX;
+  tilePoints.coreLowerLeftY = coreLowerLeftY;
+  tilePoints.coreWidth = coreWidth;
+  tilePoints.serializedIndex = nullptr;
+  tilePoints.serializedIndexSize = 0;
+  return tilePoints;
+}
+
+
+bool readTileCsv(
+    const std::string& path, TileColumns& columns, std::string& error
+) {
+  std::ifstream file{ path };
+  std::string line;
+  if (!file || !std::getline(file, line)) {
+    error = "Cannot read the tile file " + path + ".";
+    return false;
+  }
+
+  // Find the columns in the header
+  std::vector<std::string> header{ splitCsvLine(line) };
+  int columnX{ findColumn(header, "X") };
+  int columnY{ findColumn(header, "Y") };
+  int columnZ{ findColumn(header, "Z") };
+  int columnBuffer{ findColumn(header, "Buffer") };
+  int columnLowerLeftX{ findColumn(header, "sBPC_llX") };
+  int columnLowerLeftY{ findColumn(header, "sBPC_llY") };
+  int columnWidth{ findColumn(header, "sBPC_Width") };
+  if (columnX < 0 || columnY < 0 || columnZ < 0 || columnBuffer < 0) {
+    error = "The tile file " + path + " needs the columns X, Y, Z and Buffer.";
+    return false;
+  }
+  columns.hasCoreExtent =
+    columnLowerLeftX >= 0 && columnLowerLeftY >= 0 && columnWidth >= 0;
+
+  // Read the points
+  std::size_t numColumns{ header.size() };
+  while (std::getline(file, line)) {
+    if (line.empty() || line == "\r") {
+      continue;
+    }
+    std::vector<std::string> fields{ splitCsvLine(line) };
+    if (fields.size() < numColumns) {
+      error = "The tile file " + path + " has rows with missing fields.";
+      return false;
+    }
+    columns.pointsX.push_back(parseValue(fields[columnX]));
+    columns.pointsY.push_back(parseValue(fields[columnY]));
+    columns.pointsZ.push_back(parseValue(fields[columnZ]));
+    columns.buffer.push_back(parseValue(fields[columnBuffer]));
+    if (columns.hasCoreExtent && columns.pointsX.size() == 1) {
+      columns.coreLowerLeftX = parseValue(fields[columnLowerLeftX]);
+      columns.coreLowerLeftY = parseValue(fields[columnLowerLeftY]);
+      columns.coreWidth = parseValue(fields[columnWidth]);
+    }
+  }
+  columns.hasCoreExtent = columns.hasCoreExtent && !columns.pointsX.empty();
+
+  return true;
+}
+
+
+bool writeSegmentedCsv(
+    const std::string& path, const TileResult& result, const int crownIdOffset,
+    std::string& error
+) {
+  std::FILE* file{ std::fopen(path.c_str(), "w") };
+  if (file == nullptr) {
+    error = "Cannot write the file " + path + ".";
+    return false;
+  }
+
+  std::fputs("X,Y,Z,modeX,modeY,modeZ,crown_id\n", file);
+  for (std::size_t k{ 0 }; k < result.crownIds.size(); k++) {
+    int crownId{ result.crownIds[k] > 0 ? result.crownIds[k] + crownIdOffset : 0 };
+    std::fprintf(
+      file, "%.15g,%.15g,%.15g,%.15g,%.15g,%.15g,%d\n",
+      result.pointsX[k], result.pointsY[k], result.pointsZ[k],
+      result.modesX[k], result.modesY[k], result.modesZ[k], crownId
+    );
+  }
+
+  if (std::fclose(file) != 0) {
+    error = "Cannot write the file " + path + ".";
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,49 @@
+#ifndef TILE_FILES_H
+#define TILE_FILES_H
+
+#include "tileSegmentation.h"
+
+#include <string>
+#include <vector>
+
+
+/** The columns of a buffered tile that was read from a file. */
+struct TileColumns {
+  std::vector<double> pointsX;
+  std::vector<double> pointsY;
+  std::vector<double> pointsZ;
+  std::vector<double> buffer;
+  bool hasCoreExtent;
+  double coreLowerLeftX;
+  double coreLowerLeftY;
+  double coreWidth;
+
+  /** The view of the columns that BufferedTileSegmentation expects. */
+  TilePoints points() const;
+};
+
+
+/** Reads a tile from a CSV file with a header line, as written by
+ *  data.table::fwrite for the tiles of split_point_cloud_buffered.
+ *
+ *  The columns X, Y, Z and Buffer are required, the columns sBPC_llX,
+ *  sBPC_llY and sBPC_Width of quadtree tiles are used if they are present and
+ *  all other columns are skipped. Returns false and sets \p error if the file
+ *  cannot be read. Does not call the R API.
+ */
+bool readTileCsv(
+  const std::string& path, TileColumns& columns, std::string& error
+);
+
+
+/** Writes the points that a tile keeps to a CSV file with the columns X, Y,
+ *  Z, modeX, modeY, modeZ and crown_id. The crown IDs of the tile are shifted
+ *  by \p crownIdOffset, crown ID 0 stays 0. Returns false and sets \p error if
+ *  the file cannot be written. Does not call the R API.
+ */
+bool writeSegmentedCsv(
+  const std::string& path, const TileResult& result, const int crownIdOffset,
+  std::string& error
+);
+
+#endif  // define TILE_FILES_H
@@ -0,0 +1,235 @@
+#include "tilePipeline.h"
+
+#include "boundedQueue.h"
+#include "parallelFor.h"
+#include "tileFiles.h"
+
+#include <algorithm>  // for std::max
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+struct ReadTile {
+  int tile;
+  std::unique_ptr<TileColumns> columns;
+};
+
+struct SegmentedTile {
+  int tile;
+  std::unique_ptr<TileResult> result;
+};
+
+double secondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start
+  ).count();
+}
+
+// The error message of a tile whose stage threw an exception
+std::string exceptionError(const char* action, const int tile,
+                           const std::exception& exception) {
+  return std::string("Cannot ") + action + " tile " + std::to_string(tile + 1)
+    + ": " + exception.what();
+}
+
+// Collects the work of the threads of one stage
+class StageRecorder {
+public:
+
+  explicit StageRecorder(const int numThreads) {
+    statistics.numThreads = numThreads;
+    statistics.numTiles = 0;
+    statistics.busySeconds = 0.0;
+  }
+
+  void add(const int numTiles, const double busySeconds) {
+    std::lock_guard<std::mutex> lock{ mutex };
+    statistics.numTiles += numTiles;
+    statistics.busySeconds += busySeconds;
+  }
+
+  PipelineStageStatistics statistics;
+
+private:
+
+  std::mutex mutex;
+};
+
+}  // namespace
+
+
+TilePipelineStatistics runTilePipeline(
+    const int numTiles, const TileReader& tileReader,
+    const std::vector<std::string>& outputPaths,
+    const TileSegmentationParameters& parameters,
+    const TilePipelineSettings& settings
+) {
+  auto start = std::chrono::steady_clock::now();
+  int numReaders{ std::max(1, settings.numReaders) };
+  int numSegmenters{ resolveNumThreads(settings.numSegmenters) };
+  int numWriters{ std::max(1, settings.numWriters) };
+
+  BoundedQueue<ReadTile> readTiles(settings.queueCapacity);
+  BoundedQueue<SegmentedTile> segmentedTiles(settings.queueCapacity);
+  StageRecorder reading{ numReaders };
+  StageRecorder segmenting{ numSegmenters };
+  StageRecorder writing{ numWriters };
+
+  std::mutex errorMutex;
+  std::vector<std::string> errors;
+  auto addError = [&](const std::string& error) {
+    std::lock_guard<std::mutex> lock{ errorMutex };
+    errors.push_back(error);
+  };
+
+
+  // Exceptions must not leave the threads of the stages. A tile whose work
+  // throws is reported as an error and dropped, and its stage goes on with
+  // the next tile, so that the queue to the next stage is still closed.
+
+  // Readers read the tiles in the order of their numbers. The last reader to
+  // finish tells the segmenters that no more tiles come.
+  std::atomic<int> nextTile{ 0 };
+  std::atomic<int> numRunningReaders{ numReaders };
+  auto read = [&]() {
+    int numReadTiles{ 0 };
+    double busySeconds{ 0.0 };
+    while (true) {
+      int tile{ nextTile.fetch_add(1) };
+      if (tile >= numTiles) {
+        break;
+      }
+      auto readStart = std::chrono::steady_clock::now();
+      ReadTile readTile{ tile, nullptr };
+      std::string error;
+      bool isRead{ false };
+      try {
+        readTile.columns.reset(new TileColumns);
+        isRead = tileReader(tile, *readTile.columns, error);
+      } catch (const std::exception& exception) {
+        error = exceptionError("read", tile, exception);
+      }
+      busySeconds += secondsSince(readStart);
+      if (!isRead) {
+        addError(error);
+        continue;
+      }
+      numReadTiles += 1;
+      readTiles.push(std::move(readTile));
+    }
+    reading.add(numReadTiles, busySeconds);
+    if (numRunningReaders.fetch_sub(1) == 1) {
+      readTiles.close();
+    }
+  };
+
+  // Segmenters process one tile each at a time
+  std::atomic<int> numRunningSegmenters{ numSegmenters };
+  auto segment = [&]() {
+    int numSegmentedTiles{ 0 };
+    double busySeconds{ 0.0 };
+    ReadTile readTile;
+    while (readTiles.pop(readTile)) {
+      auto segmentStart = std::chrono::steady_clock::now();
+      SegmentedTile segmentedTile{ readTile.tile, nullptr };
+      try {
+        BufferedTileSegmentation segmentation{
+          readTile.columns->points(), parameters
+        };
+        readTile.columns.reset();
+        segmentation.findModes(0, segmentation.numSeeds());
+        segmentedTile.result.reset(new TileResult(segmentation.finish()));
+      } catch (const std::exception& exception) {
+        readTile.columns.reset();
+        addError(exceptionError("segment", readTile.tile, exception));
+        continue;
+      }
+      busySeconds += secondsSince(segmentStart);
+      numSegmentedTiles += 1;
+      segmentedTiles.push(std::move(segmentedTile));
+    }
+    segmenting.add(numSegmentedTiles, busySeconds);
+    if (numRunningSegmenters.fetch_sub(1) == 1) {
+      segmentedTiles.close();
+    }
+  };
+
+  // Writers give every tile the next free crown IDs
+  std::atomic<int> numCrowns{ 0 };
+  auto write = [&]() {
+    int numWrittenTiles{ 0 };
+    double busySeconds{ 0.0 };
+    SegmentedTile segmentedTile;
+    while (segmentedTiles.pop(segmentedTile)) {
+      auto writeStart = std::chrono::steady_clock::now();
+      int crownIdOffset{ numCrowns.fetch_add(segmentedTile.result->numCrowns) };
+      std::string error;
+      bool isWritten{ false };
+      try {
+        isWritten = writeSegmentedCsv(
+          outputPaths[segmentedTile.tile], *segmentedTile.result, crownIdOffset,
+          error
+        );
+      } catch (const std::exception& exception) {
+        error = exceptionError("write", segmentedTile.tile, exception);
+      }
+      segmentedTile.result.reset();
+      busySeconds += secondsSince(writeStart);
+      if (!isWritten) {
+        addError(error);
+        continue;
+      }
+      numWrittenTiles += 1;
+    }
+    writing.add(numWrittenTiles, busySeconds);
+  };
+
+  std::vector<std::thread> threads;
+  for (int reader{ 0 }; reader < numReaders; reader++) {
+    threads.emplace_back(read);
+  }
+  for (int segmenter{ 0 }; segmenter < numSegmenters; segmenter++) {
+    threads.emplace_back(segment);
+  }
+  for (int writer{ 0 }; writer < numWriters; writer++) {
+    threads.emplace_back(write);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  TilePipelineStatistics statistics;
+  statistics.reading = reading.statistics;
+  statistics.segmenting = segmenting.statistics;
+  statistics.writing = writing.statistics;
+  statistics.seconds = secondsSince(start);
+  statistics.numCrowns = numCrowns.load();
+  statistics.errors = errors;
+  return statistics;
+}
+
+
+TilePipelineStatistics runTilePipeline(
+    const std::vector<std::string>& inputPaths,
+    const std::vector<std::string>& outputPaths,
+    const TileSegmentationParameters& parameters,
+    const TilePipelineSettings& settings
+) {
+  TileReader tileReader{
+    [&inputPaths](int tile, TileColumns& columns, std::string& error) {
+      return readTileCsv(inputPaths[tile], columns, error);
+    }
+  };
+  return runTilePipeline(
+    static_cast<int>(inputPaths.size()), tileReader, outputPaths, parameters,
+    settings
+  );
+}
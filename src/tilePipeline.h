@@ -0,0 +1,83 @@
+#ifndef TILE_PIPELINE_H
+#define TILE_PIPELINE_H
+
+#include "tileFiles.h"
+#include "tileSegmentation.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+
+/** The numbers of threads of the stages of runTilePipeline and the number
+ *  of tiles that may wait between two stages.
+ */
+struct TilePipelineSettings {
+  int numReaders;
+  int numSegmenters;
+  int numWriters;
+  int queueCapacity;
+};
+
+
+/** How much one stage of runTilePipeline worked. */
+struct PipelineStageStatistics {
+  int numThreads;
+  int numTiles;
+  // Time that the threads of the stage spent working rather than waiting
+  // for other stages, summed over the threads
+  double busySeconds;
+};
+
+
+struct TilePipelineStatistics {
+  PipelineStageStatistics reading;
+  PipelineStageStatistics segmenting;
+  PipelineStageStatistics writing;
+  double seconds;
+  int numCrowns;
+  // Messages of the tiles that could not be read, segmented or written
+  std::vector<std::string> errors;
+};
+
+
+/** Reads tile \p tile into \p columns. Returns false and sets \p error if
+ *  the tile cannot be read. Is called from several threads at once and must
+ *  not call the R API.
+ */
+typedef std::function<bool(int tile, TileColumns& columns, std::string& error)>
+  TileReader;
+
+
+/** Segments the \p numTiles tiles that \p tileReader reads and writes the
+ *  points that every tile keeps to the corresponding file of \p outputPaths.
+ *
+ *  Reading, segmenting and writing run on their own threads at the same
+ *  time, connected by queues of at most queueCapacity tiles. A stage that is
+ *  ahead blocks until the next stage catches up, so at most about
+ *  2 * queueCapacity tiles plus one tile per thread are held in memory. The
+ *  crown IDs are unique over all files, but they depend on the order in
+ *  which the tiles are written. Tiles that cannot be read, segmented or
+ *  written, including those whose stage throws, are skipped and reported in
+ *  the errors of the statistics. Does not call the R API.
+ */
+TilePipelineStatistics runTilePipeline(
+  const int numTiles, const TileReader& tileReader,
+  const std::vector<std::string>& outputPaths,
+  const TileSegmentationParameters& parameters,
+  const TilePipelineSettings& settings
+);
+
+
+/** Segments the tiles in the CSV files \p inputPaths and writes the points
+ *  that every tile keeps to the corresponding file of \p outputPaths, like
+ *  the overload with a TileReader.
+ */
+TilePipelineStatistics runTilePipeline(
+  const std::vector<std::string>& inputPaths,
+  const std::vector<std::string>& outputPaths,
+  const TileSegmentationParameters& parameters,
+  const TilePipelineSettings& settings
+);
+
+#endif  // define TILE_PIPELINE_H
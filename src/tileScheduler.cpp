@@ -0,0 +1,174 @@
+#include "tileScheduler.h"
+
+#include "parallelFor.h"
+
+#include <algorithm>  // for std::min
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+/** The state of one tile that threads share while its seeds are moved. */
+struct TileTask {
+  std::unique_ptr<BufferedTileSegmentation> segmentation;
+  int numSeeds{ 0 };
+  // Set once the segmentation is prepared and numSeeds is valid
+  std::atomic<bool> isReady{ false };
+  // The first seed that no thread has taken yet
+  std::atomic<int> nextSeed{ 0 };
+  // The number of seeds whose modes are not calculated yet
+  std::atomic<int> numPendingSeeds{ 0 };
+  // Time that threads spent on the tile so far
+  std::atomic<long long> nanoseconds{ 0 };
+};
+
+long long nanosecondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start
+  ).count();
+}
+
+}  // namespace
+
+
+std::vector<TileResult> segmentTiles(
+    const std::vector<TilePoints>& tilePoints,
+    const TileSegmentationParameters& parameters,
+    const int numThreads, const int seedChunkSize,
+    const std::vector<int>& tileOrder
+) {
+  int numTiles{ static_cast<int>(tilePoints.size()) };
+  std::vector<TileResult> results(numTiles);
+  std::vector<TileTask> tasks(numTiles);
+  std::atomic<int> nextTile{ 0 };
+  std::atomic<int> numReadyTiles{ 0 };
+
+  // Exceptions must not leave the threads. The first one stops all threads
+  // and is rethrown once they are joined.
+  std::atomic<bool> isFailed{ false };
+  std::mutex failureMutex;
+  std::exception_ptr failure;
+
+  // Clusters the modes of a tile whose seeds are all processed
+  auto finishTile = [&](const int tile) {
+    TileTask& task{ tasks[tile] };
+    auto start = std::chrono::steady_clock::now();
+    results[tile] = task.segmentation->finish();
+    task.segmentation.reset();
+    results[tile].seconds = (task.nanoseconds.load() + nanosecondsSince(start))
+      / 1e9;
+  };
+
+  // Moves the kernels of the seeds of a tile that no other thread has taken
+  // yet. Whoever finishes the last seeds of the tile clusters its modes and
+  // frees the tile.
+  auto processSeeds = [&](const int tile) {
+    TileTask& task{ tasks[tile] };
+    int chunkSize{ seedChunkSize > 0 ? seedChunkSize : task.numSeeds };
+    while (!isFailed.load()) {
+      int firstSeed{ task.nextSeed.fetch_add(chunkSize) };
+      if (firstSeed >= task.numSeeds) {
+        return;
+      }
+      int lastSeed{ std::min(task.numSeeds, firstSeed + chunkSize) };
+      auto start = std::chrono::steady_clock::now();
+      task.segmentation->findModes(firstSeed, lastSeed);
+      task.nanoseconds.fetch_add(nanosecondsSince(start));
+      int numSeeds{ lastSeed - firstSeed };
+      if (task.numPendingSeeds.fetch_sub(numSeeds) == numSeeds) {
+        finishTile(tile);
+      }
+    }
+  };
+
+  // Returns the ready tile with the most seeds that no thread has taken, or
+  // -1 if there is none
+  auto findTileToSteal = [&]() {
+    int bestTile{ -1 };
+    int maxNumRemainingSeeds{ 0 };
+    for (int tile{ 0 }; tile < numTiles; tile++) {
+      TileTask& task{ tasks[tile] };
+      if (!task.isReady.load(std::memory_order_acquire)) {
+        continue;
+      }
+      int numRemainingSeeds{ task.numSeeds - task.nextSeed.load() };
+      if (numRemainingSeeds > maxNumRemainingSeeds) {
+        bestTile = tile;
+        maxNumRemainingSeeds = numRemainingSeeds;
+      }
+    }
+    return bestTile;
+  };
+
+  auto work = [&]() {
+    // Process whole tiles as long as there are untouched ones
+    while (!isFailed.load()) {
+      int position{ nextTile.fetch_add(1) };
+      if (position >= numTiles) {
+        break;
+      }
+      int tile{ tileOrder.empty() ? position : tileOrder[position] };
+      TileTask& task{ tasks[tile] };
+      auto start = std::chrono::steady_clock::now();
+      task.segmentation.reset(
+        new BufferedTileSegmentation{ tilePoints[tile], parameters }
+      );
+      task.numSeeds = task.segmentation->numSeeds();
+      task.nanoseconds.store(nanosecondsSince(start));
+      if (task.numSeeds == 0) {
+        finishTile(tile);
+      }
+      task.numPendingSeeds.store(task.numSeeds);
+      task.isReady.store(true, std::memory_order_release);
+      numReadyTiles.fetch_add(1);
+      processSeeds(tile);
+    }
+
+    // Then help with the seeds of the tiles that are still running
+    while (!isFailed.load()) {
+      int tile{ findTileToSteal() };
+      if (tile >= 0) {
+        processSeeds(tile);
+      } else if (numReadyTiles.load() == numTiles) {
+        return;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  };
+
+  auto workSafely = [&]() {
+    try {
+      work();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock{ failureMutex };
+      if (!failure) {
+        failure = std::current_exception();
+      }
+      isFailed.store(true);
+    }
+  };
+
+  // There can be more threads than tiles, since threads also share the seeds
+  // of a tile. The calling thread works as well.
+  int numWorkers{ resolveNumThreads(numThreads) };
+  std::vector<std::thread> workers;
+  for (int worker{ 1 }; worker < numWorkers; worker++) {
+    workers.emplace_back(workSafely);
+  }
+  workSafely();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+  return results;
+}
@@ -0,0 +1,32 @@
+#ifndef TILE_SCHEDULER_H
+#define TILE_SCHEDULER_H
+
+#include "tileSegmentation.h"
+
+#include <vector>
+
+
+/** Segments all tiles on \p numThreads threads and returns the result of
+ *  every tile, in the order of \p tilePoints.
+ *
+ *  Every thread takes the next unprocessed tile, prepares it and moves the
+ *  kernels of its seeds in ranges of \p seedChunkSize seeds. The tiles are
+ *  taken in the order of the positions in \p tileOrder, or in the order of
+ *  \p tilePoints if it is empty, so expensive tiles can go first. Once all
+ *  tiles have been taken, idle threads steal seed ranges from the tiles that
+ *  are still running, starting with the tile that has the most seeds left.
+ *  The thread that finishes the last range of a tile clusters its modes. The
+ *  results do not depend on the number of threads or on which thread moved
+ *  which seeds. Non-positive \p seedChunkSize values process every tile on
+ *  a single thread. If the work on a tile throws, the other threads stop
+ *  after their current seed range and the first exception is rethrown on
+ *  the calling thread.
+ */
+std::vector<TileResult> segmentTiles(
+    const std::vector<TilePoints>& tilePoints,
+    const TileSegmentationParameters& parameters,
+    const int numThreads, const int seedChunkSize = 64,
+    const std::vector<int>& tileOrder = std::vector<int>()
+);
+
+#endif  // define TILE_SCHEDULER_H
@@ -0,0 +1,202 @@
+#include "tileSegmentation.h"
+
+#include "cylinderKernel.h"
+#include "modeClustering.h"
+
+#include <algorithm>  // for std::max, std::min
+#include <cmath>      // for std::ceil, std::floor
+#include <limits>
+#include <vector>
+
+
+namespace {
+
+std::vector<int> selectPointsAboveMinHeight(
+    const TilePoints& tilePoints, const double minHeight
+) {
+  std::vector<int> positions;
+  for (int i{ 0 }; i < tilePoints.numPoints; i++) {
+    if (tilePoints.pointsZ[i] >= minHeight) {
+      positions.push_back(i);
+    }
+  }
+  return positions;
+}
+
+std::vector<double> gather(
+    const double* column, const std::vector<int>& positions
+) {
+  std::vector<double> values(positions.size());
+  for (std::size_t k{ 0 }; k < positions.size(); k++) {
+    values[k] = column[positions[k]];
+  }
+  return values;
+}
+
+// Restores the index of the tile if it has a matching one and builds it
+// otherwise
+HeightBandedGridIndex createIndex(
+    const TilePoints& tilePoints, const std::vector<double>& pointsX,
+    const std::vector<double>& pointsY, const std::vector<double>& pointsZ,
+    const double crownDiameter2TreeHeight
+) {
+  int numPoints{ static_cast<int>(pointsX.size()) };
+  if (tilePoints.serializedIndex != nullptr
+      && HeightBandedGridIndex::isSerializedFor(
+           tilePoints.serializedIndex, tilePoints.serializedIndexSize,
+           numPoints, crownDiameter2TreeHeight)) {
+    return HeightBandedGridIndex(
+      pointsX.data(), pointsY.data(), pointsZ.data(), numPoints,
+      tilePoints.serializedIndex
+    );
+  }
+  return HeightBandedGridIndex(
+    pointsX.data(), pointsY.data(), pointsZ.data(), numPoints,
+    crownDiameter2TreeHeight
+  );
+}
+
+}  // namespace
+
+
+BufferedTileSegmentation::BufferedTileSegmentation(
+    const TilePoints& tilePoints, const TileSegmentationParameters& parameters
+) : parameters(parameters),
+    tilePositions(selectPointsAboveMinHeight(tilePoints, parameters.minHeight)),
+    pointsX(gather(tilePoints.pointsX, tilePositions)),
+    pointsY(gather(tilePoints.pointsY, tilePositions)),
+    pointsZ(gather(tilePoints.pointsZ, tilePositions)),
+    buffer(gather(tilePoints.buffer, tilePositions)),
+    index(createIndex(
+      tilePoints, pointsX, pointsY, pointsZ, parameters.crownDiameter2TreeHeight
+    )) {
+  // Get margins of the core area
+  const double INF{ std::numeric_limits<double>::infinity() };
+  coreMinX = INF;
+  coreMaxX = -INF;
+  coreMinY = INF;
+  coreMaxY = -INF;
+  double maxZ{ -INF };
+  for (int i{ 0 }; i < numPoints(); i++) {
+    maxZ = std::max(maxZ, pointsZ[i]);
+    if (buffer[i] == 0.0) {
+      coreMinX = std::min(coreMinX, pointsX[i]);
+      coreMaxX = std::max(coreMaxX, pointsX[i]);
+      coreMinY = std::min(coreMinY, pointsY[i]);
+      coreMaxY = std::max(coreMaxY, pointsY[i]);
+    }
+  }
+  if (tilePoints.hasCoreExtent) {
+    coreMinX = tilePoints.coreLowerLeftX;
+    coreMaxX = tilePoints.coreLowerLeftX + tilePoints.coreWidth;
+    coreMinY = tilePoints.coreLowerLeftY;
+    coreMaxY = tilePoints.coreLowerLeftY + tilePoints.coreWidth;
+  } else {
+    coreMinX = std::floor(coreMinX);
+    coreMaxX = std::ceil(coreMaxX);
+    coreMinY = std::floor(coreMinY);
+    coreMaxY = std::ceil(coreMaxY);
+  }
+
+  // Only the core points and the buffer points that can belong to a crown
+  // whose center lies in the core area need their own modes
+  double seedBufferWidth{ parameters.seedBufferWidth };
+  if (seedBufferWidth < 0.0) {
+    seedBufferWidth = std::min(
+      parameters.bufferWidth,
+      parameters.crownDiameter2TreeHeight * maxZ / 2.0
+    );
+  }
+  for (int i{ 0 }; i < numPoints(); i++) {
+    if (buffer[i] == 0.0
+        || (coreMinX - seedBufferWidth <= pointsX[i]
+            && pointsX[i] <= coreMaxX + seedBufferWidth
+            && coreMinY - seedBufferWidth <= pointsY[i]
+            && pointsY[i] <= coreMaxY + seedBufferWidth)) {
+      seedPositions.push_back(i);
+    }
+  }
+
+  modesX.resize(seedPositions.size());
+  modesY.resize(seedPositions.size());
+  modesZ.resize(seedPositions.size());
+}
+
+
+void BufferedTileSegmentation::findModes(const int firstSeed, const int lastSeed) {
+  for (int seed{ firstSeed }; seed < lastSeed; seed++) {
+    int i{ seedPositions[seed] };
+    Mode mode{ findMode(
+      index, pointsX[i], pointsY[i], pointsZ[i],
+      parameters.crownDiameter2TreeHeight, parameters.crownHeight2TreeHeight,
+      parameters.maxNumCentroidsPerMode, parameters.maxNumNeighbors
+    ) };
+    modesX[seed] = mode.x;
+    modesY[seed] = mode.y;
+    modesZ[seed] = mode.z;
+  }
+}
+
+
+TileResult BufferedTileSegmentation::finish() const {
+  TileResult result;
+  result.numCrowns = 0;
+  result.seconds = 0.0;
+
+  // Identify mode clusters with the DBSCAN algorithm
+  std::vector<int> clusterIds{ clusterModes(
+    modesX.data(), modesY.data(), modesZ.data(), numSeeds(),
+    parameters.neighborhoodRadius, parameters.minNumNeighborsPerCore + 1
+  ) };
+
+  // Get the mean position of every cluster
+  int numClusters{ 0 };
+  for (int clusterId : clusterIds) {
+    numClusters = std::max(numClusters, clusterId);
+  }
+  std::vector<double> sumsX(numClusters + 1, 0.0);
+  std::vector<double> sumsY(numClusters + 1, 0.0);
+  std::vector<int> counts(numClusters + 1, 0);
+  for (int seed{ 0 }; seed < numSeeds(); seed++) {
+    sumsX[clusterIds[seed]] += modesX[seed];
+    sumsY[clusterIds[seed]] += modesY[seed];
+    counts[clusterIds[seed]] += 1;
+  }
+
+  auto isInCore = [this](const double x, const double y) {
+    return coreMinX <= x && x <= coreMaxX && coreMinY <= y && y <= coreMaxY;
+  };
+
+  // Only keep clusters whose mean position lies inside the core area and
+  // number them consecutively
+  std::vector<int> crownIds(numClusters + 1, 0);
+  for (int cluster{ 1 }; cluster <= numClusters; cluster++) {
+    if (counts[cluster] > 0
+        && isInCore(sumsX[cluster] / counts[cluster],
+                    sumsY[cluster] / counts[cluster])) {
+      crownIds[cluster] = ++result.numCrowns;
+    } else {
+      crownIds[cluster] = -1;
+    }
+  }
+
+  // Keep the points of these clusters and all unclustered modes that are
+  // within the core area
+  for (int seed{ 0 }; seed < numSeeds(); seed++) {
+    int crownId{ crownIds[clusterIds[seed]] };
+    if (crownId < 0
+        || (clusterIds[seed] == 0 && !isInCore(modesX[seed], modesY[seed]))) {
+      continue;
+    }
+    int i{ seedPositions[seed] };
+    result.pointsX.push_back(pointsX[i]);
+    result.pointsY.push_back(pointsY[i]);
+    result.pointsZ.push_back(pointsZ[i]);
+    result.modesX.push_back(modesX[seed]);
+    result.modesY.push_back(modesY[seed]);
+    result.modesZ.push_back(modesZ[seed]);
+    result.crownIds.push_back(crownId);
+  }
+
+  return result;
+}
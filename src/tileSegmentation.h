@@ -0,0 +1,117 @@
+#ifndef TILE_SEGMENTATION_H
+#define TILE_SEGMENTATION_H
+
+#include "heightBandedGridIndex.h"
+
+#include <cstddef>
+#include <vector>
+
+
+/** The settings of the tree crown segmentation of buffered tiles. */
+struct TileSegmentationParameters {
+  double crownDiameter2TreeHeight;
+  double crownHeight2TreeHeight;
+  int maxNumCentroidsPerMode;
+  int maxNumNeighbors;
+  int minNumNeighborsPerCore;
+  double neighborhoodRadius;
+  double minHeight;
+  double bufferWidth;
+  // Width of the part of the buffer whose points get their own modes.
+  // Negative values use the largest crown radius of the tile, capped at
+  // bufferWidth.
+  double seedBufferWidth;
+};
+
+
+/** The points of one buffered tile, as columns of its data.table. */
+struct TilePoints {
+  const double* pointsX;
+  const double* pointsY;
+  const double* pointsZ;
+  const double* buffer;
+  int numPoints;
+  // The core area of the tile. Without it, the core area is the extent of
+  // the core points, rounded outwards to whole meters.
+  bool hasCoreExtent;
+  double coreLowerLeftX;
+  double coreLowerLeftY;
+  double coreWidth;
+  // Null or the serialized spatial index of the points above the minimum
+  // height, e.g. from a tile cache file. It is only used if it was built with
+  // the same crownDiameter2TreeHeight for the same points.
+  const unsigned char* serializedIndex;
+  std::size_t serializedIndexSize;
+};
+
+
+/** The points that a tile keeps after the core area filter, with their
+ *  modes and crown IDs within the tile.
+ */
+struct TileResult {
+  std::vector<double> pointsX;
+  std::vector<double> pointsY;
+  std::vector<double> pointsZ;
+  std::vector<double> modesX;
+  std::vector<double> modesY;
+  std::vector<double> modesZ;
+  // 0 for points whose modes are not part of a cluster
+  std::vector<int> crownIds;
+  int numCrowns;
+  // Time that threads spent on the tile, summed over all threads
+  double seconds;
+};
+
+
+/** The tree crown segmentation of one buffered tile, as it is done by the
+ *  R function mean_shift_buffered of segment_tree_crowns_parallel with the
+ *  "improved" version.
+ *
+ *  The work is split into three steps so that the trajectories of a tile can
+ *  be shared among threads: the constructor removes the points below the
+ *  minimum height, indexes the remaining ones and selects the seeds.
+ *  findModes then moves the kernels of a range of seeds and can be called
+ *  concurrently for disjoint ranges. Finally, finish clusters the modes with
+ *  DBSCAN and keeps the crowns whose center lies in the core area, together
+ *  with the unclustered modes in the core area. None of the steps calls the
+ *  R API.
+ */
+class BufferedTileSegmentation {
+public:
+
+  BufferedTileSegmentation(
+    const TilePoints& tilePoints, const TileSegmentationParameters& parameters
+  );
+
+  int numSeeds() const { return static_cast<int>(seedPositions.size()); }
+  int numPoints() const { return static_cast<int>(pointsZ.size()); }
+
+  void findModes(const int firstSeed, const int lastSeed);
+
+  TileResult finish() const;
+
+private:
+
+  TileSegmentationParameters parameters;
+
+  // The points above the minimum height, in the order of the tile
+  std::vector<int> tilePositions;
+  std::vector<double> pointsX;
+  std::vector<double> pointsY;
+  std::vector<double> pointsZ;
+  std::vector<double> buffer;
+  HeightBandedGridIndex index;
+
+  // Extent of the core area
+  double coreMinX;
+  double coreMaxX;
+  double coreMinY;
+  double coreMaxY;
+
+  std::vector<int> seedPositions;
+  std::vector<double> modesX;
+  std::vector<double> modesY;
+  std::vector<double> modesZ;
+};
+
+#endif  // define TILE_SEGMENTATION_H
@@ -0,0 +1,131 @@
+#include "tileTables.h"
+
+#include <Rcpp.h>
+#include <vector>
+
+
+std::vector<TilePoints> getTilePoints(
+    Rcpp::List tiles, std::vector<Rcpp::NumericVector>& columns
+) {
+  int numTiles{ static_cast<int>(tiles.size()) };
+  std::vector<TilePoints> tilePoints(numTiles);
+  for (int tile{ 0 }; tile < numTiles; tile++) {
+    Rcpp::DataFrame tileDataFrame{ Rcpp::as<Rcpp::DataFrame>(tiles[tile]) };
+    for (const char* name : { "X", "Y", "Z", "Buffer" }) {
+      if (!tileDataFrame.containsElementNamed(name)) {
+        Rcpp::stop("Every tile needs the columns X, Y, Z and Buffer.");
+      }
+      columns.push_back(Rcpp::as<Rcpp::NumericVector>(tileDataFrame[name]));
+    }
+    std::size_t first{ columns.size() - 4 };
+    tilePoints[tile].pointsX = columns[first].begin();
+    tilePoints[tile].pointsY = columns[first + 1].begin();
+    tilePoints[tile].pointsZ = columns[first + 2].begin();
+    tilePoints[tile].buffer = columns[first + 3].begin();
+    tilePoints[tile].numPoints = static_cast<int>(columns[first].size());
+
+    // Use the exact core area of quadtree tiles
+    tilePoints[tile].hasCoreExtent =
+      tileDataFrame.containsElementNamed("sBPC_Width")
+      && tilePoints[tile].numPoints > 0;
+    if (tilePoints[tile].hasCoreExtent) {
+      tilePoints[tile].coreLowerLeftX =
+        Rcpp::as<Rcpp::NumericVector>(tileDataFrame["sBPC_llX"])[0];
+      tilePoints[tile].coreLowerLeftY =
+        Rcpp::as<Rcpp::NumericVector>(tileDataFrame["sBPC_llY"])[0];
+      tilePoints[tile].coreWidth =
+        Rcpp::as<Rcpp::NumericVector>(tileDataFrame["sBPC_Width"])[0];
+    }
+  }
+  return tilePoints;
+}
+
+
+Rcpp::DataFrame createTileResultTable(const std::vector<TileResult>& results) {
+  int numRows{ 0 };
+  for (const TileResult& result : results) {
+    numRows += static_cast<int>(result.crownIds.size());
+  }
+  Rcpp::NumericVector pointsX(numRows);
+  Rcpp::NumericVector pointsY(numRows);
+  Rcpp::NumericVector pointsZ(numRows);
+  Rcpp::NumericVector modesX(numRows);
+  Rcpp::NumericVector modesY(numRows);
+  Rcpp::NumericVector modesZ(numRows);
+  Rcpp::IntegerVector crownIds(numRows);
+
+  int row{ 0 };
+  for (bool isClustered : { true, false }) {
+    int crownIdOffset{ 0 };
+    for (const TileResult& result : results) {
+      for (std::size_t k{ 0 }; k < result.crownIds.size(); k++) {
+        if ((result.crownIds[k] > 0) != isClustered) {
+          continue;
+        }
+        pointsX[row] = result.pointsX[k];
+        pointsY[row] = result.pointsY[k];
+        pointsZ[row] = result.pointsZ[k];
+        modesX[row] = result.modesX[k];
+        modesY[row] = result.modesY[k];
+        modesZ[row] = result.modesZ[k];
+        crownIds[row] = isClustered ? result.crownIds[k] + crownIdOffset : 0;
+        row++;
+      }
+      crownIdOffset += result.numCrowns;
+    }
+  }
+
+  int numTiles{ static_cast<int>(results.size()) };
+  Rcpp::NumericVector tileSeconds(numTiles);
+  for (int tile{ 0 }; tile < numTiles; tile++) {
+    tileSeconds[tile] = results[tile].seconds;
+  }
+
+  Rcpp::DataFrame result{ Rcpp::DataFrame::create(
+    Rcpp::Named("X") = pointsX,
+    Rcpp::Named("Y") = pointsY,
+    Rcpp::Named("Z") = pointsZ,
+    Rcpp::Named("modeX") = modesX,
+    Rcpp::Named("modeY") = modesY,
+    Rcpp::Named("modeZ") = modesZ,
+    Rcpp::Named("crown_id") = crownIds
+  ) };
+  result.attr("tileSeconds") = tileSeconds;
+  return result;
+}
+
+
+Rcpp::DataFrame createPipelineStageTable(
+    const TilePipelineStatistics& statistics
+) {
+  // Relate the busy time of every stage to the time its threads existed
+  const PipelineStageStatistics* stages[3]{
+    &statistics.reading, &statistics.segmenting, &statistics.writing
+  };
+  Rcpp::IntegerVector numThreads(3);
+  Rcpp::IntegerVector numTiles(3);
+  Rcpp::NumericVector busySeconds(3);
+  Rcpp::NumericVector utilization(3);
+  for (int stage{ 0 }; stage < 3; stage++) {
+    numThreads[stage] = stages[stage]->numThreads;
+    numTiles[stage] = stages[stage]->numTiles;
+    busySeconds[stage] = stages[stage]->busySeconds;
+    double threadSeconds{ stages[stage]->numThreads * statistics.seconds };
+    utilization[stage] = threadSeconds > 0.0
+      ? stages[stage]->busySeconds / threadSeconds : 0.0;
+  }
+
+  Rcpp::DataFrame result{ Rcpp::DataFrame::create(
+    Rcpp::Named("stage") = Rcpp::CharacterVector::create(
+      "read", "segment", "write"
+    ),
+    Rcpp::Named("numThreads") = numThreads,
+    Rcpp::Named("numTiles") = numTiles,
+    Rcpp::Named("busySeconds") = busySeconds,
+    Rcpp::Named("utilization") = utilization,
+    Rcpp::Named("stringsAsFactors") = false
+  ) };
+  result.attr("seconds") = statistics.seconds;
+  result.attr("numCrowns") = statistics.numCrowns;
+  return result;
+}
@@ -0,0 +1,39 @@
+#ifndef TILE_TABLES_H
+#define TILE_TABLES_H
+
+#include "tilePipeline.h"
+#include "tileSegmentation.h"
+
+#include <Rcpp.h>
+#include <vector>
+
+
+/** Gets the columns X, Y, Z and Buffer and the core area of every
+ *  data.frame of \p tiles, e.g. of split_point_cloud_buffered or
+ *  split_point_cloud_quadtree. \p columns keeps the columns alive that had to
+ *  be converted to doubles. Stops with an R error if a column is missing.
+ */
+std::vector<TilePoints> getTilePoints(
+  Rcpp::List tiles, std::vector<Rcpp::NumericVector>& columns
+);
+
+
+/** Collects the results of several tiles in one data.frame with the columns
+ *  X, Y, Z, modeX, modeY, modeZ and crown_id. The clustered points come
+ *  first, with crown IDs that are consecutive over all tiles, followed by the
+ *  points without a crown, with crown ID 0. The attribute tileSeconds holds
+ *  the time that was spent on every tile.
+ */
+Rcpp::DataFrame createTileResultTable(const std::vector<TileResult>& results);
+
+
+/** Summarizes the stages of runTilePipeline in a data.frame with one row
+ *  per stage ("read", "segment" and "write") and the columns numThreads,
+ *  numTiles, busySeconds and utilization. The attributes seconds and
+ *  numCrowns hold the total time and the number of crowns.
+ */
+Rcpp::DataFrame createPipelineStageTable(
+  const TilePipelineStatistics& statistics
+);
+
+#endif  // define TILE_TABLES_H
@@ -0,0 +1,103 @@
+#include "lasCrownWriter.h"
+
+#include <Rcpp.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+//' Open a LAS file for tree crown IDs
+//'
+//' Starts a copy of a LAS file whose point records get the extra bytes
+//' attribute \code{crown_id} and, optionally, \code{modeX}, \code{modeY} and
+//' \code{modeZ}. The records of the source file are copied verbatim, every
+//' point starts with the crown ID 0 and NaN modes, and
+//' \code{writeLasCrowns} fills in the results of one tile at a time, so the
+//' labelled point cloud never has to be held in memory.
+//'
+//' @param sourceFile Character scalar. Path of an uncompressed LAS file.
+//' @param outputFile Character scalar. Path of the LAS file to write.
+//' @param withModes Logical scalar. Whether the points also get the
+//'   coordinates of their modes.
+//'
+//' @return An external pointer to the writer, for \code{writeLasCrowns} and
+//'   \code{closeLasCrownWriter}.
+//'
+//' @export
+// [[Rcpp::export]]
+SEXP openLasCrownWriter(
+    std::string sourceFile, std::string outputFile, bool withModes = false
+){
+  return Rcpp::XPtr<LasCrownWriter>(
+    new LasCrownWriter(sourceFile, outputFile, withModes), true
+  );
+}
+
+
+//' Write the tree crown IDs of some points to a LAS file
+//'
+//' @param writer External pointer of \code{openLasCrownWriter}.
+//' @param pointIndices Numeric vector. Positions of the points in the source
+//'   file, starting at 1, e.g. the attribute \code{pointIndices} of
+//'   \code{readLasPoints}.
+//' @param crownIds Integer vector with the crown ID of every point.
+//' @param modesX,modesY,modesZ NULL or numeric vectors with the coordinates
+//'   of the mode of every point. Only used if the writer has modes.
+//'
+//' @return NULL, invisibly.
+//'
+//' @export
+// [[Rcpp::export]]
+void writeLasCrowns(
+    SEXP writer, Rcpp::NumericVector pointIndices, Rcpp::IntegerVector crownIds,
+    Rcpp::Nullable<Rcpp::NumericVector> modesX = R_NilValue,
+    Rcpp::Nullable<Rcpp::NumericVector> modesY = R_NilValue,
+    Rcpp::Nullable<Rcpp::NumericVector> modesZ = R_NilValue
+){
+  Rcpp::XPtr<LasCrownWriter> lasWriter{ writer };
+  if (crownIds.size() != pointIndices.size()) {
+    Rcpp::stop("pointIndices and crownIds must have the same length.");
+  }
+
+  std::vector<std::uint64_t> indices(pointIndices.size());
+  for (R_xlen_t i{ 0 }; i < pointIndices.size(); i++) {
+    if (!(pointIndices[i] >= 1.0)) {
+      Rcpp::stop("pointIndices must be positive.");
+    }
+    indices[i] = static_cast<std::uint64_t>(pointIndices[i]) - 1;
+  }
+  std::vector<int> ids{ Rcpp::as<std::vector<int> >(crownIds) };
+
+  Rcpp::NumericVector x;
+  Rcpp::NumericVector y;
+  Rcpp::NumericVector z;
+  bool hasModes{ lasWriter->hasModes() && modesX.isNotNull() };
+  if (hasModes) {
+    x = Rcpp::NumericVector(modesX);
+    y = Rcpp::NumericVector(modesY);
+    z = Rcpp::NumericVector(modesZ);
+    if (x.size() != pointIndices.size() || y.size() != pointIndices.size()
+        || z.size() != pointIndices.size()) {
+      Rcpp::stop("The modes must have the same length as pointIndices.");
+    }
+  }
+
+  lasWriter->write(
+    indices, ids, hasModes ? x.begin() : nullptr,
+    hasModes ? y.begin() : nullptr, hasModes ? z.begin() : nullptr
+  );
+}
+
+
+//' Close a LAS file for tree crown IDs
+//'
+//' @param writer External pointer of \code{openLasCrownWriter}.
+//'
+//' @return NULL, invisibly.
+//'
+//' @export
+// [[Rcpp::export]]
+void closeLasCrownWriter(SEXP writer){
+  Rcpp::XPtr<LasCrownWriter> lasWriter{ writer };
+  lasWriter->close();
+}